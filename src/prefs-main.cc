@@ -214,17 +214,7 @@ main(int argc,
     g_dbus_connection_start_message_processing(connection);
 
     gs_unref_object auto bridge =
-      terminal_settings_bridge_proxy_new_sync
-      (connection,
-       GDBusProxyFlags(
-                       G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START |
-                       G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START_AT_CONSTRUCTION |
-                       G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS |
-                       G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES),
-       nullptr, // no name
-       TERMINAL_SETTINGS_BRIDGE_OBJECT_PATH,
-       nullptr, // cancellable
-       &error);
+      terminal_settings_bridge_backend_new_proxy(connection, &error);
     if (!bridge) {
       g_printerr("Failed to create settings bridge proxy: %s\n", error->message);
       return EXIT_FAILURE;
@@ -168,6 +168,7 @@ init_server (int argc,
     g_setenv ("G_ENABLE_DIAGNOSTIC", "0", TRUE);
 
   _terminal_debug_init ();
+  _terminal_debug_startup_mark ("init");
 
   /* Change directory to $HOME so we don't prevent unmounting, e.g. if the
    * factory is started by nautilus-open-terminal. See bug #565328.
@@ -198,6 +199,7 @@ init_server (int argc,
     g_printerr ("Failed to init GTK\n");
     return _EXIT_FAILURE_GTK_INIT;
   }
+  _terminal_debug_startup_mark ("gtk-init");
 
   if (!increase_rlimit_nofile ()) {
     auto const errsv = errno;
@@ -206,6 +208,7 @@ init_server (int argc,
 
   /* Now we can create the app */
   auto const app = terminal_app_new (app_id, G_APPLICATION_IS_SERVICE, nullptr);
+  _terminal_debug_startup_mark ("app-new");
   g_free (app_id);
   app_id = nullptr;
 
@@ -85,19 +85,8 @@
 #define KEY_ZOOM_OUT            "zoom-out"
 #define KEY_SWITCH_TAB_PREFIX   "switch-to-tab-"
 
-#if 1
-/*
-* We don't want to enable content saving until vte supports it async.
-* So we disable this code for stable versions.
-*/
-#include "terminal-version.hh"
-
-#if (TERMINAL_MINOR_VERSION & 1) != 0
+/* Content saving is asynchronous, see terminal-save-contents.cc */
 #define ENABLE_SAVE
-#else
-#undef ENABLE_SAVE
-#endif
-#endif
 
 typedef struct
 {
@@ -153,6 +153,20 @@ struct _TerminalApp
 
   GWeakRef prefs_process_ref;
 
+  TerminalWarmPool *warm_pool;
+
+  /* The filtered server environment, without per-screen variables */
+  char **base_child_environ;
+
+  TerminalFactory *factory;
+  guint scrollback_governor_source;
+  guint scrollback_governor_interval;
+
+  /* Startup work not needed for the first window */
+  guint startup_deferred_source;
+  gboolean first_frame_done;
+  gboolean startup_deferred_done;
+
 #endif /* TERMINAL_SERVER */
 
 #ifdef TERMINAL_PREFERENCES
@@ -451,6 +465,306 @@ terminal_app_check_default(TerminalApp* app)
 
 #ifdef TERMINAL_SERVER
 
+/* Deferred startup */
+
+/* Startup work that is not needed to show the first window is done once
+ * that has been drawn, or after this long if no window is shown.
+ */
+#define STARTUP_DEFERRED_TIMEOUT_MSEC (2000)
+
+static gboolean
+terminal_app_startup_deferred_cb (gpointer user_data)
+{
+  auto const app = TERMINAL_APP (user_data);
+
+  app->startup_deferred_source = 0;
+  app->startup_deferred_done = TRUE;
+
+  /* This scans the XDG terminal lists, and is only needed
+   * to maybe show the "Set as default" info bar.
+   */
+  terminal_app_check_default (app);
+  _terminal_debug_startup_mark ("check-default");
+
+  /* Windows already shown add their info bar on these */
+  g_object_notify (G_OBJECT (app), "is-default-terminal");
+  if (app->ask_default)
+    g_object_notify (G_OBJECT (app), "ask-default-terminal");
+
+  _terminal_debug_startup_write ();
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * terminal_app_first_frame:
+ * @app: a #TerminalApp
+ *
+ * Called when a window has drawn its first frame. The first time, this
+ * starts the startup work that was deferred to not delay it.
+ */
+void
+terminal_app_first_frame (TerminalApp *app)
+{
+  g_return_if_fail (TERMINAL_IS_APP (app));
+
+  if (app->first_frame_done)
+    return;
+
+  app->first_frame_done = TRUE;
+  _terminal_debug_startup_mark ("first-frame");
+  _terminal_debug_startup_write ();
+
+  if (app->startup_deferred_done)
+    return;
+
+  g_clear_handle_id (&app->startup_deferred_source, g_source_remove);
+  app->startup_deferred_source = g_idle_add_full (G_PRIORITY_LOW,
+                                                  terminal_app_startup_deferred_cb,
+                                                  app,
+                                                  nullptr);
+}
+
+/* Warm shell pool */
+
+/* Give the first window a head start before pre-spawning shells */
+#define WARM_POOL_STARTUP_DELAY_MSEC (2000)
+
+/* (Re)creates the pool of pre-spawned children for the default profile,
+ * if that profile wants one. With @drain, the existing children are killed
+ * even if the pool would otherwise be kept, since the way they were spawned
+ * no longer matches the settings.
+ */
+static void
+terminal_app_update_warm_pool (TerminalApp *app,
+                               gboolean drain,
+                               guint delay_msec)
+{
+  gs_unref_object auto profile = terminal_settings_list_ref_default_child (app->profiles_list);
+  auto const size = profile ? guint(g_settings_get_int (profile, TERMINAL_PROFILE_WARM_POOL_SIZE_KEY)) : 0u;
+
+  if (app->warm_pool != nullptr &&
+      !drain &&
+      terminal_warm_pool_get_profile (app->warm_pool) == profile &&
+      terminal_warm_pool_get_size (app->warm_pool) == size)
+    return;
+
+  g_clear_pointer (&app->warm_pool, terminal_warm_pool_free);
+  if (size == 0)
+    return;
+
+  _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                         "[warm pool] keeping %u children for the default profile\n",
+                         size);
+
+  app->warm_pool = terminal_warm_pool_new (profile, size, delay_msec);
+}
+
+static void
+terminal_app_warm_pool_default_changed_cb (TerminalSettingsList *list,
+                                           TerminalApp *app)
+{
+  terminal_app_update_warm_pool (app, FALSE, 0);
+}
+
+static void
+terminal_app_warm_pool_profile_change_event_cb (TerminalSettingsList *list,
+                                                GSettings *profile,
+                                                GQuark const* keys,
+                                                int n_keys,
+                                                TerminalApp *app)
+{
+  if (app->warm_pool == nullptr ||
+      terminal_warm_pool_get_profile (app->warm_pool) != profile) {
+    /* The default profile may just have enabled its pool */
+    terminal_app_update_warm_pool (app, FALSE, 0);
+    return;
+  }
+
+  /* Only changes to how the children are spawned invalidate them */
+  static char const* const spawn_keys[] = {
+    TERMINAL_PROFILE_CUSTOM_COMMAND_KEY,
+    TERMINAL_PROFILE_DEFAULT_SIZE_COLUMNS_KEY,
+    TERMINAL_PROFILE_DEFAULT_SIZE_ROWS_KEY,
+    TERMINAL_PROFILE_LOGIN_SHELL_KEY,
+    TERMINAL_PROFILE_PRESERVE_WORKING_DIRECTORY_KEY,
+    TERMINAL_PROFILE_USE_CUSTOM_COMMAND_KEY,
+  };
+
+  auto drain = keys == nullptr || n_keys == 0;
+  for (auto i = 0; i < n_keys && !drain; ++i) {
+    for (auto const key : spawn_keys) {
+      if (keys[i] == g_quark_try_string (key)) {
+        drain = true;
+        break;
+      }
+    }
+  }
+
+  terminal_app_update_warm_pool (app, drain, 0);
+}
+
+static gboolean
+terminal_app_proxy_change_event_cb (GSettings *settings,
+                                    GQuark const* keys,
+                                    int n_keys,
+                                    TerminalApp *app)
+{
+  /* The child environment has the proxy settings baked in */
+  g_clear_pointer (&app->base_child_environ, g_strfreev);
+
+  if (app->warm_pool != nullptr)
+    terminal_app_update_warm_pool (app, TRUE, 0);
+
+  return FALSE; /* propagate */
+}
+
+/* Scrollback governor */
+
+#define SCROLLBACK_GOVERNOR_INTERVAL_SEC (5)
+
+/* Without a memory limit, the usage is only reported, so less often */
+#define SCROLLBACK_USAGE_INTERVAL_SEC (30)
+
+/* A rough estimate of the memory a cell of scrollback uses. VTE keeps the
+ * scrollback compressed in temporary files, which may well be in memory.
+ */
+#define SCROLLBACK_BYTES_PER_CELL (4)
+
+/* The governor never shrinks a terminal's scrollback below this */
+#define SCROLLBACK_MIN_LINES (1000)
+
+typedef struct {
+  TerminalScreen *screen;
+  glong rows;
+  glong columns;
+  gint64 last_focus_time;
+} ScrollbackUsage;
+
+static int
+compare_scrollback_usage_cb (gconstpointer ap,
+                             gconstpointer bp)
+{
+  auto const a = reinterpret_cast<ScrollbackUsage const*>(ap);
+  auto const b = reinterpret_cast<ScrollbackUsage const*>(bp);
+
+  return (a->last_focus_time > b->last_focus_time) - (a->last_focus_time < b->last_focus_time);
+}
+
+/* Estimates the scrollback memory of all terminals, and if that is over
+ * the budget, shrinks the scrollback of the terminals focused least
+ * recently until it fits. Publishes the budget and the usage in the
+ * factory's ScrollbackMemory property either way.
+ */
+static void
+terminal_app_govern_scrollback (TerminalApp *app)
+{
+  auto const budget = guint64(g_settings_get_uint (app->global_settings,
+                                                   TERMINAL_SETTING_SCROLLBACK_MEMORY_LIMIT_KEY)) * 1024 * 1024;
+
+  gs_unref_array GArray *usages = g_array_sized_new (FALSE, FALSE, sizeof (ScrollbackUsage),
+                                                     g_hash_table_size (app->screen_map));
+  guint64 total = 0;
+
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init (&iter, app->screen_map);
+  while (g_hash_table_iter_next (&iter, nullptr, &value)) {
+    auto const screen = TERMINAL_SCREEN (value);
+
+    /* Without a limit, nothing stays capped */
+    if (budget == 0)
+      terminal_screen_set_scrollback_cap (screen, -1);
+
+    ScrollbackUsage usage;
+    usage.screen = screen;
+    usage.rows = terminal_screen_get_scrollback_rows (screen);
+    usage.columns = vte_terminal_get_column_count (VTE_TERMINAL (screen));
+    usage.last_focus_time = terminal_screen_get_last_focus_time (screen);
+    g_array_append_val (usages, usage);
+
+    total += guint64(usage.rows) * usage.columns * SCROLLBACK_BYTES_PER_CELL;
+  }
+
+  _terminal_debug_print (TERMINAL_DEBUG_SERVER,
+                         "Scrollback of %u terminals uses about %" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT " bytes\n",
+                         usages->len, total, budget);
+
+  if (budget != 0 && total > budget) {
+    g_array_sort (usages, compare_scrollback_usage_cb);
+
+    for (guint i = 0; i < usages->len && total > budget; ++i) {
+      auto const usage = &g_array_index (usages, ScrollbackUsage, i);
+      auto const bytes_per_line = guint64(MAX (usage->columns, 1)) * SCROLLBACK_BYTES_PER_CELL;
+      auto const excess_lines = glong((total - budget + bytes_per_line - 1) / bytes_per_line);
+      auto const lines = MAX (usage->rows - excess_lines, glong(SCROLLBACK_MIN_LINES));
+      if (lines >= usage->rows)
+        continue;
+
+      terminal_screen_set_scrollback_cap (usage->screen, lines);
+      total -= guint64(usage->rows - lines) * bytes_per_line;
+    }
+  }
+
+  if (app->factory != nullptr) {
+    gs_unref_variant GVariant *memory = g_variant_ref_sink (g_variant_new ("(tt)", budget, total));
+    auto const old_memory = terminal_factory_get_scrollback_memory (app->factory);
+    if (old_memory == nullptr || !g_variant_equal (old_memory, memory))
+      terminal_factory_set_scrollback_memory (app->factory, memory);
+  }
+}
+
+static gboolean
+terminal_app_scrollback_governor_cb (void *user_data)
+{
+  auto const app = TERMINAL_APP (user_data);
+
+  terminal_app_govern_scrollback (app);
+
+  if (g_hash_table_size (app->screen_map) != 0)
+    return G_SOURCE_CONTINUE;
+
+  app->scrollback_governor_source = 0;
+  return G_SOURCE_REMOVE;
+}
+
+/* Runs the governor periodically while there are terminals, and stops
+ * it otherwise. Without a memory limit it only keeps the reported usage
+ * up to date, at a lower rate.
+ */
+static void
+terminal_app_update_scrollback_governor (TerminalApp *app)
+{
+  if (g_hash_table_size (app->screen_map) == 0) {
+    g_clear_handle_id (&app->scrollback_governor_source, g_source_remove);
+    return;
+  }
+
+  auto const interval = g_settings_get_uint (app->global_settings,
+                                             TERMINAL_SETTING_SCROLLBACK_MEMORY_LIMIT_KEY) != 0
+    ? SCROLLBACK_GOVERNOR_INTERVAL_SEC : SCROLLBACK_USAGE_INTERVAL_SEC;
+  if (app->scrollback_governor_source != 0 &&
+      app->scrollback_governor_interval == guint(interval))
+    return;
+
+  g_clear_handle_id (&app->scrollback_governor_source, g_source_remove);
+  app->scrollback_governor_interval = interval;
+  app->scrollback_governor_source =
+    g_timeout_add_seconds_full (G_PRIORITY_LOW,
+                                interval,
+                                terminal_app_scrollback_governor_cb,
+                                app, nullptr);
+}
+
+static void
+terminal_app_scrollback_memory_limit_changed_cb (GSettings *settings,
+                                                 char const* key,
+                                                 TerminalApp *app)
+{
+  terminal_app_govern_scrollback (app);
+  terminal_app_update_scrollback_governor (app);
+}
+
 typedef struct {
   char *uuid;
   char *label;
@@ -751,6 +1065,7 @@ terminal_app_startup (GApplication *application)
   g_application_set_resource_base_path (application, TERMINAL_RESOURCES_PATH_PREFIX);
 
   G_APPLICATION_CLASS (terminal_app_parent_class)->startup (application);
+  _terminal_debug_startup_mark ("gtk-startup");
 
 #ifdef GDK_WINDOWING_X11
   auto const display = gdk_display_get_default ();
@@ -767,6 +1082,7 @@ terminal_app_startup (GApplication *application)
 #endif
 
   app_load_css (application);
+  _terminal_debug_startup_mark ("css");
 
 #ifdef TERMINAL_SERVER
   GActionEntry const action_entries[] = {
@@ -786,21 +1102,53 @@ terminal_app_startup (GApplication *application)
   g_signal_connect_swapped (app->profiles_list, "child-changed::" TERMINAL_PROFILE_VISIBLE_NAME_KEY,
                             G_CALLBACK (terminal_app_update_profile_menus), app);
 
-#endif /* TERMINAL_SERVER */
+  /* Keep the warm pool matching the default profile */
+  g_signal_connect (app->profiles_list, "default-changed",
+                    G_CALLBACK (terminal_app_warm_pool_default_changed_cb), app);
+  g_signal_connect (app->profiles_list, "child-change-event",
+                    G_CALLBACK (terminal_app_warm_pool_profile_change_event_cb), app);
+
+  /* Keep the child environment and warm pool matching the proxy settings */
+  g_signal_connect (app->system_proxy_settings, "change-event",
+                    G_CALLBACK (terminal_app_proxy_change_event_cb), app);
+  for (auto i = 0; i < 4; ++i)
+    g_signal_connect (app->system_proxy_protocol_settings[i], "change-event",
+                      G_CALLBACK (terminal_app_proxy_change_event_cb), app);
+
+  terminal_app_update_warm_pool (app, FALSE, WARM_POOL_STARTUP_DELAY_MSEC);
+
+  g_signal_connect (app->global_settings,
+                    "changed::" TERMINAL_SETTING_SCROLLBACK_MEMORY_LIMIT_KEY,
+                    G_CALLBACK (terminal_app_scrollback_memory_limit_changed_cb), app);
+
+  /* Not needed for the first window, see terminal_app_first_frame() */
+  app->startup_deferred_source = g_timeout_add (STARTUP_DEFERRED_TIMEOUT_MSEC,
+                                                terminal_app_startup_deferred_cb,
+                                                app);
+
+#else /* !TERMINAL_SERVER */
 
   terminal_app_check_default(app);
 
+#endif /* TERMINAL_SERVER */
+
+  _terminal_debug_startup_mark ("startup");
   _terminal_debug_print (TERMINAL_DEBUG_SERVER, "Startup complete\n");
 }
 
 static void
 terminal_app_shutdown (GApplication *application)
 {
+  auto const app = TERMINAL_APP(application);
+
+#ifdef TERMINAL_SERVER
+  g_clear_pointer (&app->warm_pool, terminal_warm_pool_free);
+  g_clear_handle_id (&app->startup_deferred_source, g_source_remove);
+#endif
+
   G_APPLICATION_CLASS (terminal_app_parent_class)->shutdown (application);
 
 #ifdef TERMINAL_PREFERENCES
-  auto const app = TERMINAL_APP(application);
-
   if (app->prefs_window)
     gtk_window_destroy(app->prefs_window);
 #endif
@@ -856,6 +1204,7 @@ terminal_app_constructed(GObject *object)
     app->settings_backend = g_settings_backend_get_default ();
 
   app->schema_source = terminal_g_settings_schema_source_get_default();
+  _terminal_debug_startup_mark ("schema-source");
 
   /* Desktop proxy settings */
   app->system_proxy_settings = terminal_g_settings_new(app->settings_backend,
@@ -900,6 +1249,7 @@ terminal_app_constructed(GObject *object)
   app->gtk_debug_settings = terminal_g_settings_new(app->settings_backend,
                                                     app->schema_source,
                                                     GTK_DEBUG_SETTING_SCHEMA);
+  _terminal_debug_startup_mark ("settings");
 
   /* These are internal settings that exists only for distributions
    * to override, so we cache them on startup and don't react to changes.
@@ -943,6 +1293,7 @@ terminal_app_constructed(GObject *object)
   /* Get the profiles */
   app->profiles_list = terminal_profiles_list_new(app->settings_backend,
                                                   app->schema_source);
+  _terminal_debug_startup_mark ("profiles");
 
   gs_unref_object auto settings =
     terminal_g_settings_new_with_path(app->settings_backend,
@@ -950,6 +1301,7 @@ terminal_app_constructed(GObject *object)
                                       TERMINAL_KEYBINDINGS_SCHEMA,
                                       TERMINAL_KEYBINDINGS_SCHEMA_PATH);
   terminal_accels_init (G_APPLICATION (app), settings, app->use_headerbar);
+  _terminal_debug_startup_mark ("accels");
 }
 
 static void
@@ -966,6 +1318,26 @@ terminal_app_finalize (GObject *object)
   g_signal_handlers_disconnect_by_func (app->profiles_list,
                                         (void*)terminal_app_update_profile_menus,
                                         app);
+  g_signal_handlers_disconnect_by_func (app->profiles_list,
+                                        (void*)terminal_app_warm_pool_default_changed_cb,
+                                        app);
+  g_signal_handlers_disconnect_by_func (app->profiles_list,
+                                        (void*)terminal_app_warm_pool_profile_change_event_cb,
+                                        app);
+  g_signal_handlers_disconnect_by_func (app->system_proxy_settings,
+                                        (void*)terminal_app_proxy_change_event_cb,
+                                        app);
+  for (auto i = 0; i < 4; ++i)
+    g_signal_handlers_disconnect_by_func (app->system_proxy_protocol_settings[i],
+                                          (void*)terminal_app_proxy_change_event_cb,
+                                          app);
+  g_clear_pointer (&app->warm_pool, terminal_warm_pool_free);
+  g_clear_pointer (&app->base_child_environ, g_strfreev);
+  g_signal_handlers_disconnect_by_func (app->global_settings,
+                                        (void*)terminal_app_scrollback_memory_limit_changed_cb,
+                                        app);
+  g_clear_handle_id (&app->scrollback_governor_source, g_source_remove);
+  g_clear_handle_id (&app->startup_deferred_source, g_source_remove);
   g_hash_table_destroy (app->screen_map);
 #endif
 
@@ -1087,6 +1459,13 @@ terminal_app_dbus_register (GApplication    *application,
                                                  error))
       return FALSE;
 
+    /* Index any screens that already exist */
+    GHashTableIter iter;
+    gpointer screen;
+    g_hash_table_iter_init (&iter, app->screen_map);
+    while (g_hash_table_iter_next (&iter, nullptr, &screen))
+      terminal_search_provider_add_screen (search_provider, TERMINAL_SCREEN (screen));
+
     gs_transfer_out_value (&app->search_provider, &search_provider);
   }
 #endif /* ENABLE_SEARCH_PROVIDER */
@@ -1094,12 +1473,16 @@ terminal_app_dbus_register (GApplication    *application,
   object = terminal_object_skeleton_new (TERMINAL_FACTORY_OBJECT_PATH);
   factory = terminal_factory_impl_new ();
   terminal_object_skeleton_set_factory (object, factory);
+  app->factory = (TerminalFactory*)g_object_ref (factory);
+  /* Publish the initial budget and usage */
+  terminal_app_govern_scrollback (app);
 
   app->object_manager = g_dbus_object_manager_server_new (TERMINAL_OBJECT_PATH_PREFIX);
   g_dbus_object_manager_server_export (app->object_manager, G_DBUS_OBJECT_SKELETON (object));
 
   /* And export the object */
   g_dbus_object_manager_server_set_connection (app->object_manager, connection);
+  _terminal_debug_startup_mark ("dbus-register");
   return TRUE;
 }
 
@@ -1110,6 +1493,8 @@ terminal_app_dbus_unregister (GApplication    *application,
 {
   TerminalApp *app = TERMINAL_APP (application);
 
+  g_clear_object (&app->factory);
+
   if (app->object_manager) {
     g_dbus_object_manager_server_unexport (app->object_manager, TERMINAL_FACTORY_OBJECT_PATH);
     g_object_unref (app->object_manager);
@@ -1215,13 +1600,81 @@ char *
 terminal_app_dup_screen_object_path (TerminalApp *app,
                                      TerminalScreen *screen)
 {
-  char *object_path = g_strdup_printf (TERMINAL_RECEIVER_OBJECT_PATH_FORMAT,
-                                       terminal_screen_get_uuid (screen));
+  return terminal_app_dup_screen_object_path_for_uuid (app,
+                                                       terminal_screen_get_uuid (screen));
+}
+
+/**
+ * terminal_app_dup_screen_object_path_for_uuid:
+ * @app:
+ * @uuid: a screen uuid
+ *
+ * Returns: (transfer full): the object path the screen with uuid @uuid
+ *   is, or is going to be, exported at
+ */
+char *
+terminal_app_dup_screen_object_path_for_uuid (TerminalApp *app,
+                                              const char *uuid)
+{
+  char *object_path = g_strdup_printf (TERMINAL_RECEIVER_OBJECT_PATH_FORMAT, uuid);
   object_path = g_strdelimit (object_path,  "-", '_');
   g_assert (g_variant_is_object_path (object_path));
   return object_path;
 }
 
+/**
+ * terminal_app_get_base_child_environment:
+ * @app:
+ *
+ * Returns the environment for child processes that are not given an
+ * environment of their own, without the per-screen variables. It is
+ * computed once and kept until the proxy settings change.
+ *
+ * Returns: (transfer none): the base child environment
+ */
+char const* const*
+terminal_app_get_base_child_environment (TerminalApp *app)
+{
+  g_return_val_if_fail (TERMINAL_IS_APP (app), nullptr);
+
+  if (app->base_child_environ == nullptr) {
+    app->base_child_environ = terminal_screen_get_base_child_environment ();
+
+    _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                           "Computed base child environment with %u variables\n",
+                           g_strv_length (app->base_child_environ));
+  }
+
+  return (char const* const*)app->base_child_environ;
+}
+
+/**
+ * terminal_app_take_warm_child:
+ * @app:
+ * @profile: the profile of the new terminal
+ * @exec_argv: the command the new terminal is going to run
+ * @cwd: the working directory the new terminal is going to use
+ * @spawn_flags: the flags the new terminal is going to spawn with
+ *
+ * Returns: (transfer full) (nullable): a pre-spawned child from the warm
+ *   pool of @profile that matches the arguments, or %nullptr
+ */
+TerminalWarmChild *
+terminal_app_take_warm_child (TerminalApp *app,
+                              GSettings *profile,
+                              char **exec_argv,
+                              const char *cwd,
+                              GSpawnFlags spawn_flags)
+{
+  g_return_val_if_fail (TERMINAL_IS_APP (app), nullptr);
+
+  if (app->warm_pool == nullptr ||
+      terminal_warm_pool_get_profile (app->warm_pool) != profile)
+    return nullptr;
+
+  return terminal_warm_pool_take (app->warm_pool, exec_argv, cwd, spawn_flags);
+}
+
 /**
  * terminal_app_get_receiver_impl_by_object_path:
  * @app:
@@ -1274,6 +1727,13 @@ terminal_app_register_screen (TerminalApp *app,
   const char *uuid = terminal_screen_get_uuid (screen);
   g_hash_table_insert (app->screen_map, g_strdup (uuid), screen);
 
+  terminal_app_update_scrollback_governor (app);
+
+#ifdef ENABLE_SEARCH_PROVIDER
+  if (app->search_provider)
+    terminal_search_provider_add_screen (app->search_provider, screen);
+#endif /* ENABLE_SEARCH_PROVIDER */
+
   gs_free char *object_path = terminal_app_dup_screen_object_path (app, screen);
   TerminalObjectSkeleton *skeleton = terminal_object_skeleton_new (object_path);
 
@@ -1295,6 +1755,11 @@ terminal_app_unregister_screen (TerminalApp *app,
   if (!found)
     return; /* repeat unregistering */
 
+#ifdef ENABLE_SEARCH_PROVIDER
+  if (app->search_provider)
+    terminal_search_provider_remove_screen (app->search_provider, screen);
+#endif /* ENABLE_SEARCH_PROVIDER */
+
   gs_free char *object_path = terminal_app_dup_screen_object_path (app, screen);
   gs_unref_object TerminalReceiverImpl *impl =
     terminal_app_get_receiver_impl_by_object_path (app, object_path);
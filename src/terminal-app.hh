@@ -23,6 +23,7 @@
 
 #include "terminal-screen.hh"
 #include "terminal-profiles-list.hh"
+#include "terminal-warm-pool.hh"
 
 G_BEGIN_DECLS
 
@@ -77,6 +78,19 @@ void terminal_app_remove_profile (TerminalApp *app,
 char *terminal_app_dup_screen_object_path (TerminalApp *app,
                                            TerminalScreen *screen);
 
+char *terminal_app_dup_screen_object_path_for_uuid (TerminalApp *app,
+                                                    const char *uuid);
+
+char const* const* terminal_app_get_base_child_environment (TerminalApp *app);
+
+TerminalWarmChild *terminal_app_take_warm_child (TerminalApp *app,
+                                                 GSettings *profile,
+                                                 char **exec_argv,
+                                                 const char *cwd,
+                                                 GSpawnFlags spawn_flags);
+
+void terminal_app_first_frame (TerminalApp *app);
+
 TerminalScreen *terminal_app_get_screen_by_uuid (TerminalApp *app,
                                                  const char  *uuid);
 
@@ -17,9 +17,12 @@
 
 #include <config.h>
 
+#include <unistd.h>
+
 #include <glib.h>
 
 #include "terminal-debug.hh"
+#include "terminal-libgsystem.hh"
 
 TerminalDebugFlags _terminal_debug_flags;
 
@@ -41,6 +44,8 @@ _terminal_debug_init(void)
     { "bridge",        TERMINAL_DEBUG_BRIDGE        },
     { "default",       TERMINAL_DEBUG_DEFAULT       },
     { "focus",         TERMINAL_DEBUG_FOCUS         },
+    { "latency",       TERMINAL_DEBUG_LATENCY       },
+    { "startup",       TERMINAL_DEBUG_STARTUP       },
   };
 
   _terminal_debug_flags = TerminalDebugFlags(g_parse_debug_string (g_getenv ("GNOME_TERMINAL_DEBUG"),
@@ -49,12 +54,70 @@ _terminal_debug_init(void)
 #endif /* ENABLE_DEBUG */
 }
 
+/* Startup trace */
+
+static GString* startup_trace = nullptr;
+static gint64 startup_trace_start_time = 0;
+static gint64 startup_trace_last_time = 0;
+
+/*
+ * _terminal_debug_startup_mark:
+ * @phase: the name of the phase that just finished
+ *
+ * With TERMINAL_DEBUG_STARTUP, records the time @phase finished at, relative
+ * to the first phase, and to the phase before it.
+ */
+void
+_terminal_debug_startup_mark(char const* phase)
+{
+  if (!_terminal_debug_on(TERMINAL_DEBUG_STARTUP))
+    return;
+
+  auto const now = g_get_monotonic_time();
+  if (!startup_trace) {
+    startup_trace = g_string_new("# usec since start\tusec since previous\tphase\n");
+    startup_trace_start_time = startup_trace_last_time = now;
+  }
+
+  g_string_append_printf(startup_trace,
+                         "%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%s\n",
+                         now - startup_trace_start_time,
+                         now - startup_trace_last_time,
+                         phase);
+  startup_trace_last_time = now;
+}
+
+/*
+ * _terminal_debug_startup_write:
+ *
+ * Writes the phases recorded by _terminal_debug_startup_mark() so far to
+ * the file named by the GNOME_TERMINAL_STARTUP_TRACE environment variable,
+ * or else to a file in the user runtime directory.
+ */
+void
+_terminal_debug_startup_write(void)
+{
+  if (!startup_trace)
+    return;
+
+  gs_free char* default_path = nullptr;
+  auto path = g_getenv("GNOME_TERMINAL_STARTUP_TRACE");
+  if (!path) {
+    gs_free auto basename = g_strdup_printf("%s-startup-%d.trace",
+                                            g_get_prgname(), int(getpid()));
+    path = default_path = g_build_filename(g_get_user_runtime_dir(), basename, nullptr);
+  }
+
+  gs_free_error GError* error = nullptr;
+  if (!g_file_set_contents(path, startup_trace->str, startup_trace->len, &error))
+    g_printerr("Failed to write startup trace to %s: %s\n", path, error->message);
+}
+
 #ifdef ENABLE_DEBUG
 
 #if defined(TERMINAL_SERVER) || defined(TERMINAL_PREFERENCES)
 
 #include <gtk/gtk.h>
-#include "terminal-libgsystem.hh"
 
 static char*
 object_to_string(void* object)
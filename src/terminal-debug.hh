@@ -38,6 +38,8 @@ typedef enum {
   TERMINAL_DEBUG_BRIDGE        = 1 << 10,
   TERMINAL_DEBUG_DEFAULT       = 1 << 11,
   TERMINAL_DEBUG_FOCUS         = 1 << 12,
+  TERMINAL_DEBUG_LATENCY       = 1 << 13,
+  TERMINAL_DEBUG_STARTUP       = 1 << 14,
 } TerminalDebugFlags;
 
 void _terminal_debug_init(void);
@@ -76,6 +78,9 @@ static void _terminal_debug_print (guint flags, const char *fmt, ...)
 
 void _terminal_debug_attach_focus_listener(void* widget);
 
+void _terminal_debug_startup_mark (char const* phase);
+void _terminal_debug_startup_write (void);
+
 #ifdef G_DISABLE_ASSERT
 #define terminal_assert_cmpfloat(a,op,b) G_STMT_START {} G_STMT_END
 #define terminal_assert_cmpfloat_with_epsilon(a,op,b) G_STMT_START {} G_STMT_END
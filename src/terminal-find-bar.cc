@@ -21,11 +21,18 @@
 
 #include "terminal-find-bar.hh"
 
+#include "terminal-debug.hh"
 #include "terminal-pcre2.hh"
 #include "terminal-util.hh"
 
 #include <glib/gi18n.h>
 
+/* How long to wait after the last change to the search before using it */
+#define SEARCH_DEBOUNCE_MSEC (150)
+
+/* How many compiled search regexes to keep */
+#define REGEX_CACHE_SIZE (16)
+
 struct _TerminalFindBar
 {
   GtkWidget        parent_instance;
@@ -36,6 +43,9 @@ struct _TerminalFindBar
   GtkCheckButton  *use_regex;
   GtkCheckButton  *whole_words;
   GtkCheckButton  *match_case;
+
+  guint            update_source;
+  gint64           changed_time;
 };
 
 enum {
@@ -65,6 +75,71 @@ terminal_find_bar_dismiss (GtkWidget  *widget,
     gtk_widget_grab_focus (GTK_WIDGET (self->screen));
 }
 
+/* Compiled regex cache, shared by all find bars */
+
+typedef struct {
+  char *key;
+  VteRegex *regex;
+} RegexCacheEntry;
+
+static GQueue regex_cache_lru = G_QUEUE_INIT; /* most recently used first */
+static GHashTable *regex_cache = nullptr; /* key -> link in regex_cache_lru */
+
+static void
+regex_cache_entry_free (RegexCacheEntry *entry)
+{
+  g_free (entry->key);
+  vte_regex_unref (entry->regex);
+  g_free (entry);
+}
+
+static VteRegex *
+regex_cache_get (const char *pattern,
+                 uint32_t flags,
+                 uint32_t extra_flags,
+                 gboolean *hit,
+                 GError **error)
+{
+  if (regex_cache == nullptr)
+    regex_cache = g_hash_table_new (g_str_hash, g_str_equal);
+
+  g_autofree char *key = g_strdup_printf ("%08x:%08x:%s", flags, extra_flags, pattern);
+
+  auto link = reinterpret_cast<GList*>(g_hash_table_lookup (regex_cache, key));
+  if (link != nullptr) {
+    g_queue_unlink (&regex_cache_lru, link);
+    g_queue_push_head_link (&regex_cache_lru, link);
+
+    *hit = TRUE;
+    return vte_regex_ref (reinterpret_cast<RegexCacheEntry*>(link->data)->regex);
+  }
+
+  *hit = FALSE;
+
+  gsize error_offset = 0;
+  auto const regex = vte_regex_new_for_search_full (pattern, -1, flags, extra_flags,
+                                                    &error_offset, error);
+  if (regex == nullptr)
+    return nullptr;
+
+  vte_regex_jit (regex, PCRE2_JIT_COMPLETE, nullptr);
+  vte_regex_jit (regex, PCRE2_JIT_PARTIAL_SOFT, nullptr);
+
+  auto const entry = g_new (RegexCacheEntry, 1);
+  entry->key = reinterpret_cast<char*>(g_steal_pointer (&key));
+  entry->regex = vte_regex_ref (regex);
+  g_queue_push_head (&regex_cache_lru, entry);
+  g_hash_table_insert (regex_cache, entry->key, regex_cache_lru.head);
+
+  while (regex_cache_lru.length > REGEX_CACHE_SIZE) {
+    auto const old = reinterpret_cast<RegexCacheEntry*>(g_queue_pop_tail (&regex_cache_lru));
+    g_hash_table_remove (regex_cache, old->key);
+    regex_cache_entry_free (old);
+  }
+
+  return regex;
+}
+
 static gboolean
 terminal_find_bar_grab_focus (GtkWidget *widget)
 {
@@ -76,11 +151,18 @@ terminal_find_bar_update_regex(TerminalFindBar* self)
 {
   g_assert (TERMINAL_IS_FIND_BAR (self));
 
+  g_clear_handle_id (&self->update_source, g_source_remove);
+
+  auto const changed_time = self->changed_time;
+  self->changed_time = 0;
+
+  if (self->screen == nullptr)
+    return;
+
   auto text = gtk_editable_get_text (GTK_EDITABLE (self->entry));
 
   g_autoptr(VteRegex) regex = nullptr;
   g_autoptr(GError) error = nullptr;
-  gsize regex_error_offset = 0;
   if (!terminal_str_empty0 (text)) {
     uint32_t flags = PCRE2_UTF | PCRE2_NO_UTF_CHECK | PCRE2_UCP | PCRE2_MULTILINE;
     uint32_t extra_flags = 0;
@@ -95,13 +177,17 @@ terminal_find_bar_update_regex(TerminalFindBar* self)
     if (gtk_check_button_get_active (GTK_CHECK_BUTTON (self->whole_words)))
       extra_flags |= PCRE2_EXTRA_MATCH_WORD;
 
-    regex = vte_regex_new_for_search_full(text, -1, flags, extra_flags,
-                                          &regex_error_offset, &error);
-
-    if (regex) {
-      vte_regex_jit(regex, PCRE2_JIT_COMPLETE, nullptr);
-      vte_regex_jit(regex, PCRE2_JIT_PARTIAL_SOFT, nullptr);
-    }
+    auto const start = g_get_monotonic_time ();
+    gboolean hit = FALSE;
+    regex = regex_cache_get (text, flags, extra_flags, &hit, &error);
+
+    _terminal_debug_print (TERMINAL_DEBUG_SEARCH,
+                           "Search regex for \"%s\" %s in %" G_GINT64_FORMAT "us, "
+                           "%" G_GINT64_FORMAT "us after the input\n",
+                           text,
+                           hit ? "found in cache" : "compiled",
+                           g_get_monotonic_time () - start,
+                           changed_time ? start - changed_time : 0);
   }
 
   if (error) {
@@ -118,6 +204,47 @@ terminal_find_bar_update_regex(TerminalFindBar* self)
   vte_terminal_search_set_wrap_around (VTE_TERMINAL (self->screen), true);
 }
 
+static gboolean
+terminal_find_bar_update_cb (gpointer user_data)
+{
+  auto const self = TERMINAL_FIND_BAR (user_data);
+
+  self->update_source = 0;
+  terminal_find_bar_update_regex (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Uses a pending change to the search right away */
+static void
+terminal_find_bar_flush_update (TerminalFindBar *self)
+{
+  if (self->update_source != 0)
+    terminal_find_bar_update_regex (self);
+}
+
+static void
+terminal_find_bar_search (TerminalFindBar *self,
+                          gboolean backward)
+{
+  if (self->screen == nullptr)
+    return;
+
+  terminal_find_bar_flush_update (self);
+
+  auto const start = g_get_monotonic_time ();
+
+  if (backward)
+    vte_terminal_search_find_previous (VTE_TERMINAL (self->screen));
+  else
+    vte_terminal_search_find_next (VTE_TERMINAL (self->screen));
+
+  _terminal_debug_print (TERMINAL_DEBUG_SEARCH,
+                         "Search %s took %" G_GINT64_FORMAT "us\n",
+                         backward ? "backward" : "forward",
+                         g_get_monotonic_time () - start);
+}
+
 static void
 terminal_find_bar_next (GtkWidget  *widget,
                       const char *action_name,
@@ -127,8 +254,7 @@ terminal_find_bar_next (GtkWidget  *widget,
 
   g_assert (TERMINAL_IS_FIND_BAR (self));
 
-  if (self->screen != nullptr)
-    vte_terminal_search_find_next (VTE_TERMINAL (self->screen));
+  terminal_find_bar_search (self, FALSE);
 }
 
 static void
@@ -140,15 +266,34 @@ terminal_find_bar_previous (GtkWidget  *widget,
 
   g_assert (TERMINAL_IS_FIND_BAR (self));
 
-  if (self->screen != nullptr)
-    vte_terminal_search_find_previous (VTE_TERMINAL (self->screen));
+  terminal_find_bar_search (self, TRUE);
 }
 
 static void
 terminal_find_bar_entry_changed_cb (TerminalFindBar *self,
                                     GtkEntry      *entry)
 {
-  terminal_find_bar_update_regex(self);
+  /* Clearing the search is cheap, so do it right away */
+  if (terminal_str_empty0 (gtk_editable_get_text (GTK_EDITABLE (entry)))) {
+    terminal_find_bar_update_regex (self);
+    return;
+  }
+
+  /* New input replaces a search not started yet */
+  g_clear_handle_id (&self->update_source, g_source_remove);
+  if (self->changed_time == 0)
+    self->changed_time = g_get_monotonic_time ();
+
+  self->update_source = g_timeout_add (SEARCH_DEBOUNCE_MSEC,
+                                       terminal_find_bar_update_cb,
+                                       self);
+}
+
+static void
+terminal_find_bar_option_toggled_cb (TerminalFindBar *self,
+                                     GtkCheckButton  *button)
+{
+  terminal_find_bar_update_regex (self);
 }
 
 static void
@@ -157,6 +302,8 @@ terminal_find_bar_dispose (GObject *object)
   TerminalFindBar *self = (TerminalFindBar *)object;
   GtkWidget *child;
 
+  g_clear_handle_id (&self->update_source, g_source_remove);
+
   gtk_widget_dispose_template (GTK_WIDGET (self), TERMINAL_TYPE_FIND_BAR);
 
   while ((child = gtk_widget_get_first_child (GTK_WIDGET (self))))
@@ -236,6 +383,7 @@ terminal_find_bar_class_init (TerminalFindBarClass *klass)
   gtk_widget_class_bind_template_child (widget_class, TerminalFindBar, match_case);
 
   gtk_widget_class_bind_template_callback (widget_class, terminal_find_bar_entry_changed_cb);
+  gtk_widget_class_bind_template_callback (widget_class, terminal_find_bar_option_toggled_cb);
 
   gtk_widget_class_install_action (widget_class, "search.dismiss", nullptr, terminal_find_bar_dismiss);
   gtk_widget_class_install_action (widget_class, "search.down", nullptr, terminal_find_bar_next);
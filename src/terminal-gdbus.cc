@@ -116,34 +116,24 @@ exec_cb (TerminalScreen *screen, /* unused, may be %nullptr */
   }
 }
 
+/*
+ * check_exec_options:
+ * @options: the Exec options of type "a{sv}"
+ * @fd_list: (allow-none): a #GUnixFDList
+ * @error:
+ *
+ * Checks that @options are valid, and consistent with @fd_list.
+ *
+ * Returns: %TRUE if the options are valid, or %FALSE with @error filled in
+ */
 static gboolean
-terminal_receiver_impl_exec (TerminalReceiver *receiver,
-                             GDBusMethodInvocation *invocation,
-                             GUnixFDList *fd_list,
-                             GVariant *options,
-                             GVariant *arguments)
+check_exec_options (GVariant *options,
+                    GUnixFDList *fd_list,
+                    GError **error)
 {
-  TerminalReceiverImpl *impl = TERMINAL_RECEIVER_IMPL (receiver);
-  TerminalReceiverImplPrivate *priv = impl->priv;
-  const char *working_directory;
-  gboolean shell;
-  gsize exec_argc;
-  gs_free char **exec_argv = nullptr; /* container needs to be freed, strings not owned */
   gs_free char **envv = nullptr; /* container needs to be freed, strings not owned */
   gs_unref_variant GVariant *fd_array = nullptr;
 
-  if (priv->screen == nullptr) {
-    g_dbus_method_invocation_return_error_literal (invocation,
-                                                   G_DBUS_ERROR,
-                                                   G_DBUS_ERROR_FAILED,
-                                                   "Terminal already closed");
-    return TRUE; /* handled */
-  }
-
-  if (!g_variant_lookup (options, "cwd", "^&ay", &working_directory))
-    working_directory = nullptr;
-  if (!g_variant_lookup (options, "shell", "b", &shell))
-    shell = FALSE;
   if (!g_variant_lookup (options, "environ", "^a&ay", &envv))
     envv = nullptr;
   if (!g_variant_lookup (options, "fd-set", "@a(ih)", &fd_array))
@@ -151,20 +141,20 @@ terminal_receiver_impl_exec (TerminalReceiver *receiver,
 
   /* Check environment */
   if (!terminal_util_check_envv((const char * const*)envv)) {
-    g_dbus_method_invocation_return_error_literal (invocation,
-                                                   G_DBUS_ERROR,
-                                                   G_DBUS_ERROR_INVALID_ARGS,
-                                                   "Malformed environment");
-    return TRUE; /* handled */
+    g_set_error_literal (error,
+                         G_DBUS_ERROR,
+                         G_DBUS_ERROR_INVALID_ARGS,
+                         "Malformed environment");
+    return FALSE;
   }
 
   /* Check FD passing */
   if ((fd_list != nullptr) ^ (fd_array != nullptr)) {
-    g_dbus_method_invocation_return_error_literal (invocation,
-                                                   G_DBUS_ERROR,
-                                                   G_DBUS_ERROR_INVALID_ARGS,
-                                                   "Must pass both fd-set options and a FD list");
-    return TRUE; /* handled */
+    g_set_error_literal (error,
+                         G_DBUS_ERROR,
+                         G_DBUS_ERROR_INVALID_ARGS,
+                         "Must pass both fd-set options and a FD list");
+    return FALSE;
   }
   if (fd_list != nullptr && fd_array != nullptr) {
     const int *fd_array_data;
@@ -179,38 +169,119 @@ terminal_receiver_impl_exec (TerminalReceiver *receiver,
       const int idx = fd_array_data[2 * i + 1];
 
       if (fd == -1) {
-        g_dbus_method_invocation_return_error (invocation,
-                                               G_DBUS_ERROR,
-                                               G_DBUS_ERROR_INVALID_ARGS,
-                                               "Passing of invalid FD %d not supported", fd);
-	return TRUE; /* handled */
+        g_set_error (error,
+                     G_DBUS_ERROR,
+                     G_DBUS_ERROR_INVALID_ARGS,
+                     "Passing of invalid FD %d not supported", fd);
+        return FALSE;
       }
       if (fd == STDIN_FILENO ||
           fd == STDOUT_FILENO ||
           fd == STDERR_FILENO) {
-        g_dbus_method_invocation_return_error (invocation,
-                                               G_DBUS_ERROR,
-                                               G_DBUS_ERROR_INVALID_ARGS,
-                                               "Passing of std%s not supported",
-                                               fd == STDIN_FILENO ? "in" : fd == STDOUT_FILENO ? "out" : "err");
-	return TRUE; /* handled */
+        g_set_error (error,
+                     G_DBUS_ERROR,
+                     G_DBUS_ERROR_INVALID_ARGS,
+                     "Passing of std%s not supported",
+                     fd == STDIN_FILENO ? "in" : fd == STDOUT_FILENO ? "out" : "err");
+        return FALSE;
       }
       if (idx < 0 || idx >= n_fds) {
-        g_dbus_method_invocation_return_error_literal (invocation,
-                                                       G_DBUS_ERROR,
-                                                       G_DBUS_ERROR_INVALID_ARGS,
-                                                       "Handle out of range");
-        return TRUE; /* handled */
+        g_set_error_literal (error,
+                             G_DBUS_ERROR,
+                             G_DBUS_ERROR_INVALID_ARGS,
+                             "Handle out of range");
+        return FALSE;
       }
     }
   }
 
+  return TRUE;
+}
+
+/*
+ * exec_screen_with_options:
+ * @screen: a #TerminalScreen
+ * @options: the Exec options of type "a{sv}", already checked with check_exec_options()
+ * @arguments: the Exec arguments of type "aay"
+ * @fd_list: (allow-none): a #GUnixFDList
+ * @callback: the exec callback
+ * @user_data: (transfer full): the callback data; adopted even on failure
+ * @destroy_notify:
+ * @error:
+ *
+ * Starts the child process in @screen; see terminal_screen_exec().
+ *
+ * Returns: %TRUE on success, or %FALSE with @error filled in
+ */
+static gboolean
+exec_screen_with_options (TerminalScreen *screen,
+                          GVariant *options,
+                          GVariant *arguments,
+                          GUnixFDList *fd_list,
+                          TerminalScreenExecCallback callback,
+                          gpointer user_data,
+                          GDestroyNotify destroy_notify,
+                          GError **error)
+{
+  const char *working_directory;
+  gboolean shell;
+  gsize exec_argc;
+  gs_free char **exec_argv = nullptr; /* container needs to be freed, strings not owned */
+  gs_free char **envv = nullptr; /* container needs to be freed, strings not owned */
+  gs_unref_variant GVariant *fd_array = nullptr;
+
+  if (!g_variant_lookup (options, "cwd", "^&ay", &working_directory))
+    working_directory = nullptr;
+  if (!g_variant_lookup (options, "shell", "b", &shell))
+    shell = FALSE;
+  if (!g_variant_lookup (options, "environ", "^a&ay", &envv))
+    envv = nullptr;
+  if (!g_variant_lookup (options, "fd-set", "@a(ih)", &fd_array))
+    fd_array = nullptr;
+
   if (working_directory != nullptr)
     _terminal_debug_print (TERMINAL_DEBUG_SERVER,
                            "CWD is '%s'\n", working_directory);
 
   exec_argv = (char **) g_variant_get_bytestring_array (arguments, &exec_argc);
 
+  return terminal_screen_exec (screen,
+                               exec_argc > 0 ? exec_argv : nullptr,
+                               envv,
+                               shell,
+                               working_directory,
+                               fd_list, fd_array,
+                               callback,
+                               user_data,
+                               destroy_notify,
+                               nullptr /* cancellable */,
+                               error);
+}
+
+static gboolean
+terminal_receiver_impl_exec (TerminalReceiver *receiver,
+                             GDBusMethodInvocation *invocation,
+                             GUnixFDList *fd_list,
+                             GVariant *options,
+                             GVariant *arguments)
+{
+  TerminalReceiverImpl *impl = TERMINAL_RECEIVER_IMPL (receiver);
+  TerminalReceiverImplPrivate *priv = impl->priv;
+
+  if (priv->screen == nullptr) {
+    g_dbus_method_invocation_return_error_literal (invocation,
+                                                   G_DBUS_ERROR,
+                                                   G_DBUS_ERROR_FAILED,
+                                                   "Terminal already closed");
+    return TRUE; /* handled */
+  }
+
+  GError *err = nullptr;
+  if (!check_exec_options (options, fd_list, &err)) {
+    g_dbus_method_invocation_take_error (invocation, err);
+    return TRUE; /* handled */
+  }
+
   ExecData *exec_data = g_new (ExecData, 1);
   exec_data->receiver = (TerminalReceiver*)g_object_ref (receiver);
   /* We want to transfer the ownership of @invocation to ExecData here, but
@@ -221,18 +292,14 @@ terminal_receiver_impl_exec (TerminalReceiver *receiver,
    */
   exec_data->invocation = (GDBusMethodInvocation*)g_object_ref (invocation);
 
-  GError *err = nullptr;
-  if (!terminal_screen_exec (priv->screen,
-                             exec_argc > 0 ? exec_argv : nullptr,
-                             envv,
-                             shell,
-                             working_directory,
-                             fd_list, fd_array,
-                             (TerminalScreenExecCallback) exec_cb,
-                             exec_data /* adopted */,
-                             (GDestroyNotify) exec_data_free,
-                             nullptr /* cancellable */,
-                             &err)) {
+  if (!exec_screen_with_options (priv->screen,
+                                 options,
+                                 arguments,
+                                 fd_list,
+                                 (TerminalScreenExecCallback) exec_cb,
+                                 exec_data /* adopted */,
+                                 (GDestroyNotify) exec_data_free,
+                                 &err)) {
     /* Transfers ownership of @invocation */
     g_dbus_method_invocation_take_error (invocation, err);
   }
@@ -378,24 +445,38 @@ struct _TerminalFactoryImplPrivate {
   gpointer dummy;
 };
 
-static gboolean
-terminal_factory_impl_create_instance (TerminalFactory *factory,
-                                       GDBusMethodInvocation *invocation,
-                                       GVariant *options)
+/*
+ * create_instance:
+ * @app: the #TerminalApp
+ * @options: the CreateInstance options of type "a{sv}"
+ * @batch_screens: (allow-none) (element-type TerminalScreen): the screens
+ *   created so far in the same CreateInstances call, or %nullptr; elements
+ *   are %nullptr for instances that failed
+ * @error:
+ *
+ * Creates a new #TerminalScreen in a new or existing window according
+ * to @options.
+ *
+ * Returns: (transfer none): the new #TerminalScreen, or %nullptr with
+ *   @error filled in
+ */
+static TerminalScreen *
+create_instance (TerminalApp *app,
+                 GVariant *options,
+                 GPtrArray *batch_screens,
+                 GError **error)
 {
-  TerminalApp *app = terminal_app_get ();
-
   /* If a parent screen is specified, use that to fill in missing information */
   TerminalScreen *parent_screen = nullptr;
   const char *parent_screen_object_path;
   if (g_variant_lookup (options, "parent-screen", "&o", &parent_screen_object_path)) {
     parent_screen = terminal_app_get_screen_by_object_path (app, parent_screen_object_path);
     if (parent_screen == nullptr) {
-      g_dbus_method_invocation_return_error (invocation,
-                                             G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
-                                             "Failed to get screen from object path %s",
-                                             parent_screen_object_path);
-      return TRUE;
+      g_set_error (error,
+                   G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
+                   "Failed to get screen from object path %s",
+                   parent_screen_object_path);
+      return nullptr;
     }
   }
 
@@ -404,18 +485,33 @@ terminal_factory_impl_create_instance (TerminalFactory *factory,
    */
   TerminalWindow *window = nullptr;
   gboolean have_new_window = FALSE;
+  TerminalScreen *window_screen = nullptr;
   const char *window_from_screen_object_path;
+  guint window_from_instance;
   if (g_variant_lookup (options, "window-from-screen", "&o", &window_from_screen_object_path)) {
-    TerminalScreen *window_screen =
+    window_screen =
       terminal_app_get_screen_by_object_path (app, window_from_screen_object_path);
     if (window_screen == nullptr) {
-      g_dbus_method_invocation_return_error (invocation,
-                                             G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
-                                             "Failed to get screen from object path %s",
-                                             parent_screen_object_path);
-      return TRUE;
+      g_set_error (error,
+                   G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
+                   "Failed to get screen from object path %s",
+                   window_from_screen_object_path);
+      return nullptr;
+    }
+  } else if (batch_screens != nullptr &&
+             g_variant_lookup (options, "window-from-instance", "u", &window_from_instance)) {
+    if (window_from_instance < batch_screens->len)
+      window_screen = (TerminalScreen*)g_ptr_array_index (batch_screens, window_from_instance);
+    if (window_screen == nullptr) {
+      g_set_error (error,
+                   G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
+                   "Failed to get screen from instance %u",
+                   window_from_instance);
+      return nullptr;
     }
+  }
 
+  if (window_screen != nullptr) {
     GtkWidget *win = GTK_WIDGET (gtk_widget_get_root (GTK_WIDGET (window_screen)));
     if (TERMINAL_IS_WINDOW (win))
       window = TERMINAL_WINDOW (win);
@@ -427,11 +523,11 @@ terminal_factory_impl_create_instance (TerminalFactory *factory,
     GtkWindow *win = gtk_application_get_window_by_id (GTK_APPLICATION (app), window_id);
 
     if (!TERMINAL_IS_WINDOW (win)) {
-      g_dbus_method_invocation_return_error (invocation,
-                                             G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
-                                             "Nonexisting window %u referenced",
-                                             window_id);
-      return TRUE;
+      g_set_error (error,
+                   G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
+                   "Nonexisting window %u referenced",
+                   window_id);
+      return nullptr;
     }
 
     window = TERMINAL_WINDOW (win);
@@ -498,15 +594,11 @@ terminal_factory_impl_create_instance (TerminalFactory *factory,
   if (profile_uuid == nullptr && parent_screen != nullptr) {
     profile = terminal_screen_ref_profile (parent_screen);
   } else {
-    GError *err = nullptr;
     profile = terminal_profiles_list_ref_profile_by_uuid (terminal_app_get_profiles_list (app),
                                                           profile_uuid /* default if nullptr */,
-                                                          &err);
-    if (profile == nullptr) {
-      g_dbus_method_invocation_return_gerror (invocation, err);
-      g_error_free (err);
-      return TRUE;
-    }
+                                                          error);
+    if (profile == nullptr)
+      return nullptr;
   }
 
   terminal_assert_nonnull (profile);
@@ -540,16 +632,285 @@ terminal_factory_impl_create_instance (TerminalFactory *factory,
   if (have_new_window || (present_window_set && present_window))
     gtk_window_present (GTK_WINDOW (window));
 
+  return screen;
+}
+
+static gboolean
+terminal_factory_impl_create_instance (TerminalFactory *factory,
+                                       GDBusMethodInvocation *invocation,
+                                       GVariant *options)
+{
+  TerminalApp *app = terminal_app_get ();
+
+  GError *err = nullptr;
+  TerminalScreen *screen = create_instance (app, options, nullptr, &err);
+  if (screen == nullptr) {
+    g_dbus_method_invocation_take_error (invocation, err);
+    return TRUE;
+  }
+
   gs_free char *object_path = terminal_app_dup_screen_object_path (app, screen);
   terminal_factory_complete_create_instance (factory, invocation, object_path);
 
   return TRUE; /* handled */
 }
 
+namespace {
+
+typedef struct {
+  TerminalFactory *factory;
+  GDBusMethodInvocation *invocation;
+  GPtrArray *receivers; /* element-type: owned char* object path */
+  GPtrArray *errors; /* element-type: owned char* error message */
+  guint n_pending;
+} CreateInstancesData;
+
+typedef struct {
+  CreateInstancesData *batch; /* unowned */
+  guint index;
+  char *what; /* the command or working directory, for error messages */
+} CreateInstancesExecData;
+
+} // anon namespace
+
+static void
+create_instances_data_maybe_complete (CreateInstancesData *data)
+{
+  if (data->n_pending > 0)
+    return;
+
+  g_ptr_array_add (data->receivers, nullptr);
+  g_ptr_array_add (data->errors, nullptr);
+
+  terminal_factory_complete_create_instances (data->factory,
+                                              data->invocation,
+                                              nullptr /* outfdlist */,
+                                              (const char * const *) data->receivers->pdata,
+                                              (const char * const *) data->errors->pdata);
+
+  g_object_unref (data->factory);
+  g_ptr_array_unref (data->receivers);
+  g_ptr_array_unref (data->errors);
+  g_free (data);
+}
+
+/*
+ * create_instances_set_error:
+ * @data: the #CreateInstancesData
+ * @index: the index of the failed instance
+ * @error: the error
+ * @what: (allow-none): the command or working directory that failed
+ *
+ * Marks the instance at @index as failed. Its receiver object path is
+ * set to "/", and its error message names @what, if given.
+ */
+static void
+create_instances_set_error (CreateInstancesData *data,
+                            guint index,
+                            GError *error,
+                            const char *what)
+{
+  g_free (data->receivers->pdata[index]);
+  data->receivers->pdata[index] = g_strdup ("/");
+  g_free (data->errors->pdata[index]);
+  data->errors->pdata[index] = what ? g_strdup_printf ("“%s”: %s", what, error->message)
+                                    : g_strdup (error->message);
+}
+
+/*
+ * exec_options_dup_what:
+ * @options: the exec options
+ * @arguments: the arguments
+ *
+ * Returns: (transfer full) (nullable): the command from @arguments, or the
+ *   working directory from @options when running the default shell
+ */
+static char *
+exec_options_dup_what (GVariant *options,
+                       GVariant *arguments)
+{
+  if (g_variant_n_children (arguments) > 0) {
+    gs_unref_variant GVariant *arg0 = g_variant_get_child_value (arguments, 0);
+    return g_strdup (g_variant_get_bytestring (arg0));
+  }
+
+  const char *working_directory;
+  if (g_variant_lookup (options, "cwd", "^&ay", &working_directory))
+    return g_strdup (working_directory);
+
+  return nullptr;
+}
+
+static void
+create_instances_exec_cb (TerminalScreen *screen, /* unused, may be %nullptr */
+                          GError *error, /* set on error, %nullptr on success */
+                          CreateInstancesExecData *data)
+{
+  if (error)
+    create_instances_set_error (data->batch, data->index, error, data->what);
+}
+
+static void
+create_instances_exec_data_free (CreateInstancesExecData *data)
+{
+  CreateInstancesData *batch = data->batch;
+
+  g_free (data->what);
+  g_free (data);
+
+  batch->n_pending--;
+  create_instances_data_maybe_complete (batch);
+}
+
+/*
+ * dup_fd_list_range:
+ * @fd_list: a #GUnixFDList
+ * @fd_index: the index of the first FD to copy
+ * @fd_array: the "fd-set" option of type "a(ih)", with handles relative to @fd_index
+ * @error:
+ *
+ * Returns: (transfer full): a new #GUnixFDList containing the FDs referenced
+ *   by @fd_array, or %nullptr with @error filled in
+ */
+static GUnixFDList *
+dup_fd_list_range (GUnixFDList *fd_list,
+                   int fd_index,
+                   GVariant *fd_array,
+                   GError **error)
+{
+  gsize fd_array_data_len;
+  const int *fd_array_data = reinterpret_cast<int const*>
+    (g_variant_get_fixed_array (fd_array, &fd_array_data_len, 2 * sizeof (int)));
+
+  int n_handles = 0;
+  for (gsize i = 0; i < fd_array_data_len; i++)
+    n_handles = MAX (n_handles, fd_array_data[2 * i + 1] + 1);
+
+  int n_fds = 0;
+  const int *fds = fd_list ? g_unix_fd_list_peek_fds (fd_list, &n_fds) : nullptr;
+  if (fd_index < 0 || fd_index + n_handles > n_fds) {
+    g_set_error_literal (error,
+                         G_DBUS_ERROR,
+                         G_DBUS_ERROR_INVALID_ARGS,
+                         "Handle out of range");
+    return nullptr;
+  }
+
+  gs_unref_object GUnixFDList *list = g_unix_fd_list_new ();
+  for (int i = 0; i < n_handles; i++) {
+    if (g_unix_fd_list_append (list, fds[fd_index + i], error) == -1)
+      return nullptr;
+  }
+
+  return (GUnixFDList*)g_steal_pointer (&list);
+}
+
+static gboolean
+terminal_factory_impl_create_instances (TerminalFactory *factory,
+                                        GDBusMethodInvocation *invocation,
+                                        GUnixFDList *fd_list,
+                                        GVariant *instances)
+{
+  TerminalApp *app = terminal_app_get ();
+
+  gsize n_instances = g_variant_n_children (instances);
+
+  _terminal_debug_print (TERMINAL_DEBUG_SERVER,
+                         "Creating %" G_GSIZE_FORMAT " instances\n", n_instances);
+
+  CreateInstancesData *data = g_new0 (CreateInstancesData, 1);
+  data->factory = (TerminalFactory*)g_object_ref (factory);
+  data->invocation = invocation; /* adopted */
+  data->receivers = g_ptr_array_new_full (n_instances + 1, g_free);
+  data->errors = g_ptr_array_new_full (n_instances + 1, g_free);
+  /* Hold one pending count for ourself so the call cannot complete
+   * before all instances have been processed.
+   */
+  data->n_pending = 1;
+
+  gs_unref_ptrarray GPtrArray *screens = g_ptr_array_sized_new (n_instances);
+
+  /* First create all the screens, so that they may refer to
+   * earlier ones' windows via the "window-from-instance" option.
+   */
+  for (gsize i = 0; i < n_instances; i++) {
+    gs_unref_variant GVariant *create_options = nullptr;
+    g_variant_get_child (instances, i, "(@a{sv}@a{sv}@aayi)",
+                         &create_options, nullptr, nullptr, nullptr);
+
+    gs_free_error GError *err = nullptr;
+    TerminalScreen *screen = create_instance (app, create_options, screens, &err);
+    g_ptr_array_add (screens, screen);
+
+    if (screen != nullptr) {
+      g_ptr_array_add (data->receivers, terminal_app_dup_screen_object_path (app, screen));
+      g_ptr_array_add (data->errors, g_strdup (""));
+    } else {
+      g_ptr_array_add (data->receivers, nullptr);
+      g_ptr_array_add (data->errors, nullptr);
+      create_instances_set_error (data, i, err, nullptr);
+    }
+  }
+
+  /* Now spawn their child processes */
+  for (gsize i = 0; i < n_instances; i++) {
+    TerminalScreen *screen = (TerminalScreen*)g_ptr_array_index (screens, i);
+    if (screen == nullptr)
+      continue;
+
+    gs_unref_variant GVariant *exec_options = nullptr;
+    gs_unref_variant GVariant *arguments = nullptr;
+    int fd_index;
+    g_variant_get_child (instances, i, "(@a{sv}@a{sv}@aayi)",
+                         nullptr, &exec_options, &arguments, &fd_index);
+
+    gs_free_error GError *err = nullptr;
+    gs_free char *what = exec_options_dup_what (exec_options, arguments);
+    gs_unref_object GUnixFDList *screen_fd_list = nullptr;
+    gs_unref_variant GVariant *fd_array = nullptr;
+    if (fd_index != -1 &&
+        g_variant_lookup (exec_options, "fd-set", "@a(ih)", &fd_array)) {
+      screen_fd_list = dup_fd_list_range (fd_list, fd_index, fd_array, &err);
+      if (screen_fd_list == nullptr) {
+        create_instances_set_error (data, i, err, what);
+        continue;
+      }
+    }
+
+    if (!check_exec_options (exec_options, screen_fd_list, &err)) {
+      create_instances_set_error (data, i, err, what);
+      continue;
+    }
+
+    CreateInstancesExecData *exec_data = g_new (CreateInstancesExecData, 1);
+    exec_data->batch = data;
+    exec_data->index = i;
+    exec_data->what = g_strdup (what);
+    data->n_pending++;
+
+    if (!exec_screen_with_options (screen,
+                                   exec_options,
+                                   arguments,
+                                   screen_fd_list,
+                                   (TerminalScreenExecCallback) create_instances_exec_cb,
+                                   exec_data /* adopted */,
+                                   (GDestroyNotify) create_instances_exec_data_free,
+                                   &err)) {
+      create_instances_set_error (data, i, err, what);
+    }
+  }
+
+  data->n_pending--;
+  create_instances_data_maybe_complete (data);
+
+  return TRUE; /* handled */
+}
+
 static void
 terminal_factory_impl_iface_init (TerminalFactoryIface *iface)
 {
   iface->handle_create_instance = terminal_factory_impl_create_instance;
+  iface->handle_create_instances = terminal_factory_impl_create_instances;
 }
 
 G_DEFINE_TYPE_WITH_CODE (TerminalFactoryImpl, terminal_factory_impl, TERMINAL_TYPE_FACTORY_SKELETON,
@@ -0,0 +1,296 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "terminal-icon-cache.hh"
+#include "terminal-libgsystem.hh"
+
+/* The cache is dropped entirely when it grows beyond this; it only gets
+ * there with many different colours or scales in use.
+ */
+#define MAX_ENTRIES (512)
+
+enum {
+  KIND_COLOR = 1,
+  KIND_PROGRESS = 2,
+};
+
+static GHashTable *cache = nullptr; /* gint64 key -> GdkTexture */
+
+static guint32
+pack_color (const GdkRGBA *color)
+{
+  auto const channel = [](float v) -> guint32 {
+    return guint32(CLAMP (v, 0.f, 1.f) * 255.f + .5f);
+  };
+
+  return channel (color->red) << 24 |
+    channel (color->green) << 16 |
+    channel (color->blue) << 8 |
+    channel (color->alpha);
+}
+
+static gint64
+make_key (guint kind,
+          guint hint,
+          guint bucket,
+          int scale,
+          const GdkRGBA *color)
+{
+  return gint64(guint64(kind & 0xff) << 56 |
+                guint64(hint & 0xff) << 48 |
+                guint64(bucket & 0xff) << 40 |
+                guint64(scale & 0xff) << 32 |
+                pack_color (color));
+}
+
+static GdkTexture *
+cache_lookup (gint64 key)
+{
+  if (cache == nullptr)
+    return nullptr;
+
+  auto const texture = reinterpret_cast<GdkTexture*>(g_hash_table_lookup (cache, &key));
+  return texture ? (GdkTexture*)g_object_ref (texture) : nullptr;
+}
+
+static GdkTexture *
+cache_insert (gint64 key,
+              GdkTexture *texture)
+{
+  if (cache == nullptr)
+    cache = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                   g_free, g_object_unref);
+  else if (g_hash_table_size (cache) >= MAX_ENTRIES)
+    g_hash_table_remove_all (cache);
+
+  g_hash_table_insert (cache, g_memdup2 (&key, sizeof (key)), g_object_ref (texture));
+  return texture;
+}
+
+static GdkTexture*
+texture_from_surface(cairo_surface_t* surface)
+{
+  gs_unref_bytes auto bytes =
+    g_bytes_new_with_free_func(cairo_image_surface_get_data(surface),
+                               size_t(cairo_image_surface_get_height(surface)) *
+                               size_t(cairo_image_surface_get_stride(surface)),
+                               GDestroyNotify(cairo_surface_destroy),
+                               cairo_surface_reference(surface));
+
+  return gdk_memory_texture_new(cairo_image_surface_get_width(surface),
+                                cairo_image_surface_get_height(surface),
+                                GDK_MEMORY_DEFAULT,
+                                bytes,
+                                cairo_image_surface_get_stride(surface));
+}
+
+/*
+ * terminal_icon_cache_get_color:
+ * @color: the colour
+ * @scale: the scale factor
+ *
+ * Returns: (transfer full): a texture of a circle filled with @color
+ */
+GdkTexture *
+terminal_icon_cache_get_color (const GdkRGBA *color,
+                               int scale)
+{
+  auto const key = make_key (KIND_COLOR, 0, 0, scale, color);
+  if (auto texture = cache_lookup (key))
+    return texture;
+
+  auto const w = 32 * scale, h = 32 * scale;
+  auto const xc = w / 2, yc = h / 2;
+  auto const radius = w / 2 - 1;
+
+  auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+  auto cr = cairo_create(surface);
+  cairo_set_source_rgb(cr, color->red, color->green, color->blue);
+  cairo_new_sub_path(cr);
+  cairo_arc(cr, xc, yc, radius, 0., G_PI * 2);
+  cairo_close_path(cr);
+  cairo_fill(cr);
+
+  cairo_destroy(cr);
+
+  auto const texture = texture_from_surface(surface);
+  cairo_surface_destroy(surface);
+
+  return cache_insert (key, texture);
+}
+
+/*
+ * terminal_icon_cache_get_progress:
+ * @hint: the progress hint the icon is for
+ * @bucket: the progress, from 0 to %TERMINAL_ICON_CACHE_PROGRESS_BUCKETS
+ * @color: the foreground colour
+ * @scale: the scale factor
+ *
+ * Returns: (transfer full): a texture of a pie chart showing the progress
+ */
+GdkTexture *
+terminal_icon_cache_get_progress (int hint,
+                                  guint bucket,
+                                  const GdkRGBA *color,
+                                  int scale)
+{
+  bucket = MIN (bucket, guint(TERMINAL_ICON_CACHE_PROGRESS_BUCKETS));
+
+  auto const key = make_key (KIND_PROGRESS, hint, bucket, scale, color);
+  if (auto texture = cache_lookup (key))
+    return texture;
+
+  auto const w = 16 * scale, h = 16 * scale;
+  auto const xc = w / 2, yc = h / 2;
+  auto const radius = w / 2 - 1;
+
+  auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+  auto cr = cairo_create(surface);
+
+  // First draw a shadow filled circle
+  cairo_set_source_rgba(cr, color->red, color->green, color->blue, 0.25);
+  cairo_arc(cr, xc, yc, radius, 0., 2 * G_PI);
+  cairo_close_path(cr);
+  cairo_fill(cr);
+
+  // Now draw progress filled circle
+  auto const fraction = double(bucket) / TERMINAL_ICON_CACHE_PROGRESS_BUCKETS;
+  if (fraction > 0.) {
+    cairo_set_line_width(cr, 1.);
+    cairo_set_source_rgb(cr, color->red, color->green, color->blue);
+    cairo_new_sub_path(cr);
+
+    if (fraction < 1.) {
+      cairo_move_to(cr, xc, yc);
+      cairo_line_to(cr, xc + radius, yc);
+      cairo_arc_negative(cr, xc, yc, radius, 0, 2 * G_PI * (1. - fraction));
+      cairo_line_to(cr, xc, yc);
+    } else {
+      cairo_arc(cr, xc, yc, radius, 0, 2 * G_PI);
+    }
+
+    cairo_close_path(cr);
+    cairo_fill(cr);
+  }
+  cairo_destroy(cr);
+
+  auto const texture = texture_from_surface(surface);
+  cairo_surface_destroy(surface);
+
+  return cache_insert (key, texture);
+}
+
+/*
+ * terminal_icon_cache_clear:
+ *
+ * Drops all cached textures.
+ */
+void
+terminal_icon_cache_clear (void)
+{
+  g_clear_pointer (&cache, g_hash_table_unref);
+}
+
+#ifdef TERMINAL_ICON_CACHE_MAIN
+
+#define N_UPDATES (10000)
+
+/* Simulates a screen receiving 10000 progress updates, with the
+ * fraction the way terminal_screen_progress_value_changed_cb() gets it,
+ * and checks that they don't create more textures than there are
+ * buckets. The time they take is only logged.
+ */
+static void
+test_progress_stress (void)
+{
+  terminal_icon_cache_clear ();
+
+  auto const color = GdkRGBA{0.8f, 0.8f, 0.8f, 1.f};
+  GPtrArray *seen = g_ptr_array_new ();
+  gs_unref_object GdkTexture *last = nullptr;
+
+  auto const start = g_get_monotonic_time ();
+  for (auto i = 0; i < N_UPDATES; ++i) {
+    /* Progress goes up in 0.01% steps, wrapping around */
+    auto const value = (i % 1000) / 10.;
+    auto const bucket = guint(value / 100. * TERMINAL_ICON_CACHE_PROGRESS_BUCKETS + .5);
+
+    g_clear_object (&last);
+    last = terminal_icon_cache_get_progress (1, bucket, &color, 1 + i % 2);
+    g_assert_nonnull (last);
+    if (!g_ptr_array_find (seen, last, nullptr))
+      g_ptr_array_add (seen, last);
+  }
+  auto const elapsed = g_get_monotonic_time () - start;
+
+  g_test_message ("%d updates took %" G_GINT64_FORMAT "us, %u textures",
+                  N_UPDATES, elapsed, seen->len);
+
+  /* At most one per bucket and scale */
+  g_assert_cmpuint (seen->len, <=, 2 * (TERMINAL_ICON_CACHE_PROGRESS_BUCKETS + 1));
+
+  g_ptr_array_unref (seen);
+  terminal_icon_cache_clear ();
+}
+
+static void
+test_progress_reuse (void)
+{
+  terminal_icon_cache_clear ();
+
+  auto const color = GdkRGBA{0.f, 0.f, 0.f, 1.f};
+  auto const other_color = GdkRGBA{1.f, 1.f, 1.f, 1.f};
+
+  gs_unref_object auto a = terminal_icon_cache_get_progress (1, 32, &color, 1);
+  gs_unref_object auto b = terminal_icon_cache_get_progress (1, 32, &color, 1);
+  g_assert_true (a == b);
+
+  gs_unref_object auto c = terminal_icon_cache_get_progress (1, 33, &color, 1);
+  g_assert_true (a != c);
+
+  gs_unref_object auto d = terminal_icon_cache_get_progress (1, 32, &color, 2);
+  g_assert_true (a != d);
+  g_assert_cmpint (gdk_texture_get_width (d), ==, 2 * gdk_texture_get_width (a));
+
+  gs_unref_object auto e = terminal_icon_cache_get_progress (1, 32, &other_color, 1);
+  g_assert_true (a != e);
+
+  gs_unref_object auto f = terminal_icon_cache_get_progress (2, 32, &color, 1);
+  g_assert_true (a != f);
+
+  gs_unref_object auto g = terminal_icon_cache_get_color (&color, 1);
+  gs_unref_object auto h = terminal_icon_cache_get_color (&color, 1);
+  g_assert_true (g == h);
+
+  terminal_icon_cache_clear ();
+}
+
+int
+main (int argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, nullptr);
+
+  g_test_add_func ("/terminal/icon-cache/progress/reuse", test_progress_reuse);
+  g_test_add_func ("/terminal/icon-cache/progress/stress", test_progress_stress);
+
+  return g_test_run ();
+}
+
+#endif /* TERMINAL_ICON_CACHE_MAIN */
@@ -0,0 +1,37 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/* The number of different progress fractions the progress icon shows */
+#define TERMINAL_ICON_CACHE_PROGRESS_BUCKETS (64)
+
+GdkTexture *terminal_icon_cache_get_color (const GdkRGBA *color,
+                                           int scale);
+
+GdkTexture *terminal_icon_cache_get_progress (int hint,
+                                              guint bucket,
+                                              const GdkRGBA *color,
+                                              int scale);
+
+void terminal_icon_cache_clear (void);
+
+G_END_DECLS
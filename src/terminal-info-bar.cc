@@ -27,6 +27,7 @@ struct _TerminalInfoBar
   GtkWidget  parent_instance;
   GtkWidget *info_bar;
   GtkWidget *content_box;
+  GtkWidget *progress_bar;
 };
 
 G_DEFINE_FINAL_TYPE (TerminalInfoBar, terminal_info_bar, GTK_TYPE_WIDGET)
@@ -169,3 +170,53 @@ terminal_info_bar_set_default_response (TerminalInfoBar *bar,
 
   gtk_info_bar_set_default_response (GTK_INFO_BAR (bar->info_bar), response_id);
 }
+
+static GtkProgressBar *
+terminal_info_bar_ensure_progress_bar (TerminalInfoBar *bar)
+{
+  if (bar->progress_bar == nullptr) {
+    bar->progress_bar = gtk_progress_bar_new ();
+    gtk_box_append (GTK_BOX (bar->content_box), bar->progress_bar);
+  }
+
+  return GTK_PROGRESS_BAR (bar->progress_bar);
+}
+
+/**
+ * terminal_info_bar_set_progress:
+ * @bar: a #TerminalInfoBar
+ * @fraction: the fraction done, from 0 to 1, or negative if unknown
+ *
+ * Shows a progress bar below the text of @bar. When the fraction
+ * done is not known, the progress bar pulses instead.
+ */
+void
+terminal_info_bar_set_progress (TerminalInfoBar *bar,
+                                double fraction)
+{
+  g_return_if_fail (TERMINAL_IS_INFO_BAR (bar));
+
+  auto const progress_bar = terminal_info_bar_ensure_progress_bar (bar);
+  if (fraction < 0.)
+    gtk_progress_bar_pulse (progress_bar);
+  else
+    gtk_progress_bar_set_fraction (progress_bar, MIN (fraction, 1.));
+}
+
+/**
+ * terminal_info_bar_set_progress_text:
+ * @bar: a #TerminalInfoBar
+ * @text: (nullable): the text
+ *
+ * Shows @text on the progress bar of @bar.
+ */
+void
+terminal_info_bar_set_progress_text (TerminalInfoBar *bar,
+                                     const char *text)
+{
+  g_return_if_fail (TERMINAL_IS_INFO_BAR (bar));
+
+  auto const progress_bar = terminal_info_bar_ensure_progress_bar (bar);
+  gtk_progress_bar_set_text (progress_bar, text);
+  gtk_progress_bar_set_show_text (progress_bar, text != nullptr);
+}
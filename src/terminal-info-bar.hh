@@ -35,6 +35,10 @@ void terminal_info_bar_format_text (TerminalInfoBar *bar,
                                     ...) G_GNUC_PRINTF (2, 3);
 void terminal_info_bar_set_default_response (TerminalInfoBar *bar,
                                              int response_id);
+void terminal_info_bar_set_progress (TerminalInfoBar *bar,
+                                     double fraction);
+void terminal_info_bar_set_progress_text (TerminalInfoBar *bar,
+                                          const char *text);
 
 G_END_DECLS
 
@@ -38,6 +38,7 @@ extern "C" {
 #include "terminal-debug.hh"
 #include "terminal-defines.hh"
 #include "terminal-gdbus-generated.h"
+#include "terminal-libgsystem.hh"
 
 /* Nautilus extension class */
 
@@ -57,6 +58,18 @@ struct _TerminalNautilus {
         GObject parent_instance;
 
         GSettings *lockdown_prefs;
+        gboolean locked_down;
+
+        GVolumeMonitor *volume_monitor;
+        /* Root URIs of the current mounts, built on demand */
+        GPtrArray *mount_roots;
+        /* Mount root URI or URI scheme -> whether GVFS maps it to a path */
+        GHashTable *local_path_cache;
+
+        /* Cancelled when the extension goes away */
+        GCancellable *cancellable;
+        /* Cached across activations; created on first use */
+        TerminalFactory *factory;
 };
 
 struct _TerminalNautilusClass {
@@ -245,28 +258,111 @@ ssh_argv (const char *uri,
   return argv;
 }
 
+static void
+terminal_nautilus_lockdown_changed_cb (GSettings *settings,
+                                       const char *key,
+                                       TerminalNautilus *nautilus)
+{
+  nautilus->locked_down = g_settings_get_boolean (settings, "disable-command-line");
+}
+
 static gboolean
 terminal_locked_down (TerminalNautilus *nautilus)
 {
-  return g_settings_get_boolean (nautilus->lockdown_prefs,
-                                 "disable-command-line");
+  return nautilus->locked_down;
+}
+
+static void
+terminal_nautilus_mounts_changed_cb (GVolumeMonitor *monitor,
+                                     GMount *mount,
+                                     TerminalNautilus *nautilus)
+{
+  g_clear_pointer (&nautilus->mount_roots, g_ptr_array_unref);
+  g_hash_table_remove_all (nautilus->local_path_cache);
 }
 
-/* used to determine for remote URIs whether GVFS is capable of mapping them to ~/.gvfs */
+/*
+ * terminal_nautilus_find_mount_root:
+ * @nautilus: the #TerminalNautilus
+ * @uri: a URI
+ *
+ * Finds the innermost mount containing @uri. The volume monitor keeps
+ * its mounts in-process, so this doesn't need to talk to gvfsd.
+ *
+ * Returns: (transfer none) (nullable): the root URI of the mount
+ */
+static const char *
+terminal_nautilus_find_mount_root (TerminalNautilus *nautilus,
+                                   const char *uri)
+{
+  if (nautilus->mount_roots == nullptr) {
+    nautilus->mount_roots = g_ptr_array_new_with_free_func (g_free);
+
+    GList *mounts = g_volume_monitor_get_mounts (nautilus->volume_monitor);
+    for (GList *l = mounts; l != nullptr; l = l->next) {
+      gs_unref_object auto root = g_mount_get_root (G_MOUNT (l->data));
+      g_ptr_array_add (nautilus->mount_roots, g_file_get_uri (root));
+    }
+    g_list_free_full (mounts, g_object_unref);
+  }
+
+  const char *best = nullptr;
+  size_t best_len = 0;
+  for (guint i = 0; i < nautilus->mount_roots->len; ++i) {
+    auto const root = reinterpret_cast<const char*>(g_ptr_array_index (nautilus->mount_roots, i));
+    auto const len = strlen (root);
+    if (len <= best_len || strncmp (uri, root, len) != 0)
+      continue;
+    /* Don't match sftp://host/foo against sftp://host/foobar */
+    if (uri[len] != '\0' && uri[len] != '/' && root[len - 1] != '/')
+      continue;
+
+    best = root;
+    best_len = len;
+  }
+
+  return best;
+}
+
+/*
+ * uri_has_local_path:
+ * @nautilus: the #TerminalNautilus
+ * @info: the #TerminalFileInfo for @uri
+ * @uri: a URI
+ *
+ * Used to determine for remote URIs whether GVFS is capable of mapping
+ * them to ~/.gvfs. Asking GVFS may mean IPC with gvfsd, so the answer is
+ * cached per mount, or per URI scheme for locations outside of any mount,
+ * until the mounts change.
+ */
 static gboolean
-uri_has_local_path (const char *uri)
+uri_has_local_path (TerminalNautilus *nautilus,
+                    TerminalFileInfo info,
+                    const char *uri)
 {
-  GFile *file;
-  char *path;
-  gboolean ret;
+  /* file: URIs always have a path; don't bother GVFS with them */
+  if (info == FILE_INFO_LOCAL)
+    return TRUE;
+
+  gs_free char *scheme = nullptr;
+  auto key = terminal_nautilus_find_mount_root (nautilus, uri);
+  if (key == nullptr) {
+    scheme = g_uri_parse_scheme (uri);
+    if (scheme == nullptr)
+      return FALSE;
+
+    key = scheme;
+  }
 
-  file = g_file_new_for_uri (uri);
-  path = g_file_get_path (file);
+  gpointer value;
+  if (g_hash_table_lookup_extended (nautilus->local_path_cache, key, nullptr, &value))
+    return GPOINTER_TO_INT (value);
 
-  ret = (path != nullptr);
+  gs_unref_object auto file = g_file_new_for_uri (uri);
+  gs_free auto path = g_file_get_path (file);
+  gboolean ret = (path != nullptr);
 
-  g_free (path);
-  g_object_unref (file);
+  g_hash_table_insert (nautilus->local_path_cache, g_strdup (key), GINT_TO_POINTER (ret));
 
   return ret;
 }
@@ -276,7 +372,10 @@ uri_has_local_path (const char *uri)
 namespace {
 
 typedef struct {
-  TerminalNautilus *nautilus;
+  GWeakRef nautilus;
+  GCancellable *cancellable;
+  TerminalFactory *factory;
+  TerminalReceiver *receiver;
   guint32 timestamp;
   char *path;
   char *uri;
@@ -289,45 +388,123 @@ typedef struct {
 static void
 exec_data_free (ExecData *data)
 {
-  g_object_unref (data->nautilus);
+  g_weak_ref_clear (&data->nautilus);
+  g_clear_object (&data->cancellable);
+  g_clear_object (&data->factory);
+  g_clear_object (&data->receiver);
   g_free (data->path);
   g_free (data->uri);
 
   g_free (data);
 }
 
-/* FIXME: make this async */
+/* Returns: %FALSE if @error only says that the launch was cancelled
+ * because the extension is going away
+ */
 static gboolean
-create_terminal (ExecData *data /* transfer full */)
+exec_error_is_reportable (GError *error)
 {
-  TerminalFactory *factory;
-  TerminalReceiver *receiver;
-  GError *error = nullptr;
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return FALSE;
+
+  g_dbus_error_strip_remote_error (error);
+  return TRUE;
+}
+
+static void
+exec_done_cb (TerminalReceiver *receiver,
+              GAsyncResult *result,
+              ExecData *data)
+{
+  gs_free_error GError *error = nullptr;
+  if (!terminal_receiver_call_exec_finish (receiver, nullptr /* out FD list */, result, &error) &&
+      exec_error_is_reportable (error))
+    g_printerr ("Error: %s\n", error->message);
+
+  exec_data_free (data);
+}
+
+static void
+receiver_proxy_new_done_cb (GObject *source,
+                            GAsyncResult *result,
+                            ExecData *data)
+{
+  gs_free_error GError *error = nullptr;
+  data->receiver = terminal_receiver_proxy_new_for_bus_finish (result, &error);
+  if (data->receiver == nullptr) {
+    if (exec_error_is_reportable (error))
+      g_printerr ("Failed to create proxy for terminal: %s\n", error->message);
+    exec_data_free (data);
+    return;
+  }
+
   GVariantBuilder builder;
-  char *object_path;
-  char startup_id[32];
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+
+  terminal_client_append_exec_options (&builder,
+                                       TRUE, /* pass environment */
+                                       data->path,
+                                       nullptr, 0, /* FD array */
+                                       TRUE /* shell */);
+
   char **argv;
   int argc;
+  if (data->info == FILE_INFO_SFTP &&
+      data->remote) {
+    argv = ssh_argv (data->uri, &argc);
+  } else {
+    argv = nullptr; argc = 0;
+  }
+
+  terminal_receiver_call_exec (data->receiver,
+                               g_variant_builder_end (&builder),
+                               g_variant_new_bytestring_array ((const char * const *) argv, argc),
+                               nullptr /* in FD list */,
+                               data->cancellable,
+                               (GAsyncReadyCallback) exec_done_cb,
+                               data);
+
+  g_strfreev (argv);
+}
+
+static void
+create_instance_done_cb (TerminalFactory *factory,
+                         GAsyncResult *result,
+                         ExecData *data)
+{
+  gs_free char *object_path = nullptr;
+  gs_free_error GError *error = nullptr;
+  if (!terminal_factory_call_create_instance_finish (factory, &object_path, result, &error)) {
+    if (exec_error_is_reportable (error)) {
+      g_printerr ("Error creating terminal: %s\n", error->message);
+
+      /* Start over with a new proxy next time */
+      gs_unref_object auto nautilus = (TerminalNautilus*)g_weak_ref_get (&data->nautilus);
+      if (nautilus != nullptr && nautilus->factory == factory)
+        g_clear_object (&nautilus->factory);
+    }
 
-  factory = terminal_factory_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
-                                                     GDBusProxyFlags(G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
-								     G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS),
-                                                     TERMINAL_APPLICATION_ID,
-                                                     TERMINAL_FACTORY_OBJECT_PATH,
-                                                     nullptr /* cancellable */,
-                                                     &error);
-  if (factory == nullptr) {
-    g_dbus_error_strip_remote_error (error);
-    g_printerr ("Error constructing proxy for %s:%s: %s\n",
-                TERMINAL_APPLICATION_ID, TERMINAL_FACTORY_OBJECT_PATH,
-                error->message);
-    g_error_free (error);
     exec_data_free (data);
-    return FALSE;
+    return;
   }
 
+  terminal_receiver_proxy_new_for_bus (G_BUS_TYPE_SESSION,
+                                       GDBusProxyFlags(G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                                                       G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS),
+                                       TERMINAL_APPLICATION_ID,
+                                       object_path,
+                                       data->cancellable,
+                                       (GAsyncReadyCallback) receiver_proxy_new_done_cb,
+                                       data);
+}
+
+static void
+create_instance (ExecData *data)
+{
+  char startup_id[32];
   g_snprintf (startup_id, sizeof (startup_id), "_TIME%u", data->timestamp);
 
+  GVariantBuilder builder;
   g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
 
   terminal_client_append_create_instance_options (&builder,
@@ -343,78 +520,95 @@ create_terminal (ExecData *data /* transfer full */)
                                                   FALSE /* maximised */,
                                                   FALSE /* fullscreen */);
 
-  if (!terminal_factory_call_create_instance_sync
-         (factory,
-          g_variant_builder_end (&builder),
-          &object_path,
-          nullptr /* cancellable */,
-          &error)) {
-    g_dbus_error_strip_remote_error (error);
-    g_printerr ("Error creating terminal: %s\n", error->message);
-    g_error_free (error);
-    g_object_unref (factory);
-    exec_data_free (data);
-    return FALSE;
-  }
+  terminal_factory_call_create_instance (data->factory,
+                                         g_variant_builder_end (&builder),
+                                         data->cancellable,
+                                         (GAsyncReadyCallback) create_instance_done_cb,
+                                         data);
+}
 
-  g_object_unref (factory);
-
-  receiver = terminal_receiver_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
-                                                       GDBusProxyFlags(G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
-								       G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS),
-                                                       TERMINAL_APPLICATION_ID,
-                                                       object_path,
-                                                       nullptr /* cancellable */,
-                                                       &error);
-  if (receiver == nullptr) {
-    g_dbus_error_strip_remote_error (error);
-    g_printerr ("Failed to create proxy for terminal: %s\n", error->message);
-    g_error_free (error);
-    g_free (object_path);
+static void
+factory_proxy_new_done_cb (GObject *source,
+                           GAsyncResult *result,
+                           ExecData *data)
+{
+  gs_free_error GError *error = nullptr;
+  data->factory = terminal_factory_proxy_new_for_bus_finish (result, &error);
+  if (data->factory == nullptr) {
+    if (exec_error_is_reportable (error))
+      g_printerr ("Error constructing proxy for %s:%s: %s\n",
+                  TERMINAL_APPLICATION_ID, TERMINAL_FACTORY_OBJECT_PATH,
+                  error->message);
     exec_data_free (data);
-    return FALSE;
+    return;
   }
 
-  g_free (object_path);
-
-  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  /* The proxy follows the owner of the well-known name, so it stays
+   * usable across server restarts.
+   */
+  gs_unref_object auto nautilus = (TerminalNautilus*)g_weak_ref_get (&data->nautilus);
+  if (nautilus != nullptr && nautilus->factory == nullptr)
+    nautilus->factory = (TerminalFactory*)g_object_ref (data->factory);
 
-  terminal_client_append_exec_options (&builder,
-                                       TRUE, /* pass environment */
-                                       data->path,
-                                       nullptr, 0, /* FD array */
-                                       TRUE /* shell */);
+  create_instance (data);
+}
 
-  if (data->info == FILE_INFO_SFTP &&
-      data->remote) {
-    argv = ssh_argv (data->uri, &argc);
-  } else {
-    argv = nullptr; argc = 0;
+/*
+ * create_terminal:
+ * @nautilus: the #TerminalNautilus
+ * @data: (transfer full): the #ExecData
+ *
+ * Asynchronously opens a terminal for @data. Nothing here blocks, so a
+ * server that is still starting up doesn't hang the file manager.
+ */
+static void
+create_terminal (TerminalNautilus *nautilus,
+                 ExecData *data /* transfer full */)
+{
+  if (nautilus->factory != nullptr) {
+    data->factory = (TerminalFactory*)g_object_ref (nautilus->factory);
+    create_instance (data);
+    return;
   }
 
-  if (!terminal_receiver_call_exec_sync (receiver,
-                                         g_variant_builder_end (&builder),
-                                         g_variant_new_bytestring_array ((const char * const *) argv, argc),
-                                         nullptr /* in FD list */,
-                                         nullptr /* out FD list */,
-                                         nullptr /* cancellable */,
-                                         &error)) {
-    g_dbus_error_strip_remote_error (error);
-    g_printerr ("Error: %s\n", error->message);
-    g_error_free (error);
-    g_strfreev (argv);
-    g_object_unref (receiver);
-    exec_data_free (data);
-    return FALSE;
-  }
+  terminal_factory_proxy_new_for_bus (G_BUS_TYPE_SESSION,
+                                      GDBusProxyFlags(G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                                                      G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS),
+                                      TERMINAL_APPLICATION_ID,
+                                      TERMINAL_FACTORY_OBJECT_PATH,
+                                      data->cancellable,
+                                      (GAsyncReadyCallback) factory_proxy_new_done_cb,
+                                      data);
+}
 
-  g_strfreev (argv);
+static void
+resolve_path_thread (GTask *task,
+                     gpointer source_object,
+                     gpointer task_data,
+                     GCancellable *cancellable)
+{
+  auto const data = reinterpret_cast<ExecData*>(task_data);
 
-  exec_data_free (data);
+  gs_unref_object auto file = g_file_new_for_uri (data->uri);
+  g_task_return_pointer (task, g_file_get_path (file), g_free);
+}
+
+static void
+resolve_path_done_cb (GObject *source,
+                      GAsyncResult *result,
+                      ExecData *data)
+{
+  data->path = (char*)g_task_propagate_pointer (G_TASK (result), nullptr);
 
-  g_object_unref (receiver);
+  gs_unref_object auto nautilus = (TerminalNautilus*)g_weak_ref_get (&data->nautilus);
+  if (data->path == nullptr ||
+      nautilus == nullptr ||
+      g_cancellable_is_cancelled (data->cancellable)) {
+    exec_data_free (data);
+    return;
+  }
 
-  return TRUE;
+  create_terminal (nautilus, data);
 }
 
 static void
@@ -424,6 +618,7 @@ terminal_nautilus_menu_item_activate (NautilusMenuItem *item)
   TerminalNautilus *nautilus = menu_item->nautilus;
   char *uri, *path;
   TerminalFileInfo info;
+  gboolean resolve_path;
   ExecData *data;
 
   uri = nautilus_file_info_get_activation_uri (menu_item->file_info);
@@ -431,11 +626,16 @@ terminal_nautilus_menu_item_activate (NautilusMenuItem *item)
     return;
 
   path = nullptr;
+  resolve_path = FALSE;
   info = get_terminal_file_info_from_uri (uri);
 
   switch (info) {
     case FILE_INFO_LOCAL:
       path = g_filename_from_uri (uri, nullptr, nullptr);
+      if (path == nullptr) {
+        g_free (uri);
+        return;
+      }
       break;
 
     case FILE_INFO_DESKTOP:
@@ -447,34 +647,38 @@ terminal_nautilus_menu_item_activate (NautilusMenuItem *item)
         break;
 
       [[fallthrough]];
-    case FILE_INFO_OTHER: {
-      GFile *file;
-
-      /* map back remote URI to local path */
-      file = g_file_new_for_uri (uri);
-      path = g_file_get_path (file);
-      g_object_unref (file);
+    case FILE_INFO_OTHER:
+      /* map back remote URI to local path; this may need to talk to
+       * gvfsd, so do it in a thread.
+       */
+      resolve_path = TRUE;
       break;
-    }
 
     default:
       terminal_assert_not_reached ();
   }
 
-  if (path == nullptr && (info != FILE_INFO_SFTP || !menu_item->remote_terminal)) {
-    g_free (uri);
-    return;
-  }
-
-  data = g_new (ExecData, 1);
-  data->nautilus = (TerminalNautilus*)g_object_ref (nautilus);
+  data = g_new0 (ExecData, 1);
+  g_weak_ref_init (&data->nautilus, nautilus);
+  data->cancellable = (GCancellable*)g_object_ref (nautilus->cancellable);
   data->timestamp = 0; // GDK_CURRENT_TIME
   data->path = path;
   data->uri = uri;
   data->info = info;
   data->remote = menu_item->remote_terminal;
 
-  create_terminal (data);
+  if (!resolve_path) {
+    create_terminal (nautilus, data);
+    return;
+  }
+
+  gs_unref_object auto task = g_task_new (nullptr,
+                                          data->cancellable,
+                                          (GAsyncReadyCallback) resolve_path_done_cb,
+                                          data);
+  g_task_set_source_tag (task, (void*)terminal_nautilus_menu_item_activate);
+  g_task_set_task_data (task, data, nullptr);
+  g_task_run_in_thread (task, resolve_path_thread);
 }
 
 G_DEFINE_DYNAMIC_TYPE (TerminalNautilusMenuItem, terminal_nautilus_menu_item, NAUTILUS_TYPE_MENU_ITEM)
@@ -621,7 +825,7 @@ terminal_nautilus_get_background_items (NautilusMenuProvider *provider,
   }
 
   if (terminal_file_info == FILE_INFO_DESKTOP ||
-      uri_has_local_path (uri)) {
+      uri_has_local_path (nautilus, terminal_file_info, uri)) {
     /* local locations and remote locations that offer local back-mapping */
     item = terminal_nautilus_menu_item_new (nautilus,
                                             file_info, 
@@ -647,6 +851,7 @@ terminal_nautilus_get_file_items (NautilusMenuProvider *provider,
   NautilusFileInfo *file_info;
   GFileType file_type;
   TerminalFileInfo terminal_file_info;
+  gboolean has_local_path;
 
   if (terminal_locked_down (nautilus))
     return nullptr;
@@ -674,8 +879,10 @@ terminal_nautilus_get_file_items (NautilusMenuProvider *provider,
     case FILE_INFO_LOCAL:
     case FILE_INFO_SFTP:
     case FILE_INFO_OTHER:
+      has_local_path = uri_has_local_path (nautilus, terminal_file_info, uri);
+
       if (terminal_file_info == FILE_INFO_SFTP || 
-          uri_has_local_path (uri)) {
+          has_local_path) {
         item = terminal_nautilus_menu_item_new (nautilus,
                                                 file_info,
                                                 terminal_file_info,
@@ -685,7 +892,7 @@ terminal_nautilus_get_file_items (NautilusMenuProvider *provider,
       }
 
       if (terminal_file_info == FILE_INFO_SFTP &&
-          uri_has_local_path (uri)) {
+          has_local_path) {
         item = terminal_nautilus_menu_item_new (nautilus,
                                                 file_info, 
                                                 terminal_file_info,
@@ -721,6 +928,23 @@ static void
 terminal_nautilus_init (TerminalNautilus *nautilus)
 {
   nautilus->lockdown_prefs = g_settings_new (GNOME_DESKTOP_LOCKDOWN_SETTINGS_SCHEMA);
+  g_signal_connect (nautilus->lockdown_prefs, "changed::disable-command-line",
+                    G_CALLBACK (terminal_nautilus_lockdown_changed_cb), nautilus);
+  terminal_nautilus_lockdown_changed_cb (nautilus->lockdown_prefs,
+                                         "disable-command-line",
+                                         nautilus);
+
+  nautilus->local_path_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                      g_free, nullptr);
+  nautilus->volume_monitor = g_volume_monitor_get ();
+  g_signal_connect (nautilus->volume_monitor, "mount-added",
+                    G_CALLBACK (terminal_nautilus_mounts_changed_cb), nautilus);
+  g_signal_connect (nautilus->volume_monitor, "mount-changed",
+                    G_CALLBACK (terminal_nautilus_mounts_changed_cb), nautilus);
+  g_signal_connect (nautilus->volume_monitor, "mount-removed",
+                    G_CALLBACK (terminal_nautilus_mounts_changed_cb), nautilus);
+
+  nautilus->cancellable = g_cancellable_new ();
 }
 
 static void
@@ -728,6 +952,19 @@ terminal_nautilus_dispose (GObject *object)
 {
   TerminalNautilus *nautilus = TERMINAL_NAUTILUS (object);
 
+  if (nautilus->cancellable != nullptr)
+    g_cancellable_cancel (nautilus->cancellable);
+  g_clear_object (&nautilus->cancellable);
+  g_clear_object (&nautilus->factory);
+
+  if (nautilus->volume_monitor != nullptr)
+    g_signal_handlers_disconnect_by_data (nautilus->volume_monitor, nautilus);
+  g_clear_object (&nautilus->volume_monitor);
+  g_clear_pointer (&nautilus->mount_roots, g_ptr_array_unref);
+  g_clear_pointer (&nautilus->local_path_cache, g_hash_table_unref);
+
+  if (nautilus->lockdown_prefs != nullptr)
+    g_signal_handlers_disconnect_by_data (nautilus->lockdown_prefs, nautilus);
   g_clear_object (&nautilus->lockdown_prefs);
 
   G_OBJECT_CLASS (terminal_nautilus_parent_class)->dispose (object);
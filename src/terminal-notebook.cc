@@ -450,6 +450,13 @@ terminal_notebook_page_added (AdwTabView       *tab_view,
   g_assert (TERMINAL_IS_NOTEBOOK (notebook));
 
   child = adw_tab_page_get_child (page);
+
+  /* Only the selected page gets a switch-page, so a page added (or moved
+   * here) in the background needs to be told here
+   */
+  terminal_tab_set_active (TERMINAL_TAB (child),
+                           page == adw_tab_view_get_selected_page (tab_view));
+
   g_signal_emit (notebook, signals[SCREEN_ADDED], 0,
                  terminal_tab_get_screen (TERMINAL_TAB (child)));
 }
@@ -687,20 +687,50 @@ option_load_config_cb (const gchar *option_name,
   TerminalOptions *options = (TerminalOptions*)data;
   GFile *file;
   char *config_file;
-  GKeyFile *key_file;
+  GMappedFile *mapped_file;
+  guint source_tag;
   gboolean result;
 
   file = g_file_new_for_commandline_arg (value);
   config_file = g_file_get_path (file);
   g_object_unref (file);
 
-  key_file = g_key_file_new ();
-  result = g_key_file_load_from_file (key_file, config_file, GKeyFileFlags(0), error) &&
-           terminal_options_merge_config (options, key_file,
-                                          strcmp (option_name, "load-config") == 0 ? SOURCE_DEFAULT : SOURCE_SESSION,
-                                          error);
-  g_key_file_free (key_file);
+  mapped_file = g_mapped_file_new (config_file, FALSE, error);
   g_free (config_file);
+  if (mapped_file == nullptr)
+    return FALSE;
+
+  gs_unref_bytes GBytes *bytes = g_mapped_file_get_bytes (mapped_file);
+  g_mapped_file_unref (mapped_file);
+
+  source_tag = strcmp (option_name, "load-config") == 0 ? SOURCE_DEFAULT : SOURCE_SESSION;
+
+  gsize size;
+  auto const contents = reinterpret_cast<const char*>(g_bytes_get_data (bytes, &size));
+
+  guint32 magic = 0;
+  if (size >= sizeof (magic))
+    memcpy (&magic, contents, sizeof (magic));
+
+  if (magic == TERMINAL_LAYOUT_MAGIC ||
+      magic == GUINT32_SWAP_LE_BE (TERMINAL_LAYOUT_MAGIC)) {
+    /* The mapping is page aligned, so this doesn't copy the data */
+    gs_unref_variant GVariant *layout =
+      g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (TERMINAL_LAYOUT_TYPE_STRING),
+                                                    bytes, FALSE));
+    if (magic != TERMINAL_LAYOUT_MAGIC) {
+      GVariant *swapped = g_variant_take_ref (g_variant_byteswap (layout));
+      g_variant_unref (layout);
+      layout = swapped;
+    }
+
+    return terminal_options_merge_layout (options, layout, source_tag, error);
+  }
+
+  gs_unref_key_file GKeyFile *key_file = g_key_file_new ();
+  result = g_key_file_load_from_data (key_file, contents ? contents : "", size,
+                                      GKeyFileFlags(0), error) &&
+           terminal_options_merge_config (options, key_file, source_tag, error);
 
   return result;
 }
@@ -984,6 +1014,7 @@ terminal_options_parse (int *argcp,
   options = g_new0 (TerminalOptions, 1);
 
   options->print_environment = FALSE;
+  options->benchmark_launch = FALSE;
   options->default_fullscreen = FALSE;
   options->default_maximize = FALSE;
   options->execute = FALSE;
@@ -1169,7 +1200,7 @@ terminal_options_merge_config (TerminalOptions *options,
         continue; /* no tabs in this window, skip it */
 
       iw = initial_window_new (source_tag);
-      initial_windows = g_list_append (initial_windows, iw);
+      initial_windows = g_list_prepend (initial_windows, iw);
       apply_window_defaults (options, iw);
 
       active_terminal = g_key_file_get_string (key_file, window_group, TERMINAL_CONFIG_WINDOW_PROP_ACTIVE_TAB, nullptr);
@@ -1187,7 +1218,7 @@ terminal_options_merge_config (TerminalOptions *options,
           profile = g_key_file_get_string (key_file, tab_group, TERMINAL_CONFIG_TERMINAL_PROP_PROFILE_ID, nullptr);
           it = initial_tab_new (profile /* adopts */);
 
-          iw->tabs = g_list_append (iw->tabs, it);
+          iw->tabs = g_list_prepend (iw->tabs, it);
 
           if (g_strcmp0 (active_terminal, tab_group) == 0)
             it->active = TRUE;
@@ -1205,6 +1236,8 @@ terminal_options_merge_config (TerminalOptions *options,
             }
         }
 
+      iw->tabs = g_list_reverse (iw->tabs);
+
       g_free (active_terminal);
       g_strfreev (tab_groups);
 
@@ -1220,11 +1253,180 @@ terminal_options_merge_config (TerminalOptions *options,
       return FALSE;
     }
 
-  options->initial_windows = g_list_concat (options->initial_windows, initial_windows);
+  options->initial_windows = g_list_concat (options->initial_windows,
+                                            g_list_reverse (initial_windows));
+
+  return TRUE;
+}
+
+/**
+ * terminal_options_merge_layout:
+ * @options:
+ * @layout: a #GVariant of type %TERMINAL_LAYOUT_TYPE_STRING in native byte order
+ * @source_tag: a source_tag to use in new #InitialWindow<!-- -->s
+ * @error: a #GError to fill in
+ *
+ * Merges the windows and tabs from @layout into @options, the same way
+ * terminal_options_merge_config() does for a key file.
+ *
+ * Returns: %TRUE if @layout was a valid terminal layout, or %FALSE on error
+ */
+gboolean
+terminal_options_merge_layout (TerminalOptions *options,
+                               GVariant *layout,
+                               guint source_tag,
+                               GError **error)
+{
+  guint32 magic, version, compat_version;
+  gs_unref_variant GVariant *windows = nullptr;
+  GList *initial_windows = nullptr;
+
+  g_variant_get (layout, "(uuu@a" TERMINAL_LAYOUT_WINDOW_TYPE_STRING ")",
+                 &magic, &version, &compat_version, &windows);
+
+  if (magic != TERMINAL_LAYOUT_MAGIC)
+    {
+      g_set_error_literal (error, TERMINAL_OPTION_ERROR,
+                           TERMINAL_OPTION_ERROR_INVALID_CONFIG_FILE,
+                           _("Not a valid terminal config file."));
+      return FALSE;
+    }
+
+  if (version == 0 ||
+      compat_version == 0 ||
+      compat_version > TERMINAL_CONFIG_COMPAT_VERSION)
+    {
+      g_set_error_literal (error, TERMINAL_OPTION_ERROR,
+                           TERMINAL_OPTION_ERROR_INCOMPATIBLE_CONFIG_FILE,
+                           _("Incompatible terminal config file version."));
+      return FALSE;
+    }
+
+  auto const n_windows = g_variant_n_children (windows);
+  for (gsize i = 0; i < n_windows; ++i)
+    {
+      const char *role, *geometry;
+      gboolean fullscreen, maximized;
+      gint32 active_tab;
+      gs_unref_variant GVariant *tabs = nullptr;
+
+      g_variant_get_child (windows, i, "(m&sm&sbbi@a" TERMINAL_LAYOUT_TAB_TYPE_STRING ")",
+                           &role, &geometry, &fullscreen, &maximized, &active_tab, &tabs);
+
+      auto const n_tabs = g_variant_n_children (tabs);
+      if (n_tabs == 0)
+        continue; /* no tabs in this window, skip it */
+
+      InitialWindow *iw = initial_window_new (source_tag);
+      initial_windows = g_list_prepend (initial_windows, iw);
+      apply_window_defaults (options, iw);
+
+      g_free (iw->role);
+      iw->role = g_strdup (role);
+      g_free (iw->geometry);
+      iw->geometry = g_strdup (geometry);
+      iw->start_fullscreen = fullscreen;
+      iw->start_maximized = maximized;
+
+      for (gsize j = 0; j < n_tabs; ++j)
+        {
+          const char *profile, *title, *working_dir;
+          gs_strfreev char **argv = nullptr;
+
+          g_variant_get_child (tabs, j, "(m&sm&sm&s^aay)",
+                               &profile, &title, &working_dir, &argv);
+
+          InitialTab *it = initial_tab_new (g_strdup (profile) /* adopts */);
+          iw->tabs = g_list_prepend (iw->tabs, it);
+
+          it->active = (active_tab >= 0 && gsize (active_tab) == j);
+          it->title = g_strdup (title);
+          it->working_dir = g_strdup (working_dir);
+          if (argv[0] != nullptr)
+            it->exec_argv = (char**)g_steal_pointer (&argv);
+        }
+
+      iw->tabs = g_list_reverse (iw->tabs);
+    }
+
+  options->initial_windows = g_list_concat (options->initial_windows,
+                                            g_list_reverse (initial_windows));
 
   return TRUE;
 }
 
+/**
+ * terminal_options_save_layout:
+ * @options:
+ * @filename: the file to write
+ * @error: a #GError to fill in
+ *
+ * Saves the windows and tabs of @options as a binary layout that
+ * --load-config can load. Like when launching them, this opens one window
+ * if @options has none, and tabs use the options' defaults (the command
+ * after "--", --title, --working-directory and --profile) for what they
+ * don't set themselves.
+ *
+ * Returns: %TRUE on success, or %FALSE on error
+ */
+gboolean
+terminal_options_save_layout (TerminalOptions *options,
+                              const char *filename,
+                              GError **error)
+{
+  GVariantBuilder windows_builder;
+  g_variant_builder_init (&windows_builder, G_VARIANT_TYPE ("a" TERMINAL_LAYOUT_WINDOW_TYPE_STRING));
+
+  ensure_top_window (options, FALSE);
+
+  for (GList *lw = options->initial_windows; lw != nullptr; lw = lw->next)
+    {
+      InitialWindow *iw = (InitialWindow*)lw->data;
+      GVariantBuilder tabs_builder;
+      gint32 active_tab = -1;
+      gint32 index = 0;
+
+      g_variant_builder_init (&tabs_builder, G_VARIANT_TYPE ("a" TERMINAL_LAYOUT_TAB_TYPE_STRING));
+
+      for (GList *lt = iw->tabs; lt != nullptr; lt = lt->next, ++index)
+        {
+          InitialTab *it = (InitialTab*)lt->data;
+
+          if (it->active)
+            active_tab = index;
+
+          char **argv = it->exec_argv ? it->exec_argv : options->exec_argv;
+
+          g_variant_builder_add (&tabs_builder, "(msmsms@aay)",
+                                 it->profile ? it->profile : options->default_profile,
+                                 it->title ? it->title : options->default_title,
+                                 it->working_dir ? it->working_dir : options->default_working_dir,
+                                 g_variant_new_bytestring_array ((const char * const *) argv,
+                                                                 argv ? -1 : 0));
+        }
+
+      g_variant_builder_add (&windows_builder, "(msmsbbi@a" TERMINAL_LAYOUT_TAB_TYPE_STRING ")",
+                             iw->role,
+                             iw->geometry,
+                             iw->start_fullscreen,
+                             iw->start_maximized,
+                             active_tab,
+                             g_variant_builder_end (&tabs_builder));
+    }
+
+  gs_unref_variant GVariant *layout =
+    g_variant_ref_sink (g_variant_new ("(uuu@a" TERMINAL_LAYOUT_WINDOW_TYPE_STRING ")",
+                                       guint32 (TERMINAL_LAYOUT_MAGIC),
+                                       guint32 (TERMINAL_CONFIG_VERSION),
+                                       guint32 (TERMINAL_CONFIG_COMPAT_VERSION),
+                                       g_variant_builder_end (&windows_builder)));
+
+  return g_file_set_contents (filename,
+                              (const char*)g_variant_get_data (layout),
+                              g_variant_get_size (layout),
+                              error);
+}
+
 /**
  * terminal_options_ensure_window:
  * @options:
@@ -1277,6 +1479,8 @@ terminal_options_free (TerminalOptions *options)
   g_free (options->sm_client_id);
   g_free (options->sm_config_prefix);
 
+  g_free (options->save_layout);
+
   g_clear_object (&options->profiles_list);
   g_clear_pointer (&options->schema_source, g_settings_schema_source_unref);
 
@@ -1322,6 +1526,15 @@ get_goption_context (TerminalOptions *options)
       (void*)unsupported_option_callback,
       nullptr, nullptr
     },
+    {
+      "save-layout",
+      0,
+      G_OPTION_FLAG_FILENAME,
+      G_OPTION_ARG_FILENAME,
+      &options->save_layout,
+      N_("Save the windows and tabs to a layout file for --load-config instead of opening them"),
+      N_("FILE")
+    },
     {
       "no-environment",
       0,
@@ -1349,6 +1562,15 @@ get_goption_context (TerminalOptions *options)
       N_("Print environment variables to interact with the terminal"),
       nullptr
     },
+    {
+      "benchmark-launch",
+      0,
+      0,
+      G_OPTION_ARG_NONE,
+      &options->benchmark_launch,
+      N_("Print the time taken by each phase of opening the terminals"),
+      nullptr
+    },
     {
       "version",
       0,
@@ -1676,3 +1898,74 @@ get_goption_context (TerminalOptions *options)
 
   return context;
 }
+
+#ifdef TERMINAL_OPTIONS_MAIN
+
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+/* Saves the layout for a command line with only defaults, the way
+ * "gnome-terminal --save-layout=FILE --title=... -- cmd" does, and checks
+ * that loading it gives a tab with those values.
+ */
+static void
+test_save_layout_defaults (void)
+{
+  gs_free_error GError *error = nullptr;
+  gs_free char *filename = nullptr;
+  int fd = g_file_open_tmp ("test-options-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  gs_free char *save_arg = g_strconcat ("--save-layout=", filename, nullptr);
+  const char *save_argv[] = {
+    "gnome-terminal", save_arg,
+    "--title=Build", "--working-directory=/tmp/build",
+    "--", "make", "-j8",
+    nullptr
+  };
+  int argc = G_N_ELEMENTS (save_argv) - 1;
+  gs_free char **argv = (char**) g_memdup2 (save_argv, sizeof (save_argv));
+  TerminalOptions *options = terminal_options_parse (&argc, &argv, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (options);
+
+  g_assert_true (terminal_options_save_layout (options, filename, &error));
+  g_assert_no_error (error);
+
+  gs_free char *load_arg = g_strconcat ("--load-config=", filename, nullptr);
+  const char *load_argv[] = { "gnome-terminal", load_arg, nullptr };
+  argc = G_N_ELEMENTS (load_argv) - 1;
+  gs_free char **argv2 = (char**) g_memdup2 (load_argv, sizeof (load_argv));
+  TerminalOptions *loaded = terminal_options_parse (&argc, &argv2, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (loaded);
+
+  g_assert_cmpuint (g_list_length (loaded->initial_windows), ==, 1);
+  auto const iw = (InitialWindow*) loaded->initial_windows->data;
+  g_assert_cmpuint (g_list_length (iw->tabs), ==, 1);
+  auto const it = (InitialTab*) iw->tabs->data;
+
+  const char *expected_argv[] = { "make", "-j8", nullptr };
+  g_assert_nonnull (it->exec_argv);
+  g_assert_true (g_strv_equal ((const char * const *) it->exec_argv, expected_argv));
+  g_assert_cmpstr (it->title, ==, "Build");
+  g_assert_cmpstr (it->working_dir, ==, "/tmp/build");
+
+  terminal_options_free (loaded);
+  terminal_options_free (options);
+  g_unlink (filename);
+}
+
+int
+main (int argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, nullptr);
+
+  g_test_add_func ("/terminal/options/save-layout/defaults", test_save_layout_defaults);
+
+  return g_test_run ();
+}
+
+#endif /* TERMINAL_OPTIONS_MAIN */
@@ -55,6 +55,19 @@ G_BEGIN_DECLS
 #define TERMINAL_CONFIG_TERMINAL_PROP_WORKING_DIRECTORY  "WorkingDirectory"
 #define TERMINAL_CONFIG_TERMINAL_PROP_ZOOM               "Zoom"
 
+/* The binary layout is a GVariant in native byte order, so it can be used
+ * straight from a mapped file. It starts with the magic, which also tells
+ * the byte order. Versions are as for the key file.
+ *
+ * A window is (role, geometry, fullscreen, maximized, index of the active
+ * tab or -1, tabs), and a tab is (profile ID, title, working directory,
+ * command).
+ */
+#define TERMINAL_LAYOUT_MAGIC               (0x594c5447u) /* "GTLY" in little endian */
+#define TERMINAL_LAYOUT_TAB_TYPE_STRING     "(msmsmsaay)"
+#define TERMINAL_LAYOUT_WINDOW_TYPE_STRING  "(msmsbbia" TERMINAL_LAYOUT_TAB_TYPE_STRING ")"
+#define TERMINAL_LAYOUT_TYPE_STRING         "(uuua" TERMINAL_LAYOUT_WINDOW_TYPE_STRING ")"
+
 enum
 {
   SOURCE_DEFAULT = 0,
@@ -67,6 +80,7 @@ typedef struct
   TerminalSettingsList *profiles_list; /* may be nullptr */
 
   gboolean print_environment;
+  gboolean benchmark_launch;
 
   char    *server_unique_name;
   char    *parent_screen_object_path;
@@ -95,6 +109,8 @@ typedef struct
   char *sm_client_id;
   char *sm_config_prefix;
 
+  char *save_layout;
+
   guint zoom_set : 1;
   guint wait : 1;
 } TerminalOptions;
@@ -147,6 +163,15 @@ gboolean terminal_options_merge_config (TerminalOptions *options,
                                         guint source_tag,
                                         GError **error);
 
+gboolean terminal_options_merge_layout (TerminalOptions *options,
+                                        GVariant *layout,
+                                        guint source_tag,
+                                        GError **error);
+
+gboolean terminal_options_save_layout (TerminalOptions *options,
+                                       const char *filename,
+                                       GError **error);
+
 void terminal_options_ensure_window (TerminalOptions *options);
 
 const char *terminal_options_get_service_name (TerminalOptions *options);
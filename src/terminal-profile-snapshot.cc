@@ -0,0 +1,255 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "terminal-profile-snapshot.hh"
+#include "terminal-debug.hh"
+#include "terminal-libgsystem.hh"
+#include "terminal-schemas.hh"
+#include "terminal-util.hh"
+
+/* The snapshot of one profile, attached to its GSettings */
+typedef struct {
+  TerminalProfileSnapshot *current; /* nullptr if out of date */
+  guint64 generation;
+} SnapshotCache;
+
+static GQuark
+snapshot_cache_quark (void)
+{
+  static GQuark quark = g_quark_from_static_string ("terminal-profile-snapshot");
+
+  return quark;
+}
+
+static void
+snapshot_cache_free (SnapshotCache *cache)
+{
+  g_clear_pointer (&cache->current, terminal_profile_snapshot_unref);
+  g_free (cache);
+}
+
+/* Runs before the profile's "changed" signals are emitted, so that the
+ * screens handling those see the new values; a change to several keys at
+ * once is a single change-event.
+ */
+static gboolean
+profile_change_event_cb (GSettings *profile,
+                         GQuark *keys,
+                         int n_keys,
+                         SnapshotCache *cache)
+{
+  g_clear_pointer (&cache->current, terminal_profile_snapshot_unref);
+  cache->generation++;
+
+  return FALSE;
+}
+
+static TerminalProfileSnapshot *
+terminal_profile_snapshot_new (GSettings *profile,
+                               guint64 generation)
+{
+  TerminalProfileSnapshot *snapshot = g_new0 (TerminalProfileSnapshot, 1);
+
+  snapshot->ref_count = 1;
+  snapshot->generation = generation;
+
+  snapshot->encoding = g_settings_get_string (profile, TERMINAL_PROFILE_ENCODING_KEY);
+  snapshot->cjk_ambiguous_width = g_settings_get_enum (profile, TERMINAL_PROFILE_CJK_UTF8_AMBIGUOUS_WIDTH_KEY);
+
+  snapshot->use_system_font = g_settings_get_boolean (profile, TERMINAL_PROFILE_USE_SYSTEM_FONT_KEY);
+  if (!snapshot->use_system_font)
+    {
+      gs_free char *font = g_settings_get_string (profile, TERMINAL_PROFILE_FONT_KEY);
+      snapshot->font = pango_font_description_from_string (font);
+    }
+  snapshot->cell_width_scale = g_settings_get_double (profile, TERMINAL_PROFILE_CELL_WIDTH_SCALE_KEY);
+  snapshot->cell_height_scale = g_settings_get_double (profile, TERMINAL_PROFILE_CELL_HEIGHT_SCALE_KEY);
+
+  snapshot->palette = terminal_g_settings_get_rgba_palette (profile, TERMINAL_PROFILE_PALETTE_KEY,
+                                                            &snapshot->n_palette);
+
+  snapshot->use_theme_colors = g_settings_get_boolean (profile, TERMINAL_PROFILE_USE_THEME_COLORS_KEY);
+  if (!terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_FOREGROUND_COLOR_KEY, &snapshot->fg) ||
+      !terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_BACKGROUND_COLOR_KEY, &snapshot->bg))
+    snapshot->use_theme_colors = TRUE;
+
+  if (!snapshot->use_theme_colors)
+    {
+      snapshot->bold_set =
+        !g_settings_get_boolean (profile, TERMINAL_PROFILE_BOLD_COLOR_SAME_AS_FG_KEY) &&
+        terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_BOLD_COLOR_KEY, &snapshot->bold);
+
+      if (g_settings_get_boolean (profile, TERMINAL_PROFILE_CURSOR_COLORS_SET_KEY))
+        {
+          snapshot->cursor_bg_set =
+            terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_CURSOR_BACKGROUND_COLOR_KEY, &snapshot->cursor_bg) != nullptr;
+          snapshot->cursor_fg_set =
+            terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_CURSOR_FOREGROUND_COLOR_KEY, &snapshot->cursor_fg) != nullptr;
+        }
+
+      if (g_settings_get_boolean (profile, TERMINAL_PROFILE_HIGHLIGHT_COLORS_SET_KEY))
+        {
+          snapshot->highlight_bg_set =
+            terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_HIGHLIGHT_BACKGROUND_COLOR_KEY, &snapshot->highlight_bg) != nullptr;
+          snapshot->highlight_fg_set =
+            terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_HIGHLIGHT_FOREGROUND_COLOR_KEY, &snapshot->highlight_fg) != nullptr;
+        }
+    }
+
+  snapshot->scrollbar_policy = TerminalScrollbarPolicy(g_settings_get_enum (profile, TERMINAL_PROFILE_SCROLLBAR_POLICY_KEY));
+  snapshot->kinetic_scrolling = g_settings_get_boolean (profile, TERMINAL_PROFILE_KINETIC_SCROLLING_KEY);
+  snapshot->audible_bell = g_settings_get_boolean (profile, TERMINAL_PROFILE_AUDIBLE_BELL_KEY);
+  snapshot->scroll_on_insert = g_settings_get_boolean (profile, TERMINAL_PROFILE_SCROLL_ON_INSERT_KEY);
+  snapshot->scroll_on_keystroke = g_settings_get_boolean (profile, TERMINAL_PROFILE_SCROLL_ON_KEYSTROKE_KEY);
+  snapshot->scroll_on_output = g_settings_get_boolean (profile, TERMINAL_PROFILE_SCROLL_ON_OUTPUT_KEY);
+  snapshot->scrollback_lines = g_settings_get_boolean (profile, TERMINAL_PROFILE_SCROLLBACK_UNLIMITED_KEY) ?
+    -1 : g_settings_get_int (profile, TERMINAL_PROFILE_SCROLLBACK_LINES_KEY);
+  snapshot->backspace_binding = VteEraseBinding(g_settings_get_enum (profile, TERMINAL_PROFILE_BACKSPACE_BINDING_KEY));
+  snapshot->delete_binding = VteEraseBinding(g_settings_get_enum (profile, TERMINAL_PROFILE_DELETE_BINDING_KEY));
+  snapshot->enable_bidi = g_settings_get_boolean (profile, TERMINAL_PROFILE_ENABLE_BIDI_KEY);
+  snapshot->enable_shaping = g_settings_get_boolean (profile, TERMINAL_PROFILE_ENABLE_SHAPING_KEY);
+  snapshot->enable_sixel = g_settings_get_boolean (profile, TERMINAL_PROFILE_ENABLE_SIXEL_KEY);
+  snapshot->bold_is_bright = g_settings_get_boolean (profile, TERMINAL_PROFILE_BOLD_IS_BRIGHT_KEY);
+  snapshot->cursor_blink_mode = VteCursorBlinkMode(g_settings_get_enum (profile, TERMINAL_PROFILE_CURSOR_BLINK_MODE_KEY));
+  snapshot->cursor_shape = VteCursorShape(g_settings_get_enum (profile, TERMINAL_PROFILE_CURSOR_SHAPE_KEY));
+  snapshot->rewrap_on_resize = g_settings_get_boolean (profile, TERMINAL_PROFILE_REWRAP_ON_RESIZE_KEY);
+  snapshot->text_blink_mode = VteTextBlinkMode(g_settings_get_enum (profile, TERMINAL_PROFILE_TEXT_BLINK_MODE_KEY));
+  g_settings_get (profile, TERMINAL_PROFILE_WORD_CHAR_EXCEPTIONS_KEY, "ms", &snapshot->word_char_exceptions);
+
+  return snapshot;
+}
+
+/**
+ * terminal_profile_snapshot_get:
+ * @profile: a profile #GSettings
+ *
+ * Returns: (transfer full): the snapshot of the current values of @profile
+ */
+TerminalProfileSnapshot *
+terminal_profile_snapshot_get (GSettings *profile)
+{
+  SnapshotCache *cache;
+
+  g_return_val_if_fail (G_IS_SETTINGS (profile), nullptr);
+
+  cache = (SnapshotCache *) g_object_get_qdata (G_OBJECT (profile), snapshot_cache_quark ());
+  if (cache == nullptr)
+    {
+      cache = g_new0 (SnapshotCache, 1);
+      g_object_set_qdata_full (G_OBJECT (profile), snapshot_cache_quark (),
+                               cache, (GDestroyNotify) snapshot_cache_free);
+      g_signal_connect (profile, "change-event",
+                        G_CALLBACK (profile_change_event_cb), cache);
+    }
+
+  if (cache->current == nullptr)
+    {
+      cache->current = terminal_profile_snapshot_new (profile, cache->generation);
+
+      _terminal_debug_print (TERMINAL_DEBUG_PROFILE,
+                             "Built snapshot of profile %p generation %" G_GUINT64_FORMAT "\n",
+                             profile, cache->generation);
+    }
+
+  return terminal_profile_snapshot_ref (cache->current);
+}
+
+TerminalProfileSnapshot *
+terminal_profile_snapshot_ref (TerminalProfileSnapshot *snapshot)
+{
+  snapshot->ref_count++;
+  return snapshot;
+}
+
+void
+terminal_profile_snapshot_unref (TerminalProfileSnapshot *snapshot)
+{
+  if (--snapshot->ref_count > 0)
+    return;
+
+  g_free (snapshot->encoding);
+  if (snapshot->font != nullptr)
+    pango_font_description_free (snapshot->font);
+  g_free (snapshot->palette);
+  g_free (snapshot->word_char_exceptions);
+  g_free (snapshot);
+}
+
+static gboolean
+optional_rgba_equal (gboolean a_set,
+                     const GdkRGBA *a,
+                     gboolean b_set,
+                     const GdkRGBA *b)
+{
+  if (a_set != b_set)
+    return FALSE;
+
+  return !a_set || gdk_rgba_equal (a, b);
+}
+
+/**
+ * terminal_profile_snapshot_colors_equal:
+ * @a:
+ * @b:
+ *
+ * Returns: whether @a and @b have the same colors
+ */
+gboolean
+terminal_profile_snapshot_colors_equal (const TerminalProfileSnapshot *a,
+                                        const TerminalProfileSnapshot *b)
+{
+  if (a->use_theme_colors != b->use_theme_colors)
+    return FALSE;
+  if (!a->use_theme_colors &&
+      (!gdk_rgba_equal (&a->fg, &b->fg) || !gdk_rgba_equal (&a->bg, &b->bg)))
+    return FALSE;
+
+  if (a->n_palette != b->n_palette)
+    return FALSE;
+  for (gsize i = 0; i < a->n_palette; i++)
+    {
+      if (!gdk_rgba_equal (&a->palette[i], &b->palette[i]))
+        return FALSE;
+    }
+
+  return optional_rgba_equal (a->bold_set, &a->bold, b->bold_set, &b->bold) &&
+         optional_rgba_equal (a->cursor_bg_set, &a->cursor_bg, b->cursor_bg_set, &b->cursor_bg) &&
+         optional_rgba_equal (a->cursor_fg_set, &a->cursor_fg, b->cursor_fg_set, &b->cursor_fg) &&
+         optional_rgba_equal (a->highlight_bg_set, &a->highlight_bg, b->highlight_bg_set, &b->highlight_bg) &&
+         optional_rgba_equal (a->highlight_fg_set, &a->highlight_fg, b->highlight_fg_set, &b->highlight_fg);
+}
+
+/**
+ * terminal_profile_snapshot_font_equal:
+ * @a:
+ * @b:
+ *
+ * Returns: whether @a and @b have the same font and cell size
+ */
+gboolean
+terminal_profile_snapshot_font_equal (const TerminalProfileSnapshot *a,
+                                      const TerminalProfileSnapshot *b)
+{
+  if (a->use_system_font != b->use_system_font ||
+      a->cell_width_scale != b->cell_width_scale ||
+      a->cell_height_scale != b->cell_height_scale)
+    return FALSE;
+
+  return a->use_system_font || pango_font_description_equal (a->font, b->font);
+}
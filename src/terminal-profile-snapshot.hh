@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+#include <gtk/gtk.h>
+#include <vte/vte.h>
+
+#include "terminal-enums.hh"
+
+G_BEGIN_DECLS
+
+/*
+ * TerminalProfileSnapshot:
+ *
+ * The parsed values of the profile keys that a #TerminalScreen applies.
+ * A snapshot is immutable and shared by all screens using the profile; it
+ * is rebuilt once after each burst of changes to the profile, with a
+ * higher @generation.
+ */
+typedef struct {
+  int ref_count;
+  guint64 generation;
+
+  char *encoding;
+  int cjk_ambiguous_width;
+
+  gboolean use_system_font;
+  PangoFontDescription *font; /* nullptr if use_system_font */
+  double cell_width_scale;
+  double cell_height_scale;
+
+  /* fg and bg are only valid if !use_theme_colors */
+  gboolean use_theme_colors;
+  GdkRGBA fg;
+  GdkRGBA bg;
+  GdkRGBA *palette;
+  gsize n_palette;
+  /* The optional colors are only set if they are to be used */
+  gboolean bold_set;
+  GdkRGBA bold;
+  gboolean cursor_bg_set;
+  GdkRGBA cursor_bg;
+  gboolean cursor_fg_set;
+  GdkRGBA cursor_fg;
+  gboolean highlight_bg_set;
+  GdkRGBA highlight_bg;
+  gboolean highlight_fg_set;
+  GdkRGBA highlight_fg;
+
+  TerminalScrollbarPolicy scrollbar_policy;
+  gboolean kinetic_scrolling;
+  gboolean audible_bell;
+  gboolean scroll_on_insert;
+  gboolean scroll_on_keystroke;
+  gboolean scroll_on_output;
+  glong scrollback_lines;
+  VteEraseBinding backspace_binding;
+  VteEraseBinding delete_binding;
+  gboolean enable_bidi;
+  gboolean enable_shaping;
+  gboolean enable_sixel;
+  gboolean bold_is_bright;
+  VteCursorBlinkMode cursor_blink_mode;
+  VteCursorShape cursor_shape;
+  gboolean rewrap_on_resize;
+  VteTextBlinkMode text_blink_mode;
+  char *word_char_exceptions;
+} TerminalProfileSnapshot;
+
+TerminalProfileSnapshot *terminal_profile_snapshot_get (GSettings *profile);
+
+TerminalProfileSnapshot *terminal_profile_snapshot_ref (TerminalProfileSnapshot *snapshot);
+
+void terminal_profile_snapshot_unref (TerminalProfileSnapshot *snapshot);
+
+gboolean terminal_profile_snapshot_colors_equal (const TerminalProfileSnapshot *a,
+                                                 const TerminalProfileSnapshot *b);
+
+gboolean terminal_profile_snapshot_font_equal (const TerminalProfileSnapshot *a,
+                                               const TerminalProfileSnapshot *b);
+
+G_END_DECLS
@@ -19,8 +19,11 @@
 
 #include <glib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "terminal-regex.hh"
+#include "terminal-url-classifier.hh"
+#include "terminal-url-prefilter.hh"
 
 #ifdef TERMINAL_REGEX_MAIN
 
@@ -43,6 +46,24 @@ get_match (const char *pattern, const char *string, GRegexMatchFlags match_flags
   return match;
 }
 
+static char*
+get_match_named (const char *pattern, const char *string, const char *group_name)
+{
+  GRegex *regex;
+  GMatchInfo *match_info;
+  gchar *match;
+
+  regex = g_regex_new (pattern, GRegexCompileFlags(0), GRegexMatchFlags(0), nullptr);
+  g_regex_match (regex, string, GRegexMatchFlags(0), &match_info);
+  match = g_match_info_fetch_named (match_info, group_name);
+  if (match != nullptr && match[0] == '\0')
+    g_clear_pointer (&match, g_free);
+
+  g_free (regex);
+  g_free (match_info);
+  return match;
+}
+
 /* Macros rather than functions to report useful line numbers on failure. */
 #define assert_match(__pattern, __string, __expected) do { \
   gchar *__actual_match = get_match(__pattern, __string, GRegexMatchFlags(0)); \
@@ -60,6 +81,82 @@ get_match (const char *pattern, const char *string, GRegexMatchFlags match_flags
   g_free (__actual_match); \
 } while (0)
 
+#define assert_match_group(__pattern, __string, __group, __expected) do { \
+  gchar *__actual_match = get_match_named(__pattern, __string, __group); \
+  const gchar *__expected_match = __expected; \
+  if (__expected_match == ENTIRE) __expected_match = __string; \
+  g_assert_cmpstr(__actual_match, ==, __expected_match); \
+  g_free (__actual_match); \
+} while (0)
+
+/* Finds the match of REGEX_URL_COMBINED covering @offset the way VTE
+ * finds the match under the pointer, and classifies it the way
+ * TerminalScreen does */
+static TerminalUrlKind
+get_url_kind_at (const char *string, int offset, char **match)
+{
+  GRegex *regex = g_regex_new (REGEX_URL_COMBINED, GRegexCompileFlags(0), GRegexMatchFlags(0), nullptr);
+  GMatchInfo *match_info;
+
+  *match = nullptr;
+
+  g_regex_match (regex, string, GRegexMatchFlags(0), &match_info);
+  while (g_match_info_matches (match_info)) {
+    int start, end;
+    g_match_info_fetch_pos (match_info, 0, &start, &end);
+    if (start <= offset && offset < end) {
+      *match = g_match_info_fetch (match_info, 0);
+      break;
+    }
+    g_match_info_next (match_info, nullptr);
+  }
+
+  g_match_info_free (match_info);
+  g_regex_unref (regex);
+
+  return *match ? terminal_url_classify (*match) : TERMINAL_URL_KIND_NONE;
+}
+
+#define assert_url_kind_at(__string, __offset, __kind, __expected) do { \
+  gchar *__actual_match; \
+  TerminalUrlKind __actual_kind = get_url_kind_at (__string, __offset, &__actual_match); \
+  const gchar *__expected_match = __expected; \
+  if (__expected_match == ENTIRE) __expected_match = __string; \
+  g_assert_cmpint (__actual_kind, ==, __kind); \
+  g_assert_cmpstr (__actual_match, ==, __expected_match); \
+  g_free (__actual_match); \
+} while (0)
+
+/* Checks that the prefilter doesn't rule out any match of the URL regexes */
+static void
+check_prefilter (const char *string)
+{
+  const TerminalUrlPrefilter *prefilter = terminal_url_prefilter_get_default ();
+  const gsize len = strlen (string);
+  gssize candidate = terminal_url_prefilter_next_candidate (prefilter, string, len, 0);
+  gchar *match = get_match (REGEX_URL_COMBINED, string, GRegexMatchFlags(0));
+
+  if (match != nullptr) {
+    const gsize start = strstr (string, match) - string;
+    g_assert_cmpint (candidate, >=, 0);
+    g_assert_cmpint (candidate, <=, start);
+    g_assert_true (terminal_url_prefilter_may_match (prefilter, string, len));
+  }
+
+  g_free (match);
+}
+
+#define assert_prefilter(__string, __expected) do { \
+  const TerminalUrlPrefilter *__prefilter = terminal_url_prefilter_get_default (); \
+  g_assert_cmpint (terminal_url_prefilter_may_match (__prefilter, __string, strlen (__string)), ==, __expected); \
+  check_prefilter (__string); \
+} while (0)
+
+#define assert_candidate(__string, __offset, __expected) do { \
+  const TerminalUrlPrefilter *__prefilter = terminal_url_prefilter_get_default (); \
+  g_assert_cmpint (terminal_url_prefilter_next_candidate (__prefilter, __string, strlen (__string), __offset), ==, __expected); \
+} while (0)
+
 int
 main (int argc, char **argv)
 {
@@ -384,8 +481,644 @@ main (int argc, char **argv)
                                  "1234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890"
                                  "1234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890", ENTIRE);
 
+  /* The combined regex matches what the individual ones do, and the named
+   * group tells which one it was */
+  assert_match (REGEX_URL_COMBINED, "See http://example.com/foo.", "http://example.com/foo");
+  assert_match (REGEX_URL_COMBINED, "See www.foo.bar/baz.",        "www.foo.bar/baz");
+  assert_match (REGEX_URL_COMBINED, "See file:///lost+found.",     "file:///lost+found");
+  assert_match (REGEX_URL_COMBINED, "Dial sip:alice@192.0.2.4.",   "sip:alice@192.0.2.4");
+  assert_match (REGEX_URL_COMBINED, "Write to foo@bar.com.",       "foo@bar.com");
+  assert_match (REGEX_URL_COMBINED, "See man:ls(1)",               "man:ls(1)");
+  assert_match (REGEX_URL_COMBINED, "abc.www.foo.bar/baz",         nullptr);
+  assert_match (REGEX_URL_COMBINED, "No URL here, 1.2.3.4 either", nullptr);
+  assert_match (REGEX_URL_COMBINED, "<a href='https://en.wikipedia.org/wiki/Aerosmith'>", "https://en.wikipedia.org/wiki/Aerosmith");
+
+  assert_match_group (REGEX_URL_COMBINED, "http://example.com/foo", REGEX_URL_GROUP_AS_IS,    ENTIRE);
+  assert_match_group (REGEX_URL_COMBINED, "http://example.com/foo", REGEX_URL_GROUP_HTTP,     nullptr);
+  assert_match_group (REGEX_URL_COMBINED, "www.foo.bar/baz",        REGEX_URL_GROUP_HTTP,     ENTIRE);
+  assert_match_group (REGEX_URL_COMBINED, "file:///etc/passwd",     REGEX_URL_GROUP_FILE,     ENTIRE);
+  assert_match_group (REGEX_URL_COMBINED, "sip:alice@atlanta.com",  REGEX_URL_GROUP_VOIP,     ENTIRE);
+  assert_match_group (REGEX_URL_COMBINED, "mailto:foo@bar.com",     REGEX_URL_GROUP_EMAIL,    ENTIRE);
+  assert_match_group (REGEX_URL_COMBINED, "foo@bar.com",            REGEX_URL_GROUP_AS_IS,    nullptr);
+  assert_match_group (REGEX_URL_COMBINED, "news:comp.lang.c",       REGEX_URL_GROUP_NEWS_MAN, ENTIRE);
+
+  /* The kind of the URL under the pointer is the alternative of the
+   * combined regex that matched. Host-only URLs need http:// added. */
+  assert_url_kind_at ("www.example.com",          0, TERMINAL_URL_KIND_HTTP,     ENTIRE);
+  assert_url_kind_at ("See www.example.com.",     6, TERMINAL_URL_KIND_HTTP,     "www.example.com");
+  assert_url_kind_at ("http://example.com/foo",   3, TERMINAL_URL_KIND_AS_IS,    ENTIRE);
+  assert_url_kind_at ("See file:///lost+found.",  6, TERMINAL_URL_KIND_FILE,     "file:///lost+found");
+  assert_url_kind_at ("Dial sip:alice@192.0.2.4", 9, TERMINAL_URL_KIND_VOIP,     "sip:alice@192.0.2.4");
+  assert_url_kind_at ("foo@bar.com",              0, TERMINAL_URL_KIND_EMAIL,    ENTIRE);
+  assert_url_kind_at ("See man:ls(1)",            5, TERMINAL_URL_KIND_NEWS_MAN, "man:ls(1)");
+  assert_url_kind_at ("No URL here",              3, TERMINAL_URL_KIND_NONE,     nullptr);
+  /* Where URLs overlap, the leftmost match wins, whichever alternative
+   * it comes from */
+  assert_url_kind_at ("mailto:foo@www.example.com", 12, TERMINAL_URL_KIND_EMAIL, ENTIRE);
+  assert_url_kind_at ("http://user@example.com",     8, TERMINAL_URL_KIND_AS_IS, ENTIRE);
+  /* The match classifies the same without the text around it */
+  assert_url_kind_at ("'http://foo/bar'",            3, TERMINAL_URL_KIND_AS_IS, "http://foo/bar");
+  g_assert_cmpint (terminal_url_classify ("not a URL"), ==, TERMINAL_URL_KIND_NONE);
+
+  /* The prefilter finds the literals every URL contains, case insensitively */
+  assert_prefilter ("", FALSE);
+  assert_prefilter ("[12/345] Compiling C++ object src/terminal-screen.cc.o", FALSE);
+  assert_prefilter ("drwxr-xr-x  2 user user  4096 Sep 12 10:00 subprojects", FALSE);
+  assert_prefilter ("No URL here, 1.2.3.4 either", FALSE);
+  assert_prefilter ("http://example.com/foo", TRUE);
+  assert_prefilter ("See HTTPS://EXAMPLE.COM.", TRUE);
+  assert_prefilter ("See www.foo.bar/baz.", TRUE);
+  assert_prefilter ("See WWW.FOO.BAR/baz.", TRUE);
+  assert_prefilter ("ftp.example.com", TRUE);
+  assert_prefilter ("file:///etc/passwd", TRUE);
+  assert_prefilter ("FILE:/etc/passwd", TRUE);
+  assert_prefilter ("Dial sip:alice@192.0.2.4.", TRUE);
+  assert_prefilter ("sips:alice@atlanta.com", TRUE);
+  assert_prefilter ("H323:caller@example.com", TRUE);
+  assert_prefilter ("Write to foo@bar.com.", TRUE);
+  assert_prefilter ("mailto:foo@bar.com", TRUE);
+  assert_prefilter ("See man:ls(1)", TRUE);
+  assert_prefilter ("news:comp.lang.c", TRUE);
+  assert_prefilter ("INFO:gnome-terminal", TRUE);
+  assert_prefilter ("<a href='https://en.wikipedia.org/wiki/Aerosmith'>", TRUE);
+  assert_prefilter ("abc.www.foo.bar/baz", TRUE);
+  assert_prefilter ("ww", FALSE);
+  assert_prefilter ("fil:", FALSE);
+
+  /* The candidate is the start of the word containing the literal, but not before the offset */
+  assert_candidate ("no url here", 0, -1);
+  assert_candidate ("see http://example.com", 0, 4);
+  assert_candidate ("see http://example.com", 6, 6);
+  assert_candidate ("mail foo@bar.com now", 0, 5);
+  assert_candidate ("x://a y://b", 2, 6);
+  assert_candidate ("x://a y://b", 4, 6);
+
   printf("terminal-regex tests passed :)\n");
   return 0;
 }
 
 #endif /* TERMINAL_REGEX_MAIN */
+
+#ifdef TERMINAL_REGEX_BENCH_MAIN
+
+#include <time.h>
+
+#include "terminal-pcre2.hh"
+
+typedef struct {
+  const char *name;
+  const char *pattern;
+  gboolean separate;
+  gboolean prefiltered;
+} BenchPattern;
+
+/* The URL regexes in the order the terminal used to add them to each screen,
+ * followed by the combined one that it uses now, without and with running
+ * the prefilter first */
+static const BenchPattern bench_patterns[] = {
+  { "AS_IS",     REGEX_URL_AS_IS,    TRUE,  FALSE },
+  { "HTTP",      REGEX_URL_HTTP,     TRUE,  FALSE },
+  { "FILE",      REGEX_URL_FILE,     TRUE,  FALSE },
+  { "VOIP",      REGEX_URL_VOIP,     TRUE,  FALSE },
+  { "EMAIL",     REGEX_EMAIL,        TRUE,  FALSE },
+  { "NEWS_MAN",  REGEX_NEWS_MAN,     TRUE,  FALSE },
+  { "COMBINED",  REGEX_URL_COMBINED, FALSE, FALSE },
+  { "PREFILTER", REGEX_URL_COMBINED, FALSE, TRUE },
+};
+
+typedef struct {
+  const char *name;
+  guint32 match_options;
+} BenchMode;
+
+static const BenchMode bench_modes[] = {
+  { "complete", 0 },
+  { "partial",  PCRE2_PARTIAL_SOFT },
+};
+
+typedef struct {
+  char *name;
+  GPtrArray *lines;
+  gsize n_bytes;
+} Corpus;
+
+typedef struct {
+  const char *pattern;
+  const char *mode;
+  const char *corpus;
+  guint line;
+  gsize length;
+  double ns_per_byte;
+  double factor;
+} Outlier;
+
+static gint64
+now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return gint64(ts.tv_sec) * G_GINT64_CONSTANT (1000000000) + ts.tv_nsec;
+}
+
+/* Compiles @pattern the same way precompile_regexes() in terminal-screen.cc does */
+static pcre2_code_8*
+compile_regex (const char *pattern)
+{
+  int errcode;
+  PCRE2_SIZE erroffset;
+  pcre2_code_8 *code = pcre2_compile_8 ((PCRE2_SPTR8) pattern,
+                                        PCRE2_ZERO_TERMINATED,
+                                        PCRE2_UTF | PCRE2_NO_UTF_CHECK | PCRE2_UCP | PCRE2_MULTILINE,
+                                        &errcode, &erroffset,
+                                        nullptr);
+  g_assert_nonnull (code);
+
+  if (pcre2_jit_compile_8 (code, PCRE2_JIT_COMPLETE) != 0 ||
+      pcre2_jit_compile_8 (code, PCRE2_JIT_PARTIAL_SOFT) != 0)
+    g_printerr ("Failed to JIT regex\n");
+
+  return code;
+}
+
+static Corpus*
+corpus_new (const char *name)
+{
+  Corpus *corpus = g_new0 (Corpus, 1);
+  corpus->name = g_strdup (name);
+  corpus->lines = g_ptr_array_new_with_free_func (g_free);
+  return corpus;
+}
+
+static void
+corpus_add_line (Corpus *corpus,
+                 char *line /* adopted */)
+{
+  corpus->n_bytes += strlen (line);
+  g_ptr_array_add (corpus->lines, line);
+}
+
+static void
+corpus_free (Corpus *corpus)
+{
+  g_free (corpus->name);
+  g_ptr_array_unref (corpus->lines);
+  g_free (corpus);
+}
+
+static const char *
+random_choice (GRand *rand,
+               const char *const *strings,
+               guint n_strings)
+{
+  return strings[g_rand_int_range (rand, 0, n_strings)];
+}
+
+static char *
+random_string (GRand *rand,
+               const char *alphabet,
+               guint length)
+{
+  const guint n = strlen (alphabet);
+  char *str = (char*) g_malloc (length + 1);
+  for (guint i = 0; i < length; ++i)
+    str[i] = alphabet[g_rand_int_range (rand, 0, n)];
+  str[length] = '\0';
+  return str;
+}
+
+#define LOWER_ALNUM "abcdefghijklmnopqrstuvwxyz0123456789"
+#define BASE64 "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+
+static const char *const words[] = {
+  "terminal", "screen", "window", "profile", "vte", "regex", "search",
+  "provider", "settings", "app", "util", "client", "options", "notebook",
+};
+
+/* Compiler and build system output, with the occasional diagnostics URL */
+static Corpus*
+make_compiler_log_corpus (GRand *rand,
+                          guint n_lines)
+{
+  Corpus *corpus = corpus_new ("compiler-log");
+  for (guint i = 0; i < n_lines; ++i) {
+    const char *a = random_choice (rand, words, G_N_ELEMENTS (words));
+    const char *b = random_choice (rand, words, G_N_ELEMENTS (words));
+    const guint line = g_rand_int_range (rand, 1, 5000);
+    const guint col = g_rand_int_range (rand, 1, 80);
+
+    switch (g_rand_int_range (rand, 0, 5)) {
+    case 0:
+      corpus_add_line (corpus, g_strdup_printf ("[%u/%u] Compiling C++ object src/gnome-terminal-server.p/%s-%s.cc.o",
+                                                i, n_lines, a, b));
+      break;
+    case 1:
+      corpus_add_line (corpus, g_strdup_printf ("../src/%s-%s.cc:%u:%u: warning: unused variable '%s' [-Wunused-variable]",
+                                                a, b, line, col, b));
+      break;
+    case 2:
+      corpus_add_line (corpus, g_strdup_printf ("../src/%s-%s.cc:%u:%u: error: no matching function for call to '%s_%s_new(GObject*&, int)'",
+                                                a, b, line, col, a, b));
+      break;
+    case 3:
+      corpus_add_line (corpus, g_strdup_printf ("../src/%s.hh:%u:%u: note: see https://gcc.gnu.org/onlinedocs/gcc/Warning-Options.html#index-W%s",
+                                                a, line, col, b));
+      break;
+    default:
+      corpus_add_line (corpus, g_strdup_printf ("c++ -Isrc/gnome-terminal-server.p -Isrc -I../src -I/usr/include/glib-2.0 -O2 -g -MD -MQ src/%s.cc.o -MF src/%s.cc.o.d -o src/%s.cc.o -c ../src/%s.cc",
+                                                a, a, a, a));
+      break;
+    }
+  }
+
+  return corpus;
+}
+
+/* ls -l output, including versioned file names that look like IP addresses
+ * and host names */
+static Corpus*
+make_ls_corpus (GRand *rand,
+                guint n_lines)
+{
+  static const char *const modes[] = {
+    "drwxr-xr-x", "-rw-r--r--", "-rwxr-xr-x", "lrwxrwxrwx",
+  };
+
+  Corpus *corpus = corpus_new ("ls-l");
+  for (guint i = 0; i < n_lines; ++i) {
+    const char *word = random_choice (rand, words, G_N_ELEMENTS (words));
+    char *name;
+
+    switch (g_rand_int_range (rand, 0, 3)) {
+    case 0:
+      name = g_strdup_printf ("lib%s-2.91.so.0.%u.%u", word,
+                              g_rand_int_range (rand, 0, 8000), g_rand_int_range (rand, 0, 10));
+      break;
+    case 1:
+      name = g_strdup_printf ("%s.%s.%u.tar.xz", word, word, g_rand_int_range (rand, 0, 100));
+      break;
+    default:
+      name = g_strdup_printf ("%s-%u", word, i);
+      break;
+    }
+
+    corpus_add_line (corpus, g_strdup_printf ("%s  %u user user %8u Sep %2u %02u:%02u %s",
+                                              random_choice (rand, modes, G_N_ELEMENTS (modes)),
+                                              g_rand_int_range (rand, 1, 20),
+                                              g_rand_int_range (rand, 0, 1 << 24),
+                                              g_rand_int_range (rand, 1, 31),
+                                              g_rand_int_range (rand, 0, 24),
+                                              g_rand_int_range (rand, 0, 60),
+                                              name));
+    g_free (name);
+  }
+
+  return corpus;
+}
+
+/* One JSON object per line, with URLs and email addresses in some values */
+static Corpus*
+make_json_corpus (GRand *rand,
+                  guint n_lines)
+{
+  Corpus *corpus = corpus_new ("json");
+  for (guint i = 0; i < n_lines; ++i) {
+    const char *word = random_choice (rand, words, G_N_ELEMENTS (words));
+    char *id = random_string (rand, LOWER_ALNUM, 16);
+
+    corpus_add_line (corpus, g_strdup_printf ("{\"id\": \"%s\", \"index\": %u, \"name\": \"%s\", "
+                                              "\"author\": \"%s@example.org\", \"homepage\": \"https://gitlab.gnome.org/GNOME/%s\", "
+                                              "\"path\": \"/usr/share/%s/%s.json\", \"tags\": [\"%s\", \"%s\"], \"score\": %u.%u}",
+                                              id, i, word, word, word, word, id, word, id,
+                                              g_rand_int_range (rand, 0, 100), g_rand_int_range (rand, 0, 1000)));
+    g_free (id);
+  }
+
+  return corpus;
+}
+
+/* Long lines of base64, as from a dumped certificate or an inline image */
+static Corpus*
+make_base64_corpus (GRand *rand,
+                    guint n_lines)
+{
+  Corpus *corpus = corpus_new ("base64");
+  for (guint i = 0; i < n_lines; ++i)
+    corpus_add_line (corpus, random_string (rand, BASE64, 4096));
+
+  return corpus;
+}
+
+/* Long single tokens that exercise the recursive PATH and IP subroutines */
+static Corpus*
+make_long_tokens_corpus (GRand *rand,
+                         guint n_lines)
+{
+  Corpus *corpus = corpus_new ("long-tokens");
+  for (guint i = 0; i < n_lines; ++i) {
+    GString *str = g_string_new (nullptr);
+    const guint n_parts = g_rand_int_range (rand, 100, 400);
+
+    switch (i % 5) {
+    case 0: /* a deeply nested path after a URL */
+      g_string_append (str, "http://example.com");
+      for (guint j = 0; j < n_parts; ++j)
+        g_string_append_printf (str, "/%s", random_choice (rand, words, G_N_ELEMENTS (words)));
+      break;
+    case 1: /* unbalanced parentheses and brackets in a path */
+      g_string_append (str, "https://en.wikipedia.org/wiki/");
+      for (guint j = 0; j < n_parts; ++j)
+        g_string_append (str, j % 3 ? "(a" : "[b");
+      break;
+    case 2: /* a long dotted numeric string, like an IPv4 address */
+      g_string_append (str, "ftp.");
+      for (guint j = 0; j < n_parts; ++j)
+        g_string_append_printf (str, "%u.", g_rand_int_range (rand, 0, 256));
+      break;
+    case 3: /* a long colon-separated hex string, like an IPv6 address */
+      g_string_append (str, "http://[");
+      for (guint j = 0; j < n_parts; ++j)
+        g_string_append_printf (str, "%x:", g_rand_int_range (rand, 0, 0x10000));
+      break;
+    default: /* a long host name without a scheme */
+      g_string_append (str, "www");
+      for (guint j = 0; j < n_parts; ++j)
+        g_string_append_printf (str, ".%s", random_choice (rand, words, G_N_ELEMENTS (words)));
+      break;
+    }
+
+    corpus_add_line (corpus, g_string_free (str, FALSE));
+  }
+
+  return corpus;
+}
+
+static Corpus*
+load_corpus (const char *filename,
+             GError **error)
+{
+  char *contents;
+  if (!g_file_get_contents (filename, &contents, nullptr, error))
+    return nullptr;
+
+  char *basename = g_path_get_basename (filename);
+  Corpus *corpus = corpus_new (basename);
+  g_free (basename);
+
+  char **lines = g_strsplit (contents, "\n", -1);
+  for (guint i = 0; lines[i] != nullptr; ++i) {
+    if (lines[i][0] != '\0' && g_utf8_validate (lines[i], -1, nullptr))
+      corpus_add_line (corpus, g_strdup (lines[i]));
+  }
+
+  g_strfreev (lines);
+  g_free (contents);
+
+  return corpus;
+}
+
+/* Finds all matches of @code in @line, like a hover at the end of the line
+ * does. If @prefilter is not %nullptr, only runs @code from where it says a
+ * match may start. Returns the number of matches, or a negative PCRE2 error
+ * code if the match failed other than by not matching, e.g. by hitting the
+ * match limit. */
+static int
+count_matches (pcre2_code_8 *code,
+               pcre2_match_data_8 *match_data,
+               guint32 match_options,
+               const TerminalUrlPrefilter *prefilter,
+               const char *line,
+               PCRE2_SIZE len)
+{
+  PCRE2_SIZE offset = 0;
+  int n_matches = 0;
+
+  while (offset < len) {
+    if (prefilter != nullptr) {
+      gssize candidate = terminal_url_prefilter_next_candidate (prefilter, line, len, offset);
+      if (candidate < 0)
+        break;
+      offset = candidate;
+    }
+
+    int r = pcre2_match_8 (code, (PCRE2_SPTR8) line, len, offset,
+                           PCRE2_NO_UTF_CHECK | PCRE2_NOTEMPTY | match_options,
+                           match_data, nullptr);
+    if (r == PCRE2_ERROR_NOMATCH || r == PCRE2_ERROR_PARTIAL)
+      break;
+    if (r < 0)
+      return r;
+
+    PCRE2_SIZE *ovector = pcre2_get_ovector_pointer_8 (match_data);
+    ++n_matches;
+    offset = ovector[1] > offset ? ovector[1] : offset + 1;
+  }
+
+  return n_matches;
+}
+
+/*
+ * bench_pattern:
+ * @line_ns: (out caller-allocates): the time spent on each line of @corpus, in ns
+ *
+ * Returns: the total time spent on @corpus, in ns
+ */
+static double
+bench_pattern (pcre2_code_8 *code,
+               pcre2_match_data_8 *match_data,
+               guint32 match_options,
+               const TerminalUrlPrefilter *prefilter,
+               Corpus *corpus,
+               guint iterations,
+               double *line_ns,
+               guint *n_matches,
+               guint *n_errors)
+{
+  double total_ns = 0.;
+
+  *n_matches = *n_errors = 0;
+  for (guint i = 0; i < corpus->lines->len; ++i) {
+    const char *line = (const char*) g_ptr_array_index (corpus->lines, i);
+    const PCRE2_SIZE len = strlen (line);
+    int r = 0;
+
+    gint64 start_time = now_ns ();
+    for (guint iteration = 0; iteration < iterations; ++iteration)
+      r = count_matches (code, match_data, match_options, prefilter, line, len);
+    gint64 end_time = now_ns ();
+
+    if (r < 0)
+      ++*n_errors;
+    else
+      *n_matches += r;
+
+    line_ns[i] = double(end_time - start_time) / iterations;
+    total_ns += line_ns[i];
+  }
+
+  return total_ns;
+}
+
+/* Records the lines of @corpus on which @pattern is much slower per byte
+ * than on the corpus as a whole */
+static void
+find_outliers (GArray *outliers,
+               const char *pattern,
+               const char *mode,
+               Corpus *corpus,
+               const double *line_ns,
+               double ns_per_byte,
+               double outlier_factor)
+{
+  for (guint i = 0; i < corpus->lines->len; ++i) {
+    /* Don't report lines that are too fast to time reliably */
+    if (line_ns[i] < 10000.)
+      continue;
+
+    const gsize length = strlen ((const char*) g_ptr_array_index (corpus->lines, i));
+    const double line_ns_per_byte = line_ns[i] / MAX (length, 1);
+    if (line_ns_per_byte < ns_per_byte * outlier_factor)
+      continue;
+
+    Outlier outlier = { pattern, mode, corpus->name, i + 1, length,
+                        line_ns_per_byte, line_ns_per_byte / ns_per_byte };
+    g_array_append_val (outliers, outlier);
+  }
+}
+
+static int
+compare_outliers (gconstpointer a,
+                  gconstpointer b)
+{
+  const double fa = ((const Outlier*) a)->factor;
+  const double fb = ((const Outlier*) b)->factor;
+  return fa < fb ? 1 : fa > fb ? -1 : 0;
+}
+
+int
+main (int argc, char **argv)
+{
+  int n_lines = 1000;
+  int iterations = 2;
+  double outlier_factor = 20.;
+  int max_outliers = 20;
+  char **corpus_files = nullptr;
+  const GOptionEntry entries[] = {
+    { "lines", 'l', 0, G_OPTION_ARG_INT, &n_lines, "Number of lines in each generated corpus", "N" },
+    { "iterations", 'i', 0, G_OPTION_ARG_INT, &iterations, "Number of iterations", "N" },
+    { "corpus", 'c', 0, G_OPTION_ARG_FILENAME_ARRAY, &corpus_files, "Also benchmark the lines of FILE", "FILE" },
+    { "outlier-factor", 'f', 0, G_OPTION_ARG_DOUBLE, &outlier_factor, "Report lines at least FACTOR times slower per byte than their corpus", "FACTOR" },
+    { "max-outliers", 'm', 0, G_OPTION_ARG_INT, &max_outliers, "Report at most N outliers", "N" },
+    { nullptr, 0, 0, G_OPTION_ARG_NONE, nullptr, nullptr, nullptr }
+  };
+
+  GOptionContext *context = g_option_context_new (nullptr);
+  g_option_context_add_main_entries (context, entries, nullptr);
+  GError *error = nullptr;
+  if (!g_option_context_parse (context, &argc, &argv, &error)) {
+    g_printerr ("%s\n", error->message);
+    g_error_free (error);
+    g_option_context_free (context);
+    return 1;
+  }
+  g_option_context_free (context);
+
+  if (n_lines < 1 || iterations < 1 || outlier_factor <= 1. || max_outliers < 0) {
+    g_printerr ("Invalid arguments\n");
+    return 1;
+  }
+
+  GRand *rand = g_rand_new_with_seed (42);
+  GPtrArray *corpora = g_ptr_array_new_with_free_func ((GDestroyNotify) corpus_free);
+  g_ptr_array_add (corpora, make_compiler_log_corpus (rand, n_lines));
+  g_ptr_array_add (corpora, make_ls_corpus (rand, n_lines));
+  g_ptr_array_add (corpora, make_json_corpus (rand, n_lines));
+  g_ptr_array_add (corpora, make_base64_corpus (rand, n_lines));
+  g_ptr_array_add (corpora, make_long_tokens_corpus (rand, n_lines));
+  g_rand_free (rand);
+
+  for (guint i = 0; corpus_files != nullptr && corpus_files[i] != nullptr; ++i) {
+    Corpus *corpus = load_corpus (corpus_files[i], &error);
+    if (corpus == nullptr) {
+      g_printerr ("Failed to load corpus \"%s\": %s\n", corpus_files[i], error->message);
+      g_clear_error (&error);
+      continue;
+    }
+    g_ptr_array_add (corpora, corpus);
+  }
+  g_strfreev (corpus_files);
+
+  pcre2_code_8 *codes[G_N_ELEMENTS (bench_patterns)];
+  for (guint i = 0; i < G_N_ELEMENTS (bench_patterns); ++i)
+    codes[i] = compile_regex (bench_patterns[i].pattern);
+
+  pcre2_match_data_8 *match_data = pcre2_match_data_create_8 (256, nullptr);
+  GArray *outliers = g_array_new (FALSE, FALSE, sizeof (Outlier));
+
+  printf ("%u iterations, outlier factor %.1f\n", iterations, outlier_factor);
+  printf ("errors are lines on which matching failed, e.g. by exceeding the match limit\n");
+
+  for (guint c = 0; c < corpora->len; ++c) {
+    Corpus *corpus = (Corpus*) g_ptr_array_index (corpora, c);
+    if (corpus->n_bytes == 0)
+      continue;
+
+    double *line_ns = g_new (double, corpus->lines->len);
+    double separate_ns_per_byte[G_N_ELEMENTS (bench_modes)] = { 0., };
+
+    printf ("\ncorpus \"%s\": %u lines, %" G_GSIZE_FORMAT " bytes\n",
+            corpus->name, corpus->lines->len, corpus->n_bytes);
+    printf ("  %-10s", "pattern");
+    for (guint m = 0; m < G_N_ELEMENTS (bench_modes); ++m)
+      printf (" %10s ns/byte", bench_modes[m].name);
+    printf (" %10s %8s\n", "matches", "errors");
+
+    for (guint p = 0; p < G_N_ELEMENTS (bench_patterns); ++p) {
+      guint n_matches = 0, n_errors = 0;
+
+      printf ("  %-10s", bench_patterns[p].name);
+      for (guint m = 0; m < G_N_ELEMENTS (bench_modes); ++m) {
+        double ns = bench_pattern (codes[p], match_data, bench_modes[m].match_options,
+                                   bench_patterns[p].prefiltered ? terminal_url_prefilter_get_default () : nullptr,
+                                   corpus, iterations, line_ns,
+                                   &n_matches, &n_errors);
+        double ns_per_byte = ns / corpus->n_bytes;
+        if (bench_patterns[p].separate)
+          separate_ns_per_byte[m] += ns_per_byte;
+
+        find_outliers (outliers, bench_patterns[p].name, bench_modes[m].name,
+                       corpus, line_ns, ns_per_byte, outlier_factor);
+
+        printf (" %18.3f", ns_per_byte);
+      }
+      /* Matches and errors are those of the last mode */
+      printf (" %10u %8u\n", n_matches, n_errors);
+    }
+
+    printf ("  %-10s", "(separate)");
+    for (guint m = 0; m < G_N_ELEMENTS (bench_modes); ++m)
+      printf (" %18.3f", separate_ns_per_byte[m]);
+    printf ("\n");
+
+    g_free (line_ns);
+  }
+
+  g_array_sort (outliers, compare_outliers);
+
+  printf ("\n%u outliers\n", outliers->len);
+  for (guint i = 0; i < outliers->len && i < guint(max_outliers); ++i) {
+    const Outlier *outlier = &g_array_index (outliers, Outlier, i);
+    printf ("  %-9s %-8s %s:%u (%" G_GSIZE_FORMAT " bytes): %.1f ns/byte, %.0fx\n",
+            outlier->pattern, outlier->mode, outlier->corpus, outlier->line,
+            outlier->length, outlier->ns_per_byte, outlier->factor);
+  }
+
+  g_array_unref (outliers);
+  pcre2_match_data_free_8 (match_data);
+  for (guint i = 0; i < G_N_ELEMENTS (codes); ++i)
+    pcre2_code_free_8 (codes[i]);
+  g_ptr_array_unref (corpora);
+
+  return 0;
+}
+
+#endif /* TERMINAL_REGEX_BENCH_MAIN */
@@ -146,13 +146,43 @@
 
 #define DEFS APOS_START_DEF IP_DEF PATH_INNER_DEF PATH_DEF
 
-#define REGEX_URL_AS_IS  DEFS SCHEME "://" USERPASS URL_HOST PORT URLPATH
+/* The bodies of the URL regexes below, without the DEFS they depend on */
+#define URL_AS_IS  SCHEME "://" USERPASS URL_HOST PORT URLPATH
 /* TODO: also support file:/etc/passwd */
-#define REGEX_URL_FILE   DEFS "(?ix: file:/ (?: / (?: " HOSTNAME1 " )? / )? (?! / ) )(?&PATH)"
+#define URL_FILE   "(?ix: file:/ (?: / (?: " HOSTNAME1 " )? / )? (?! / ) )(?&PATH)"
 /* Lookbehind so that we don't catch "abc.www.foo.bar", bug 739757. Lookahead for www/ftp for convenience (so that we can reuse HOSTNAME1). */
-#define REGEX_URL_HTTP   DEFS "(?<!(?:" HOSTNAMESEGMENTCHARS_CLASS "|[.]))(?=(?i:www|ftp))" HOSTNAME1 PORT URLPATH
-#define REGEX_URL_VOIP   DEFS "(?i:h323:|sips?:)" USERPASS URL_HOST PORT VOIP_PATH
-#define REGEX_EMAIL      DEFS "(?i:mailto:)?" USER "@" EMAIL_HOST
-#define REGEX_NEWS_MAN   "(?i:news:|man:|info:)[-[:alnum:]\\Q^_{|}~!\"#$%&'()*+,./;:=?`\\E]+"
+#define URL_HTTP   "(?<!(?:" HOSTNAMESEGMENTCHARS_CLASS "|[.]))(?=(?i:www|ftp))" HOSTNAME1 PORT URLPATH
+#define URL_VOIP   "(?i:h323:|sips?:)" USERPASS URL_HOST PORT VOIP_PATH
+#define URL_EMAIL  "(?i:mailto:)?" USER "@" EMAIL_HOST
+#define URL_NEWS_MAN "(?i:news:|man:|info:)[-[:alnum:]\\Q^_{|}~!\"#$%&'()*+,./;:=?`\\E]+"
+
+#define REGEX_URL_AS_IS  DEFS URL_AS_IS
+#define REGEX_URL_FILE   DEFS URL_FILE
+#define REGEX_URL_HTTP   DEFS URL_HTTP
+#define REGEX_URL_VOIP   DEFS URL_VOIP
+#define REGEX_EMAIL      DEFS URL_EMAIL
+#define REGEX_NEWS_MAN   URL_NEWS_MAN
+
+/* Names of the capture groups in REGEX_URL_COMBINED, one per alternative */
+#define REGEX_URL_GROUP_AS_IS    "URL_AS_IS"
+#define REGEX_URL_GROUP_HTTP     "URL_HTTP"
+#define REGEX_URL_GROUP_FILE     "URL_FILE"
+#define REGEX_URL_GROUP_VOIP     "URL_VOIP"
+#define REGEX_URL_GROUP_EMAIL    "URL_EMAIL"
+#define REGEX_URL_GROUP_NEWS_MAN "URL_NEWS_MAN"
+
+/* All of the URL regexes above as one alternation, sharing a single copy of
+ * the DEFS. Which alternative matched can be told from the named group that
+ * captured, see terminal_url_classify(). Note that this finds the leftmost match of any alternative, so
+ * where URLs overlap it may pick a different one than checking the separate
+ * regexes in turn does. */
+#define REGEX_URL_COMBINED DEFS "(?:" \
+  "(?<" REGEX_URL_GROUP_AS_IS ">"    URL_AS_IS    ")|" \
+  "(?<" REGEX_URL_GROUP_HTTP ">"     URL_HTTP     ")|" \
+  "(?<" REGEX_URL_GROUP_FILE ">"     URL_FILE     ")|" \
+  "(?<" REGEX_URL_GROUP_VOIP ">"     URL_VOIP     ")|" \
+  "(?<" REGEX_URL_GROUP_EMAIL ">"    URL_EMAIL    ")|" \
+  "(?<" REGEX_URL_GROUP_NEWS_MAN ">" URL_NEWS_MAN ")" \
+  ")"
 
 #endif /* !TERMINAL_REGEX_H */
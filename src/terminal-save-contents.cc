@@ -0,0 +1,480 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "terminal-save-contents.hh"
+#include "terminal-debug.hh"
+#include "terminal-libgsystem.hh"
+
+#include <string.h>
+
+/* The terminal can only be read from on the main thread, so the rows are
+ * read in chunks from an idle, sized so that reading one takes about this
+ * long. Compressing and writing them happens on a worker thread, while
+ * the next chunk is read.
+ */
+#define CHUNK_TARGET_USEC (4000)
+#define CHUNK_MIN_ROWS (64)
+#define CHUNK_MAX_ROWS (16384)
+
+typedef struct {
+  VteTerminal *terminal; /* weak */
+  GFile *file;
+  gboolean created; /* whether @file did not exist before */
+  GError *error; /* to return once @file is deleted again */
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GCancellable *caller_cancellable;
+  gulong caller_cancelled_id;
+  TerminalSaveContentsFlags flags;
+  GFileProgressCallback progress_callback;
+  gpointer progress_data;
+
+  glong start_row;
+  glong next_row;
+  glong end_row;
+  glong last_column;
+  glong chunk_rows;
+  gboolean read_done;
+  guint read_source;
+
+  char *writing; /* the chunk being written */
+  gsize writing_len;
+  char *ready; /* the chunk read next */
+  gsize ready_len;
+
+  gint64 start_time;
+  guint64 n_bytes;
+} SaveData;
+
+static void
+save_data_free (SaveData *data)
+{
+  if (data->terminal != nullptr)
+    g_object_remove_weak_pointer (G_OBJECT (data->terminal),
+                                  (gpointer*) &data->terminal);
+  if (data->caller_cancellable != nullptr)
+    g_cancellable_disconnect (data->caller_cancellable, data->caller_cancelled_id);
+  g_clear_object (&data->caller_cancellable);
+  g_clear_object (&data->cancellable);
+  g_clear_object (&data->stream);
+  g_clear_object (&data->file);
+  g_clear_error (&data->error);
+  g_free (data->writing);
+  g_free (data->ready);
+  g_free (data);
+}
+
+static void
+get_row_range (VteTerminal *terminal,
+               glong *first_row,
+               glong *end_row)
+{
+  auto const adjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (terminal));
+
+  /* The adjustment may be in pixels, see terminal_screen_init() */
+  auto unit = 1.;
+  if (vte_terminal_get_scroll_unit_is_pixels (terminal))
+    unit = MAX (vte_terminal_get_char_height (terminal), 1);
+
+  *first_row = glong (gtk_adjustment_get_lower (adjustment) / unit);
+  *end_row = glong (gtk_adjustment_get_upper (adjustment) / unit);
+}
+
+static void
+save_contents_delete_cb (GObject *source,
+                         GAsyncResult *result,
+                         gpointer user_data)
+{
+  gs_unref_object auto task = G_TASK (user_data);
+  auto const data = reinterpret_cast<SaveData*>(g_task_get_task_data (task));
+
+  g_file_delete_finish (G_FILE (source), result, nullptr); /* ignore errors */
+
+  g_task_return_error (task, g_steal_pointer (&data->error));
+}
+
+static void
+save_contents_return_error (GTask *task,
+                            GError *error /* adopted */)
+{
+  auto const data = reinterpret_cast<SaveData*>(g_task_get_task_data (task));
+
+  g_clear_handle_id (&data->read_source, g_source_remove);
+
+  /* Close the stream with a cancelled cancellable. When replacing an
+   * existing file, this keeps the partial contents from replacing it.
+   */
+  if (data->stream != nullptr && !g_output_stream_is_closed (data->stream)) {
+    gs_unref_object GCancellable *cancelled = g_cancellable_new ();
+    g_cancellable_cancel (cancelled);
+    g_output_stream_close (data->stream, cancelled, nullptr);
+  }
+
+  /* A new file was written to directly, so remove what was written */
+  if (data->created) {
+    data->error = error;
+    g_file_delete_async (data->file,
+                         G_PRIORITY_LOW,
+                         nullptr /* cancellable */,
+                         save_contents_delete_cb,
+                         g_object_ref (task));
+    return;
+  }
+
+  g_task_return_error (task, error);
+}
+
+static void
+save_contents_read_chunk (SaveData *data)
+{
+  auto const terminal = data->terminal;
+
+  /* Rows may have been dropped off the scrollback since */
+  glong first_row, end_row;
+  get_row_range (terminal, &first_row, &end_row);
+  data->next_row = MAX (data->next_row, first_row);
+
+  if (data->next_row >= data->end_row) {
+    data->read_done = TRUE;
+    return;
+  }
+
+  auto const last_row = MIN (data->next_row + data->chunk_rows, data->end_row) - 1;
+
+  auto const start = g_get_monotonic_time ();
+  data->ready = vte_terminal_get_text_range (terminal,
+                                             data->next_row, 0,
+                                             last_row, data->last_column,
+                                             nullptr, nullptr, nullptr);
+  data->ready_len = data->ready ? strlen (data->ready) : 0;
+  auto const elapsed = g_get_monotonic_time () - start;
+
+  if (elapsed < CHUNK_TARGET_USEC / 2)
+    data->chunk_rows = MIN (data->chunk_rows * 2, CHUNK_MAX_ROWS);
+  else if (elapsed > CHUNK_TARGET_USEC)
+    data->chunk_rows = MAX (data->chunk_rows / 2, CHUNK_MIN_ROWS);
+
+  data->next_row = last_row + 1;
+
+  if (data->progress_callback != nullptr)
+    data->progress_callback (data->next_row - data->start_row,
+                             data->end_row - data->start_row,
+                             data->progress_data);
+}
+
+static void save_contents_schedule_read (GTask *task);
+
+static void
+save_contents_close_cb (GObject *source,
+                        GAsyncResult *result,
+                        gpointer user_data)
+{
+  gs_unref_object auto task = G_TASK (user_data);
+  auto const data = reinterpret_cast<SaveData*>(g_task_get_task_data (task));
+  GError *error = nullptr;
+
+  if (!g_output_stream_close_finish (G_OUTPUT_STREAM (source), result, &error)) {
+    save_contents_return_error (task, error);
+    return;
+  }
+
+  _terminal_debug_print (TERMINAL_DEBUG_LATENCY,
+                         "Saved %ld rows, %" G_GUINT64_FORMAT " bytes in %" G_GINT64_FORMAT "us\n",
+                         data->end_row - data->start_row,
+                         data->n_bytes,
+                         g_get_monotonic_time () - data->start_time);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+save_contents_write_cb (GObject *source,
+                        GAsyncResult *result,
+                        gpointer user_data);
+
+static void
+save_contents_write_next (GTask *task)
+{
+  auto const data = reinterpret_cast<SaveData*>(g_task_get_task_data (task));
+
+  g_clear_pointer (&data->writing, g_free);
+
+  if (data->ready == nullptr) {
+    if (data->read_done)
+      g_output_stream_close_async (data->stream,
+                                   G_PRIORITY_LOW,
+                                   data->cancellable,
+                                   save_contents_close_cb,
+                                   g_object_ref (task));
+    else
+      save_contents_schedule_read (task);
+    return;
+  }
+
+  data->writing = data->ready;
+  data->writing_len = data->ready_len;
+  data->ready = nullptr;
+  data->ready_len = 0;
+  data->n_bytes += data->writing_len;
+
+  g_output_stream_write_all_async (data->stream,
+                                   data->writing,
+                                   data->writing_len,
+                                   G_PRIORITY_LOW,
+                                   data->cancellable,
+                                   save_contents_write_cb,
+                                   g_object_ref (task));
+
+  /* Read the next chunk while this one is written */
+  save_contents_schedule_read (task);
+}
+
+static void
+save_contents_write_cb (GObject *source,
+                        GAsyncResult *result,
+                        gpointer user_data)
+{
+  gs_unref_object auto task = G_TASK (user_data);
+  auto const data = reinterpret_cast<SaveData*>(g_task_get_task_data (task));
+  GError *error = nullptr;
+
+  if (!g_output_stream_write_all_finish (G_OUTPUT_STREAM (source), result, nullptr, &error) ||
+      g_cancellable_set_error_if_cancelled (data->cancellable, &error)) {
+    g_clear_pointer (&data->writing, g_free);
+    save_contents_return_error (task, error);
+    return;
+  }
+
+  save_contents_write_next (task);
+}
+
+static gboolean
+save_contents_read_cb (gpointer user_data)
+{
+  auto const task = G_TASK (user_data);
+  auto const data = reinterpret_cast<SaveData*>(g_task_get_task_data (task));
+
+  data->read_source = 0;
+
+  /* Stop when the terminal goes away */
+  if (data->terminal == nullptr)
+    g_cancellable_cancel (data->cancellable);
+
+  if (g_cancellable_is_cancelled (data->cancellable)) {
+    /* Otherwise the pending write fails with the cancellation */
+    if (data->writing == nullptr) {
+      GError *error = nullptr;
+      g_cancellable_set_error_if_cancelled (data->cancellable, &error);
+      save_contents_return_error (task, error);
+    }
+    return G_SOURCE_REMOVE;
+  }
+
+  if (data->ready == nullptr && !data->read_done)
+    save_contents_read_chunk (data);
+
+  if (data->writing == nullptr)
+    save_contents_write_next (task);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+save_contents_schedule_read (GTask *task)
+{
+  auto const data = reinterpret_cast<SaveData*>(g_task_get_task_data (task));
+
+  if (data->read_source != 0 || data->read_done)
+    return;
+
+  /* Low priority, so that input and drawing come first */
+  data->read_source = g_idle_add_full (G_PRIORITY_LOW,
+                                       save_contents_read_cb,
+                                       g_object_ref (task),
+                                       g_object_unref);
+}
+
+static void
+save_contents_start (GTask *task,
+                     GFileOutputStream *file_stream /* adopted */)
+{
+  auto const data = reinterpret_cast<SaveData*>(g_task_get_task_data (task));
+
+  if (data->flags & TERMINAL_SAVE_CONTENTS_FLAG_COMPRESS) {
+    gs_unref_object auto compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+    data->stream = g_converter_output_stream_new (G_OUTPUT_STREAM (file_stream),
+                                                  G_CONVERTER (compressor));
+    g_object_unref (file_stream);
+  } else {
+    data->stream = G_OUTPUT_STREAM (file_stream);
+  }
+
+  save_contents_schedule_read (task);
+}
+
+static void
+save_contents_replace_cb (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+  gs_unref_object auto task = G_TASK (user_data);
+  GError *error = nullptr;
+
+  auto const file_stream = g_file_replace_finish (G_FILE (source), result, &error);
+  if (file_stream == nullptr) {
+    g_task_return_error (task, error);
+    return;
+  }
+
+  save_contents_start (task, file_stream);
+}
+
+static void
+save_contents_create_cb (GObject *source,
+                         GAsyncResult *result,
+                         gpointer user_data)
+{
+  gs_unref_object auto task = G_TASK (user_data);
+  auto const data = reinterpret_cast<SaveData*>(g_task_get_task_data (task));
+  GError *error = nullptr;
+
+  auto const file_stream = g_file_create_finish (G_FILE (source), result, &error);
+  if (file_stream != nullptr) {
+    data->created = TRUE;
+    save_contents_start (task, file_stream);
+    return;
+  }
+
+  if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_EXISTS)) {
+    g_task_return_error (task, error);
+    return;
+  }
+
+  /* Replacing writes to a temporary file first, so that the existing
+   * file stays as it is until the save has completed.
+   */
+  g_clear_error (&error);
+  g_file_replace_async (data->file,
+                        nullptr /* etag */,
+                        FALSE /* backup */,
+                        G_FILE_CREATE_NONE,
+                        G_PRIORITY_LOW,
+                        data->cancellable,
+                        save_contents_replace_cb,
+                        g_steal_pointer (&task));
+}
+
+static void
+save_contents_caller_cancelled_cb (GCancellable *cancellable,
+                                   GCancellable *own_cancellable)
+{
+  g_cancellable_cancel (own_cancellable);
+}
+
+/**
+ * terminal_save_contents_async:
+ * @terminal: a #VteTerminal
+ * @file: the file to save to
+ * @flags: flags from #TerminalSaveContentsFlags
+ * @cancellable: (nullable): a #GCancellable
+ * @progress_callback: (nullable): called with the number of rows saved
+ *   so far, and the number of rows to save in total
+ * @progress_data: data for @progress_callback
+ * @callback: called when done
+ * @user_data: data for @callback
+ *
+ * Saves the text contents of @terminal, including its scrollback, to @file,
+ * gzip compressed if @flags contains %TERMINAL_SAVE_CONTENTS_FLAG_COMPRESS.
+ *
+ * Unlike vte_terminal_write_contents_sync() this does not block the main
+ * loop, even for a very long scrollback. If @terminal is destroyed before
+ * all of it is saved, the operation fails as cancelled.
+ *
+ * If the operation fails or is cancelled, an existing @file is left
+ * unchanged, and a @file that did not exist is deleted again.
+ */
+void
+terminal_save_contents_async (VteTerminal *terminal,
+                              GFile *file,
+                              TerminalSaveContentsFlags flags,
+                              GCancellable *cancellable,
+                              GFileProgressCallback progress_callback,
+                              gpointer progress_data,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+  g_return_if_fail (VTE_IS_TERMINAL (terminal));
+  g_return_if_fail (G_IS_FILE (file));
+
+  auto const data = g_new0 (SaveData, 1);
+  data->terminal = terminal;
+  g_object_add_weak_pointer (G_OBJECT (terminal), (gpointer*) &data->terminal);
+  data->file = (GFile*)g_object_ref (file);
+  data->flags = flags;
+  data->progress_callback = progress_callback;
+  data->progress_data = progress_data;
+  data->start_time = g_get_monotonic_time ();
+
+  /* The rows to save are fixed now, so that output arriving
+   * meanwhile does not keep the operation going.
+   */
+  get_row_range (terminal, &data->start_row, &data->end_row);
+  data->next_row = data->start_row;
+  data->last_column = vte_terminal_get_column_count (terminal) - 1;
+  data->chunk_rows = CHUNK_MIN_ROWS * 4;
+
+  /* Own cancellable, to also cancel when the terminal goes away */
+  data->cancellable = g_cancellable_new ();
+  if (cancellable != nullptr) {
+    data->caller_cancellable = (GCancellable*)g_object_ref (cancellable);
+    data->caller_cancelled_id =
+      g_cancellable_connect (cancellable,
+                             G_CALLBACK (save_contents_caller_cancelled_cb),
+                             g_object_ref (data->cancellable),
+                             g_object_unref);
+  }
+
+  auto const task = g_task_new (nullptr, cancellable, callback, user_data);
+  g_task_set_source_tag (task, (gpointer) terminal_save_contents_async);
+  g_task_set_task_data (task, data, GDestroyNotify (save_data_free));
+
+  /* Try to create the file first, to know whether it is new */
+  g_file_create_async (file,
+                       G_FILE_CREATE_NONE,
+                       G_PRIORITY_LOW,
+                       data->cancellable,
+                       save_contents_create_cb,
+                       task /* adopts */);
+}
+
+/**
+ * terminal_save_contents_finish:
+ * @result: the #GAsyncResult
+ * @error: a location to store a #GError
+ *
+ * Returns: %TRUE if the contents were saved
+ */
+gboolean
+terminal_save_contents_finish (GAsyncResult *result,
+                               GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, nullptr), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+#include <vte/vte.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+  TERMINAL_SAVE_CONTENTS_FLAG_NONE     = 0,
+  TERMINAL_SAVE_CONTENTS_FLAG_COMPRESS = 1 << 0,
+} TerminalSaveContentsFlags;
+
+void terminal_save_contents_async (VteTerminal *terminal,
+                                   GFile *file,
+                                   TerminalSaveContentsFlags flags,
+                                   GCancellable *cancellable,
+                                   GFileProgressCallback progress_callback,
+                                   gpointer progress_data,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data);
+
+gboolean terminal_save_contents_finish (GAsyncResult *result,
+                                        GError **error);
+
+G_END_DECLS
@@ -31,6 +31,7 @@ G_BEGIN_DECLS
 #define TERMINAL_PROFILES_LIST_SCHEMA   "org.gnome.Terminal.ProfilesList"
 
 #define TERMINAL_KEYBINDINGS_SCHEMA_PATH "/org/gnome/terminal/legacy/keybindings/"
+#define TERMINAL_SETTING_SCHEMA_PATH     "/org/gnome/terminal/legacy/"
 
 #define TERMINAL_PROFILE_AUDIBLE_BELL_KEY               "audible-bell"
 #define TERMINAL_PROFILE_BOLD_IS_BRIGHT_KEY             "bold-is-bright"
@@ -78,6 +79,7 @@ G_BEGIN_DECLS
 #define TERMINAL_PROFILE_USE_SYSTEM_FONT_KEY            "use-system-font"
 #define TERMINAL_PROFILE_USE_THEME_COLORS_KEY           "use-theme-colors"
 #define TERMINAL_PROFILE_VISIBLE_NAME_KEY               "visible-name"
+#define TERMINAL_PROFILE_WARM_POOL_SIZE_KEY             "warm-pool-size"
 #define TERMINAL_PROFILE_WORD_CHAR_EXCEPTIONS_KEY       "word-char-exceptions"
 
 #define TERMINAL_SETTING_CONFIRM_CLOSE_KEY              "confirm-close"
@@ -89,6 +91,7 @@ G_BEGIN_DECLS
 #define TERMINAL_SETTING_NEW_TAB_POSITION_KEY           "new-tab-position"
 #define TERMINAL_SETTING_ROUNDED_CORNERS_KEY            "rounded-corners"
 #define TERMINAL_SETTING_SCHEMA_VERSION                 "schema-version"
+#define TERMINAL_SETTING_SCROLLBACK_MEMORY_LIMIT_KEY    "scrollback-memory-limit"
 #define TERMINAL_SETTING_SHELL_INTEGRATION_KEY          "shell-integration-enabled"
 #define TERMINAL_SETTING_TAB_POLICY_KEY                 "tab-policy"
 #define TERMINAL_SETTING_THEME_VARIANT_KEY              "theme-variant"
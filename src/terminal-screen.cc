@@ -21,6 +21,8 @@
 #include "terminal-pcre2.hh"
 #include "terminal-regex.hh"
 #include "terminal-screen.hh"
+#include "terminal-url-classifier.hh"
+#include "terminal-url-prefilter.hh"
 #include "terminal-client-utils.hh"
 #include "terminal-notebook.hh"
 
@@ -33,6 +35,7 @@
 #include <uuid.h>
 
 #include <algorithm>
+#include <cmath>
 
 #if defined(__FreeBSD__) || defined(__DragonFly__) || defined(__OpenBSD__)
 #include <sys/sysctl.h>
@@ -57,7 +60,9 @@
 #include "terminal-debug.hh"
 #include "terminal-defines.hh"
 #include "terminal-enums.hh"
+#include "terminal-icon-cache.hh"
 #include "terminal-intl.hh"
+#include "terminal-profile-snapshot.hh"
 #include "terminal-marshal.h"
 #include "terminal-schemas.hh"
 #include "terminal-tab.hh"
@@ -71,6 +76,15 @@
 #define URL_MATCH_CURSOR_NAME "pointer"
 #define SIZE_DISMISS_TIMEOUT_MSEC 1000
 
+/* How long after the last output to check which process is in the foreground */
+#define FOREGROUND_PROCESS_CHECK_MSEC 250
+#define FOREGROUND_PROCESS_CHECK_BACKGROUND_MSEC 1000
+/* How many of those intervals continuous output may put off the check */
+#define FOREGROUND_PROCESS_CHECK_MAX_DELAYS 4
+
+/* How often a background terminal notifies changes of its title and icons */
+#define BACKGROUND_NOTIFY_INTERVAL_MSEC 1000
+
 #define DROP_REQUEST_PRIORITY               G_PRIORITY_DEFAULT
 #define APPLICATION_VND_PORTAL_FILETRANSFER "application/vnd.portal.filetransfer"
 #define APPLICATION_VND_PORTAL_FILES        "application/vnd.portal.files"
@@ -87,6 +101,7 @@ typedef struct {
   char **envv;
   char *cwd;
   gboolean as_shell;
+  gboolean may_use_warm_child; /* nothing was requested that a warm child can't have */
 
   VtePtyFlags pty_flags;
   GSpawnFlags spawn_flags;
@@ -107,11 +122,31 @@ typedef struct {
 
 } // anon namespace
 
-typedef struct
+/* The name and command line of a foreground process */
+typedef struct {
+  char *process_name;
+  char *cmdline;
+} ForegroundProcess;
+
+static void
+foreground_process_free (ForegroundProcess *process)
 {
-  int tag;
-  TerminalURLFlavor flavor;
-} TagData;
+  if (process == nullptr)
+    return;
+
+  g_free (process->process_name);
+  g_free (process->cmdline);
+  g_free (process);
+}
+
+static ForegroundProcess *
+foreground_process_copy (const ForegroundProcess *process)
+{
+  ForegroundProcess *copy = g_new0 (ForegroundProcess, 1);
+  copy->process_name = g_strdup (process->process_name);
+  copy->cmdline = g_strdup (process->cmdline);
+  return copy;
+}
 
 typedef struct {
   TerminalScreen *screen;
@@ -126,14 +161,34 @@ struct _TerminalScreenPrivate
   gboolean registered; /* D-Bus interface is registered */
 
   GSettings *profile; /* never nullptr */
+  TerminalProfileSnapshot *profile_snapshot; /* the values last applied */
+  guint profile_tick; /* tick callback applying profile changes */
   guint profile_changed_id;
   guint profile_forgotten_id;
   int child_pid;
-  GSList *match_tags;
+  int url_match_tag;
   gboolean exec_on_realize;
   guint idle_exec_source;
   ExecData *exec_data;
 
+  /* For TERMINAL_DEBUG_LATENCY */
+  gint64 creation_time;
+  gint64 spawn_time;
+  gboolean first_output_pending;
+  gboolean warm_child;
+
+  /* Background mode: the terminal isn't visible, so changes to its title
+   * and icons are notified at a low rate. The pending ones are a mask
+   * of 1 << prop_id.
+   */
+  gboolean background;
+  guint background_pending_notify;
+  guint background_notify_source;
+
+  /* For the scrollback governor in TerminalApp */
+  glong scrollback_cap; /* -1 if not limited */
+  gint64 last_focus_time;
+
   GtkRevealer *size_revealer;
   GtkLabel *size_label;
   guint size_dismiss_source;
@@ -149,6 +204,21 @@ struct _TerminalScreenPrivate
   VteProgressHint progress_hint;
   double progress_fraction;
   GIcon* icon_progress;
+
+  /* The last foreground process read, and its process group */
+  int fg_process_pgrp;
+  ForegroundProcess *fg_process;
+  /* The process group being read, and the tasks waiting for a read, each
+   * with the process group it asked about as its task data */
+  int fg_process_pending_pgrp;
+  GSList *fg_process_waiters;
+
+  /* The value of the foreground-process property, and how it's kept up to date */
+  GVariant *fg_process_value;
+  guint fg_process_check_source;
+  gint64 fg_process_check_deadline;
+  gboolean fg_process_querying;
+  GCancellable *fg_process_cancellable;
 };
 
 enum
@@ -165,6 +235,7 @@ enum {
   PROP_ICON,
   PROP_ICON_PROGRESS,
   PROP_TITLE,
+  PROP_FOREGROUND_PROCESS,
   N_PROPS
 };
 
@@ -205,18 +276,29 @@ static void terminal_screen_bubble_click_pressed_cb (TerminalScreen  *screen,
                                                      GtkGestureClick *click);
 static void terminal_screen_child_exited  (VteTerminal *terminal,
                                            int status);
+static void terminal_screen_contents_changed_cb (VteTerminal *terminal,
+                                                TerminalScreen *screen);
+static void terminal_screen_update_foreground_process (TerminalScreen *screen);
+static void terminal_screen_has_focus_notify_cb (GObject *object,
+                                                 GParamSpec *pspec,
+                                                 TerminalScreen *screen);
+static void terminal_screen_update_scrollback_lines (TerminalScreen *screen);
 
 static void terminal_screen_window_title_changed      (VteTerminal *vte_terminal,
                                                        TerminalScreen *screen);
 
 static void update_color_scheme                      (TerminalScreen *screen);
 
+static char* terminal_screen_dup_text_at (TerminalScreen *screen,
+                                          double          y);
 static void terminal_screen_check_extra (TerminalScreen *screen,
+                                         const char     *text,
                                          double          x,
                                          double          y,
                                          char           **number_info,
                                          char           **timestamp_info);
 static char* terminal_screen_check_match (TerminalScreen *screen,
+                                          const char     *text,
                                           double          x,
                                           double          y,
                                           int            *flavor);
@@ -226,21 +308,6 @@ static void terminal_screen_show_info_bar (TerminalScreen *screen,
                                            gboolean show_relaunch);
 
 
-static char**terminal_screen_get_child_environment (TerminalScreen *screen,
-                                                    char **initial_envv,
-                                                    char **path,
-                                                    char **shell);
-
-static gboolean terminal_screen_get_child_command (TerminalScreen *screen,
-                                                   char          **exec_argv,
-                                                   const char     *path_env,
-                                                   const char     *shell_env,
-                                                   gboolean        shell,
-                                                   gboolean       *preserve_cwd_p,
-                                                   GSpawnFlags    *spawn_flags_p,
-                                                   char         ***argv_p,
-                                                   GError        **err);
-
 static void terminal_screen_menu_popup_action (GtkWidget  *widget,
                                                const char *action_name,
                                                GVariant   *param);
@@ -261,25 +328,32 @@ typedef struct {
   TerminalURLFlavor flavor;
 } TerminalRegexPattern;
 
-static const TerminalRegexPattern url_regex_patterns[] = {
-  { REGEX_URL_AS_IS, FLAVOR_AS_IS },
-  { REGEX_URL_HTTP,  FLAVOR_DEFAULT_TO_HTTP },
-  { REGEX_URL_FILE,  FLAVOR_AS_IS },
-  { REGEX_URL_VOIP,  FLAVOR_VOIP_CALL },
-  { REGEX_EMAIL,     FLAVOR_EMAIL },
-  { REGEX_NEWS_MAN,  FLAVOR_AS_IS },
+/* The flavor of each alternative of REGEX_URL_COMBINED, indexed by
+ * TerminalUrlKind */
+static const TerminalURLFlavor url_kind_flavors[] = {
+  FLAVOR_AS_IS,           /* TERMINAL_URL_KIND_AS_IS */
+  FLAVOR_DEFAULT_TO_HTTP, /* TERMINAL_URL_KIND_HTTP */
+  FLAVOR_AS_IS,           /* TERMINAL_URL_KIND_FILE */
+  FLAVOR_VOIP_CALL,       /* TERMINAL_URL_KIND_VOIP */
+  FLAVOR_EMAIL,           /* TERMINAL_URL_KIND_EMAIL */
+  FLAVOR_AS_IS,           /* TERMINAL_URL_KIND_NEWS_MAN */
 };
 
 static const TerminalRegexPattern extra_regex_patterns[] = {
   { "(0[Xx][[:xdigit:]]+|[[:digit:]]+)", FLAVOR_NUMBER },
 };
 
-static VteRegex **url_regexes;
+/* Every match of one of the extra_regex_patterns contains one of these,
+ * or is made up of non-ASCII digits */
+static const char *const extra_regex_literals[] = {
+  "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", nullptr
+};
+
+static VteRegex *url_regex;
 static VteRegex **extra_regexes;
-static TerminalURLFlavor *url_regex_flavors;
 static TerminalURLFlavor *extra_regex_flavors;
-static guint n_url_regexes;
 static guint n_extra_regexes;
+static TerminalUrlPrefilter *extra_regex_prefilter;
 
 /* See bug #697024 */
 #ifndef __linux__
@@ -414,12 +488,6 @@ terminal_screen_clear_exec_data (TerminalScreen *screen,
 
 G_DEFINE_TYPE_WITH_PRIVATE (TerminalScreen, terminal_screen, VTE_TYPE_TERMINAL)
 
-static void
-free_tag_data (TagData *tagdata)
-{
-  g_slice_free (TagData, tagdata);
-}
-
 static void
 precompile_regexes (const TerminalRegexPattern *regex_patterns,
                     guint n_regexes,
@@ -450,6 +518,23 @@ precompile_regexes (const TerminalRegexPattern *regex_patterns,
     }
 }
 
+static void
+precompile_url_regex (void)
+{
+  GError *error = nullptr;
+
+  url_regex = vte_regex_new_for_match (REGEX_URL_COMBINED, -1,
+                                       PCRE2_UTF | PCRE2_NO_UTF_CHECK | PCRE2_UCP | PCRE2_MULTILINE,
+                                       &error);
+  terminal_assert_no_error (error);
+
+  if (!vte_regex_jit (url_regex, PCRE2_JIT_COMPLETE, &error) ||
+      !vte_regex_jit (url_regex, PCRE2_JIT_PARTIAL_SOFT, &error)) {
+    g_printerr ("Failed to JIT regex '%s': %s\n", REGEX_URL_COMBINED, error->message);
+    g_clear_error (&error);
+  }
+}
+
 static void
 terminal_screen_enable_menu_bar_accel_notify_cb (GSettings *settings,
                                                  const char *key,
@@ -464,21 +549,87 @@ terminal_screen_enable_menu_bar_accel_notify_cb (GSettings *settings,
                                  g_settings_get_boolean (settings, key));
 }
 
-static GdkTexture*
-texture_from_surface(cairo_surface_t* surface)
+static void
+terminal_screen_flush_background_notify(TerminalScreen* screen)
+{
+  auto const priv = screen->priv;
+
+  g_clear_handle_id(&priv->background_notify_source, g_source_remove);
+
+  auto const pending = priv->background_pending_notify;
+  priv->background_pending_notify = 0;
+  if (pending == 0)
+    return;
+
+  auto const object = G_OBJECT(screen);
+  g_object_freeze_notify(object);
+  for (auto prop_id = 1u; prop_id < N_PROPS; ++prop_id) {
+    if (pending & (1u << prop_id))
+      g_object_notify_by_pspec(object, pspecs[prop_id]);
+  }
+  g_object_thaw_notify(object);
+}
+
+static gboolean
+terminal_screen_background_notify_cb(void* data)
+{
+  auto const screen = TERMINAL_SCREEN(data);
+
+  screen->priv->background_notify_source = 0;
+  terminal_screen_flush_background_notify(screen);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Notifies @prop_id right away, or if in background mode, together with
+ * the other changes within the next BACKGROUND_NOTIFY_INTERVAL_MSEC.
+ */
+static void
+terminal_screen_notify_throttled(TerminalScreen* screen,
+                                 guint prop_id)
+{
+  auto const priv = screen->priv;
+
+  if (!priv->background) {
+    g_object_notify_by_pspec(G_OBJECT(screen), pspecs[prop_id]);
+    return;
+  }
+
+  priv->background_pending_notify |= 1u << prop_id;
+  if (priv->background_notify_source == 0)
+    priv->background_notify_source =
+      g_timeout_add_full(G_PRIORITY_LOW,
+                         BACKGROUND_NOTIFY_INTERVAL_MSEC,
+                         terminal_screen_background_notify_cb,
+                         screen, nullptr);
+}
+
+/**
+ * terminal_screen_set_background:
+ * @screen:
+ * @background: whether @screen is not visible to the user
+ *
+ * Sets whether @screen is in background mode, where it is cheaper to keep
+ * running at the cost of updating its title and icons less often.
+ */
+void
+terminal_screen_set_background(TerminalScreen* screen,
+                               gboolean background)
 {
-  gs_unref_bytes auto bytes =
-    g_bytes_new_with_free_func(cairo_image_surface_get_data(surface),
-                               size_t(cairo_image_surface_get_height(surface)) *
-                               size_t(cairo_image_surface_get_stride(surface)),
-                               GDestroyNotify(cairo_surface_destroy),
-                               cairo_surface_reference(surface));
+  g_return_if_fail(TERMINAL_IS_SCREEN(screen));
+
+  auto const priv = screen->priv;
+  background = background != FALSE;
+  if (priv->background == background)
+    return;
+
+  _terminal_debug_print(TERMINAL_DEBUG_MDI,
+                        "[screen %p] background mode %s\n",
+                        screen, background ? "on" : "off");
 
-  return gdk_memory_texture_new(cairo_image_surface_get_width(surface),
-                                cairo_image_surface_get_height(surface),
-                                GDK_MEMORY_DEFAULT,
-                                bytes,
-                                cairo_image_surface_get_stride(surface));
+  priv->background = background;
+  if (!background)
+    terminal_screen_flush_background_notify(screen);
 }
 
 static void
@@ -495,25 +646,10 @@ terminal_screen_icon_color_changed_cb(TerminalScreen* screen,
                                            VTE_PROPERTY_ID_ICON_COLOR,
                                            &color)) {
     auto const scale = gtk_widget_get_scale_factor(GTK_WIDGET(screen));
-    auto const w = 32 * scale, h = 32 * scale;
-    auto const xc = w / 2, yc = h / 2;
-    auto const radius = w / 2 - 1;
-
-    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
-    auto cr = cairo_create(surface);
-    cairo_set_source_rgb(cr, color.red, color.green, color.blue);
-    cairo_new_sub_path(cr);
-    cairo_arc(cr, xc, yc, radius, 0., G_PI * 2);
-    cairo_close_path(cr);
-    cairo_fill(cr);
-
-    cairo_destroy(cr);
-
-    priv->icon_color = G_ICON(texture_from_surface(surface));
-    cairo_surface_destroy(surface);
+    priv->icon_color = G_ICON(terminal_icon_cache_get_color(&color, scale));
   }
 
-  g_object_notify_by_pspec(G_OBJECT(terminal), pspecs[PROP_ICON]);
+  terminal_screen_notify_throttled(screen, PROP_ICON);
 }
 
 static void
@@ -528,7 +664,7 @@ terminal_screen_icon_image_changed_cb(TerminalScreen* screen,
     G_ICON(vte_terminal_ref_termprop_image_texture_by_id(terminal,
                                                          VTE_PROPERTY_ID_ICON_IMAGE));
 
-  g_object_notify_by_pspec(G_OBJECT(terminal), pspecs[PROP_ICON]);
+  terminal_screen_notify_throttled(screen, PROP_ICON);
 }
 
 static GIcon*
@@ -554,9 +690,6 @@ terminal_screen_ensure_icon_progress(TerminalScreen* screen)
     case VTE_PROGRESS_HINT_PAUSED:
     case VTE_PROGRESS_HINT_ACTIVE: {
       auto const scale = gtk_widget_get_scale_factor(GTK_WIDGET(screen));
-      auto const w = 16 * scale, h = 16 * scale;
-      auto const xc = w / 2, yc = h / 2;
-      auto const radius = w / 2 - 1;
 
       auto color = GdkRGBA{};
       G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
@@ -564,38 +697,13 @@ terminal_screen_ensure_icon_progress(TerminalScreen* screen)
       gtk_style_context_get_color(style_context, &color);
       G_GNUC_END_IGNORE_DEPRECATIONS;
 
-      auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
-      auto cr = cairo_create(surface);
-
-      // First draw a shadow filled circle
-      cairo_set_source_rgba(cr, color.red, color.green, color.blue, 0.25);
-      cairo_arc(cr, xc, yc, radius, 0., 2 * G_PI);
-      cairo_close_path(cr);
-      cairo_fill(cr);
-
-      // Now draw progress filled circle
-      auto const fraction = priv->progress_fraction;
-      if (fraction > 0.) {
-        cairo_set_line_width(cr, 1.);
-        cairo_set_source_rgb(cr, color.red, color.green, color.blue);
-        cairo_new_sub_path(cr);
-
-        if (fraction < 1.) {
-          cairo_move_to(cr, xc, yc);
-          cairo_line_to(cr, xc + radius, yc);
-          cairo_arc_negative(cr, xc, yc, radius, 0, 2 * G_PI * (1. - fraction));
-          cairo_line_to(cr, xc, yc);
-        } else {
-          cairo_arc(cr, xc, yc, radius, 0, 2 * G_PI);
-        }
-
-        cairo_close_path(cr);
-        cairo_fill(cr);
-      }
-      cairo_destroy(cr);
-
-      icon = G_ICON(texture_from_surface(surface));
-      cairo_surface_destroy(surface);
+      // The textures are shared with all other screens showing the same progress
+      auto const bucket = guint(std::lround(priv->progress_fraction *
+                                            TERMINAL_ICON_CACHE_PROGRESS_BUCKETS));
+      icon = G_ICON(terminal_icon_cache_get_progress(priv->progress_hint,
+                                                     bucket,
+                                                     &color,
+                                                     scale));
       break;
     }
 
@@ -605,7 +713,8 @@ terminal_screen_ensure_icon_progress(TerminalScreen* screen)
       break;
     }
 
-    g_set_object(&priv->icon_progress, icon);
+    g_clear_object(&priv->icon_progress);
+    priv->icon_progress = icon; // adopts
 
   } else {
     // Remove progress
@@ -625,7 +734,8 @@ terminal_screen_clear_icon_progress(TerminalScreen* screen)
   g_clear_object(&priv->icon_progress);
   priv->icon_progress_set = false;
 
-  g_object_notify_by_pspec(G_OBJECT(screen), pspecs[PROP_ICON_PROGRESS]);
+  // The icon is only regenerated when it is next asked for
+  terminal_screen_notify_throttled(screen, PROP_ICON_PROGRESS);
 }
 
 static void
@@ -640,8 +750,9 @@ terminal_screen_progress_value_changed_cb(TerminalScreen* screen,
   auto const has_progress = vte_terminal_get_termprop_uint_by_id(terminal,
                                                                  VTE_PROPERTY_ID_PROGRESS_VALUE,
                                                                  &value);
+  // Quantize, so that the icon only changes when it actually looks different
   if (has_progress)
-    fraction = std::clamp(double(value) / 100., 0., 1.);
+    fraction = std::round(std::clamp(double(value) / 100., 0., 1.) * TERMINAL_ICON_CACHE_PROGRESS_BUCKETS) / TERMINAL_ICON_CACHE_PROGRESS_BUCKETS;
   else
     fraction = 0.;
 
@@ -857,7 +968,6 @@ terminal_screen_init (TerminalScreen *screen)
   VteTerminal *terminal = VTE_TERMINAL (screen);
   TerminalScreenPrivate *priv;
   TerminalApp *app;
-  guint i;
   uuid_t u;
   char uuidstr[37];
 
@@ -867,7 +977,13 @@ terminal_screen_init (TerminalScreen *screen)
   uuid_unparse (u, uuidstr);
   priv->uuid = g_strdup (uuidstr);
 
+  priv->creation_time = g_get_monotonic_time ();
+  priv->last_focus_time = priv->creation_time;
+  priv->scrollback_cap = -1;
+
   priv->child_pid = -1;
+  priv->fg_process_pgrp = -1;
+  priv->fg_process_pending_pgrp = -1;
 
   priv->has_progress = false;
   priv->progress_hint = VTE_PROGRESS_HINT_INACTIVE;
@@ -880,17 +996,8 @@ terminal_screen_init (TerminalScreen *screen)
   vte_terminal_set_scroll_unit_is_pixels (terminal, TRUE);
   vte_terminal_set_enable_fallback_scrolling (terminal, FALSE);
 
-  for (i = 0; i < n_url_regexes; ++i)
-    {
-      TagData *tag_data;
-
-      tag_data = g_slice_new (TagData);
-      tag_data->flavor = url_regex_flavors[i];
-      tag_data->tag = vte_terminal_match_add_regex (terminal, url_regexes[i], 0);
-      vte_terminal_match_set_cursor_name (terminal, tag_data->tag, URL_MATCH_CURSOR_NAME);
-
-      priv->match_tags = g_slist_prepend (priv->match_tags, tag_data);
-    }
+  priv->url_match_tag = vte_terminal_match_add_regex (terminal, url_regex, 0);
+  vte_terminal_match_set_cursor_name (terminal, priv->url_match_tag, URL_MATCH_CURSOR_NAME);
 
   GdkContentFormatsBuilder *builder = gdk_content_formats_builder_new ();
   gdk_content_formats_builder_add_gtype (builder, G_TYPE_STRING);
@@ -921,6 +1028,13 @@ terminal_screen_init (TerminalScreen *screen)
   g_signal_connect(screen, "termprop-changed::" VTE_TERMPROP_PROGRESS_HINT,
                    G_CALLBACK(terminal_screen_progress_hint_changed_cb), screen);
 
+  priv->fg_process_cancellable = g_cancellable_new ();
+  g_signal_connect (screen, "contents-changed",
+                    G_CALLBACK (terminal_screen_contents_changed_cb), screen);
+
+  g_signal_connect (screen, "notify::has-focus",
+                    G_CALLBACK (terminal_screen_has_focus_notify_cb), screen);
+
   app = terminal_app_get ();
   g_signal_connect (terminal_app_get_desktop_interface_settings (app), "changed::" MONOSPACE_FONT_KEY_NAME,
                     G_CALLBACK (terminal_screen_system_font_changed_cb), screen);
@@ -949,6 +1063,9 @@ terminal_screen_get_property (GObject *object,
       case PROP_TITLE:
         g_value_set_string (value, terminal_screen_get_title (screen));
         break;
+      case PROP_FOREGROUND_PROCESS:
+        g_value_set_variant (value, screen->priv->fg_process_value);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -971,6 +1088,7 @@ terminal_screen_set_property (GObject *object,
       case PROP_ICON:
       case PROP_ICON_PROGRESS:
       case PROP_TITLE:
+      case PROP_FOREGROUND_PROCESS:
         /* not writable */
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1070,6 +1188,15 @@ terminal_screen_class_init (TerminalScreenClass *klass)
 				      G_PARAM_STATIC_STRINGS |
                                       G_PARAM_EXPLICIT_NOTIFY));
 
+  /* (pid, basename, command line) of the foreground process, or nullptr */
+  pspecs[PROP_FOREGROUND_PROCESS] =
+     g_param_spec_variant ("foreground-process", nullptr, nullptr,
+                           G_VARIANT_TYPE ("(iss)"),
+                           nullptr,
+                           GParamFlags(G_PARAM_READABLE |
+                                       G_PARAM_STATIC_STRINGS |
+                                       G_PARAM_EXPLICIT_NOTIFY));
+
   g_object_class_install_properties(object_class, N_PROPS, pspecs);
 
   gtk_widget_class_install_action (widget_class,
@@ -1090,10 +1217,10 @@ terminal_screen_class_init (TerminalScreenClass *klass)
   gtk_widget_class_bind_template_callback (widget_class, terminal_screen_drop_target_drag_leave);
   gtk_widget_class_bind_template_callback (widget_class, terminal_screen_drop_target_drop);
 
-  n_url_regexes = G_N_ELEMENTS (url_regex_patterns);
-  precompile_regexes (url_regex_patterns, n_url_regexes, &url_regexes, &url_regex_flavors);
+  precompile_url_regex ();
   n_extra_regexes = G_N_ELEMENTS (extra_regex_patterns);
   precompile_regexes (extra_regex_patterns, n_extra_regexes, &extra_regexes, &extra_regex_flavors);
+  extra_regex_prefilter = terminal_url_prefilter_new (extra_regex_literals, TRUE);
 
   g_type_ensure (ADW_TYPE_BIN);
 }
@@ -1128,6 +1255,15 @@ terminal_screen_dispose (GObject *object)
   GtkSettings *settings;
 
   g_clear_handle_id (&priv->size_dismiss_source, g_source_remove);
+  g_clear_handle_id (&priv->fg_process_check_source, g_source_remove);
+  g_clear_handle_id (&priv->background_notify_source, g_source_remove);
+  if (priv->profile_tick != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (screen), priv->profile_tick);
+      priv->profile_tick = 0;
+    }
+  if (priv->fg_process_cancellable != nullptr)
+    g_cancellable_cancel (priv->fg_process_cancellable);
 
   gtk_widget_dispose_template (GTK_WIDGET (object), TERMINAL_TYPE_SCREEN);
 
@@ -1177,7 +1313,10 @@ terminal_screen_finalize (GObject *object)
 
   terminal_screen_set_profile (screen, nullptr);
 
-  g_slist_free_full (priv->match_tags, (GDestroyNotify) free_tag_data);
+  foreground_process_free (priv->fg_process);
+  g_assert (priv->fg_process_waiters == nullptr);
+  g_clear_pointer (&priv->fg_process_value, g_variant_unref);
+  g_clear_object (&priv->fg_process_cancellable);
 
   g_free (priv->uuid);
 
@@ -1361,7 +1500,8 @@ terminal_screen_exec (TerminalScreen *screen,
 
   gs_free char *path = nullptr;
   gs_free char *shell = nullptr;
-  gs_strfreev char **envv = terminal_screen_get_child_environment (screen,
+  gs_free char *object_path = terminal_app_dup_screen_object_path (terminal_app_get (), screen);
+  gs_strfreev char **envv = terminal_screen_get_child_environment (object_path,
                                                                   initial_envv,
                                                                   &path,
                                                                   &shell);
@@ -1370,7 +1510,7 @@ terminal_screen_exec (TerminalScreen *screen,
   GSpawnFlags spawn_flags = GSpawnFlags(G_SPAWN_SEARCH_PATH_FROM_ENVP |
 					VTE_SPAWN_NO_PARENT_ENVV);
   gs_strfreev char **exec_argv = nullptr;
-  if (!terminal_screen_get_child_command (screen,
+  if (!terminal_screen_get_child_command (priv->profile,
                                           argv,
                                           path,
                                           shell,
@@ -1423,6 +1563,13 @@ terminal_screen_exec (TerminalScreen *screen,
   data->cwd = g_strdup (cwd);
   data->envv = g_strdupv (envv);
   data->as_shell = as_shell;
+  /* Adopting a warm child takes over its UUID, which changes the screen's
+   * object path. That's only fine for launches from within the server;
+   * a D-Bus Exec caller (which always passes a callback) already has the
+   * path, and e.g. --wait waits for ChildExited on it.
+   */
+  data->may_use_warm_child = argv == nullptr && initial_envv == nullptr && fd_list == nullptr &&
+                             callback == nullptr;
   data->pty_flags = VTE_PTY_DEFAULT;
   data->spawn_flags = spawn_flags;
   data->cancellable = (GCancellable*)(cancellable ? g_object_ref (cancellable) : nullptr);
@@ -1441,165 +1588,184 @@ terminal_screen_get_title (TerminalScreen *screen)
   return vte_terminal_get_window_title (VTE_TERMINAL (screen));
 }
 
+/* Applies the values of the profile snapshot that differ from @old,
+ * or all of them if @old is %nullptr */
 static void
-terminal_screen_profile_changed_cb (GSettings     *profile,
-                                    const char    *prop_name,
-                                    TerminalScreen *screen)
+terminal_screen_apply_profile_snapshot (TerminalScreen *screen,
+                                        const TerminalProfileSnapshot *old)
 {
   TerminalScreenPrivate *priv = screen->priv;
-  GObject *object = G_OBJECT (screen);
+  const TerminalProfileSnapshot *snapshot = priv->profile_snapshot;
   VteTerminal *vte_terminal = VTE_TERMINAL (screen);
   TerminalWindow *window;
+  gboolean font_changed;
 
-  g_object_freeze_notify (object);
+#define CHANGED(field) (old == nullptr || old->field != snapshot->field)
 
-  if ((window = terminal_screen_get_window (screen)))
+  font_changed = old == nullptr || !terminal_profile_snapshot_font_equal (old, snapshot);
+
+  if ((font_changed || CHANGED (scrollbar_policy)) &&
+      (window = terminal_screen_get_window (screen)))
     {
-      /* We need these in line for the set_size in
-       * update_on_realize
+      /* The new cell size or scrollbar changes the window's geometry.
+       * Before the window is realized this updates it right away, for the
+       * initial size; afterwards it is deferred to the next frame, so that
+       * several screens changing at once update it only once.
        */
-      terminal_window_update_geometry (window);
+      terminal_window_queue_update_geometry (window);
     }
 
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_SCROLLBAR_POLICY_KEY))
+  if (CHANGED (scrollbar_policy))
     _terminal_screen_update_scrollbar (screen);
 
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_KINETIC_SCROLLING_KEY))
+  if (CHANGED (kinetic_scrolling))
     _terminal_screen_update_kinetic_scrolling (screen);
 
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_ENCODING_KEY))
+  if (old == nullptr || g_strcmp0 (old->encoding, snapshot->encoding) != 0)
     {
-      gs_free char *charset = g_settings_get_string (profile, TERMINAL_PROFILE_ENCODING_KEY);
-      const char *encoding = terminal_util_translate_encoding (charset);
+      const char *encoding = terminal_util_translate_encoding (snapshot->encoding);
       if (encoding != nullptr)
         vte_terminal_set_encoding (vte_terminal, encoding, nullptr);
     }
 
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_CJK_UTF8_AMBIGUOUS_WIDTH_KEY))
-    {
-      int width;
-
-      width = g_settings_get_enum (profile, TERMINAL_PROFILE_CJK_UTF8_AMBIGUOUS_WIDTH_KEY);
-      vte_terminal_set_cjk_ambiguous_width (vte_terminal, width);
-    }
+  if (CHANGED (cjk_ambiguous_width))
+    vte_terminal_set_cjk_ambiguous_width (vte_terminal, snapshot->cjk_ambiguous_width);
 
-  if (gtk_widget_get_realized (GTK_WIDGET (screen)) &&
-      (!prop_name ||
-       prop_name == I_(TERMINAL_PROFILE_USE_SYSTEM_FONT_KEY) ||
-       prop_name == I_(TERMINAL_PROFILE_FONT_KEY) ||
-       prop_name == I_(TERMINAL_PROFILE_CELL_WIDTH_SCALE_KEY) ||
-       prop_name == I_(TERMINAL_PROFILE_CELL_HEIGHT_SCALE_KEY)))
+  if (font_changed && gtk_widget_get_realized (GTK_WIDGET (screen)))
     terminal_screen_set_font (screen);
 
-  if (!prop_name ||
-      prop_name == I_(TERMINAL_PROFILE_USE_THEME_COLORS_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_FOREGROUND_COLOR_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_BACKGROUND_COLOR_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_BOLD_COLOR_SAME_AS_FG_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_BOLD_COLOR_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_CURSOR_COLORS_SET_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_CURSOR_BACKGROUND_COLOR_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_CURSOR_FOREGROUND_COLOR_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_HIGHLIGHT_COLORS_SET_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_HIGHLIGHT_BACKGROUND_COLOR_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_HIGHLIGHT_FOREGROUND_COLOR_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_PALETTE_KEY))
+  if (old == nullptr || !terminal_profile_snapshot_colors_equal (old, snapshot))
     update_color_scheme (screen);
 
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_AUDIBLE_BELL_KEY))
-      vte_terminal_set_audible_bell (vte_terminal, g_settings_get_boolean (profile, TERMINAL_PROFILE_AUDIBLE_BELL_KEY));
-
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_SCROLL_ON_INSERT_KEY))
-    vte_terminal_set_scroll_on_insert(vte_terminal,
-                                      g_settings_get_boolean(profile, TERMINAL_PROFILE_SCROLL_ON_INSERT_KEY));
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_SCROLL_ON_KEYSTROKE_KEY))
-    vte_terminal_set_scroll_on_keystroke (vte_terminal,
-                                          g_settings_get_boolean (profile, TERMINAL_PROFILE_SCROLL_ON_KEYSTROKE_KEY));
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_SCROLL_ON_OUTPUT_KEY))
-    vte_terminal_set_scroll_on_output (vte_terminal,
-                                       g_settings_get_boolean (profile, TERMINAL_PROFILE_SCROLL_ON_OUTPUT_KEY));
-  if (!prop_name ||
-      prop_name == I_(TERMINAL_PROFILE_SCROLLBACK_LINES_KEY) ||
-      prop_name == I_(TERMINAL_PROFILE_SCROLLBACK_UNLIMITED_KEY))
+  if (CHANGED (audible_bell))
+    vte_terminal_set_audible_bell (vte_terminal, snapshot->audible_bell);
+  if (CHANGED (scroll_on_insert))
+    vte_terminal_set_scroll_on_insert (vte_terminal, snapshot->scroll_on_insert);
+  if (CHANGED (scroll_on_keystroke))
+    vte_terminal_set_scroll_on_keystroke (vte_terminal, snapshot->scroll_on_keystroke);
+  if (CHANGED (scroll_on_output))
+    vte_terminal_set_scroll_on_output (vte_terminal, snapshot->scroll_on_output);
+  if (CHANGED (scrollback_lines))
+    terminal_screen_update_scrollback_lines (screen);
+  if (CHANGED (backspace_binding))
+    vte_terminal_set_backspace_binding (vte_terminal, snapshot->backspace_binding);
+  if (CHANGED (delete_binding))
+    vte_terminal_set_delete_binding (vte_terminal, snapshot->delete_binding);
+  if (CHANGED (enable_bidi))
+    vte_terminal_set_enable_bidi (vte_terminal, snapshot->enable_bidi);
+  if (CHANGED (enable_shaping))
+    vte_terminal_set_enable_shaping (vte_terminal, snapshot->enable_shaping);
+  if (CHANGED (enable_sixel))
+    vte_terminal_set_enable_sixel (vte_terminal, snapshot->enable_sixel);
+  if (CHANGED (bold_is_bright))
+    vte_terminal_set_bold_is_bright (vte_terminal, snapshot->bold_is_bright);
+  if (CHANGED (cursor_blink_mode))
+    vte_terminal_set_cursor_blink_mode (vte_terminal, snapshot->cursor_blink_mode);
+  if (CHANGED (cursor_shape))
+    vte_terminal_set_cursor_shape (vte_terminal, snapshot->cursor_shape);
+  if (CHANGED (rewrap_on_resize))
+    vte_terminal_set_rewrap_on_resize (vte_terminal, snapshot->rewrap_on_resize);
+  if (CHANGED (text_blink_mode))
+    vte_terminal_set_text_blink_mode (vte_terminal, snapshot->text_blink_mode);
+  if (old == nullptr || g_strcmp0 (old->word_char_exceptions, snapshot->word_char_exceptions) != 0)
+    vte_terminal_set_word_char_exceptions (vte_terminal, snapshot->word_char_exceptions);
+
+#undef CHANGED
+}
+
+/* Applies the current values of the profile; only those that changed
+ * since the last time unless @all */
+static void
+terminal_screen_flush_profile (TerminalScreen *screen,
+                               gboolean all)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+  GObject *object = G_OBJECT (screen);
+  TerminalProfileSnapshot *old;
+
+  if (priv->profile == nullptr)
+    return;
+
+  old = priv->profile_snapshot;
+  priv->profile_snapshot = terminal_profile_snapshot_get (priv->profile);
+
+  if (!all && priv->profile_snapshot == old)
     {
-      glong lines = g_settings_get_boolean (profile, TERMINAL_PROFILE_SCROLLBACK_UNLIMITED_KEY) ?
-		    -1 : g_settings_get_int (profile, TERMINAL_PROFILE_SCROLLBACK_LINES_KEY);
-      vte_terminal_set_scrollback_lines (vte_terminal, lines);
+      terminal_profile_snapshot_unref (old);
+      return;
     }
 
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_BACKSPACE_BINDING_KEY))
-  vte_terminal_set_backspace_binding (vte_terminal,
-                                      VteEraseBinding(g_settings_get_enum (profile, TERMINAL_PROFILE_BACKSPACE_BINDING_KEY)));
-  
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_DELETE_BINDING_KEY))
-  vte_terminal_set_delete_binding (vte_terminal,
-                                   VteEraseBinding(g_settings_get_enum (profile, TERMINAL_PROFILE_DELETE_BINDING_KEY)));
-
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_ENABLE_BIDI_KEY))
-    vte_terminal_set_enable_bidi (vte_terminal,
-                                  g_settings_get_boolean (profile, TERMINAL_PROFILE_ENABLE_BIDI_KEY));
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_ENABLE_SHAPING_KEY))
-    vte_terminal_set_enable_shaping (vte_terminal,
-                                     g_settings_get_boolean (profile, TERMINAL_PROFILE_ENABLE_SHAPING_KEY));
-
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_ENABLE_SIXEL_KEY))
-    vte_terminal_set_enable_sixel (vte_terminal,
-                                   g_settings_get_boolean (profile, TERMINAL_PROFILE_ENABLE_SIXEL_KEY));
-
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_BOLD_IS_BRIGHT_KEY))
-    vte_terminal_set_bold_is_bright (vte_terminal,
-                                     g_settings_get_boolean (profile, TERMINAL_PROFILE_BOLD_IS_BRIGHT_KEY));
-
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_CURSOR_BLINK_MODE_KEY))
-    vte_terminal_set_cursor_blink_mode (vte_terminal,
-                                        VteCursorBlinkMode(g_settings_get_enum (priv->profile, TERMINAL_PROFILE_CURSOR_BLINK_MODE_KEY)));
-
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_CURSOR_SHAPE_KEY))
-    vte_terminal_set_cursor_shape (vte_terminal,
-                                   VteCursorShape(g_settings_get_enum (priv->profile, TERMINAL_PROFILE_CURSOR_SHAPE_KEY)));
-
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_REWRAP_ON_RESIZE_KEY))
-    vte_terminal_set_rewrap_on_resize (vte_terminal,
-                                       g_settings_get_boolean (profile, TERMINAL_PROFILE_REWRAP_ON_RESIZE_KEY));
-
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_TEXT_BLINK_MODE_KEY))
-    vte_terminal_set_text_blink_mode (vte_terminal,
-                                      VteTextBlinkMode(g_settings_get_enum (profile, TERMINAL_PROFILE_TEXT_BLINK_MODE_KEY)));
-
-  if (!prop_name || prop_name == I_(TERMINAL_PROFILE_WORD_CHAR_EXCEPTIONS_KEY))
+  g_object_freeze_notify (object);
+  terminal_screen_apply_profile_snapshot (screen, all ? nullptr : old);
+  g_object_thaw_notify (object);
+
+  if (old != nullptr)
+    terminal_profile_snapshot_unref (old);
+}
+
+static gboolean
+terminal_screen_profile_tick_cb (GtkWidget *widget,
+                                 GdkFrameClock *frame_clock,
+                                 gpointer user_data)
+{
+  TerminalScreen *screen = TERMINAL_SCREEN (widget);
+
+  screen->priv->profile_tick = 0;
+  terminal_screen_flush_profile (screen, FALSE);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* With @prop_name %nullptr, all values of @profile are applied right away.
+ * Otherwise the changes are applied once at the start of the next frame,
+ * so that a burst of changes, e.g. from dragging a slider in the profile
+ * editor, only re-sets the font, colours and geometry once per frame.
+ */
+static void
+terminal_screen_profile_changed_cb (GSettings     *profile,
+                                    const char    *prop_name,
+                                    TerminalScreen *screen)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+
+  if (prop_name == nullptr || !gtk_widget_get_realized (GTK_WIDGET (screen)))
     {
-      gs_free char *word_char_exceptions;
-      g_settings_get (profile, TERMINAL_PROFILE_WORD_CHAR_EXCEPTIONS_KEY, "ms", &word_char_exceptions);
-      vte_terminal_set_word_char_exceptions (vte_terminal, word_char_exceptions);
+      if (priv->profile_tick != 0)
+        {
+          gtk_widget_remove_tick_callback (GTK_WIDGET (screen), priv->profile_tick);
+          priv->profile_tick = 0;
+        }
+
+      terminal_screen_flush_profile (screen, prop_name == nullptr);
+      return;
     }
 
-  g_object_thaw_notify (object);
+  if (priv->profile_tick != 0)
+    return;
+
+  priv->profile_tick = gtk_widget_add_tick_callback (GTK_WIDGET (screen),
+                                                     terminal_screen_profile_tick_cb,
+                                                     nullptr, nullptr);
 }
 
 static void
 update_color_scheme (TerminalScreen *screen)
 {
   TerminalScreenPrivate *priv = screen->priv;
-  GSettings *profile = priv->profile;
-  gs_free GdkRGBA *colors;
-  gsize n_colors = 0;
-  GdkRGBA fg, bg, bold;
-  GdkRGBA cursor_bg, cursor_fg;
-  GdkRGBA highlight_bg, highlight_fg;
-  GdkRGBA *boldp;
-  GdkRGBA *cursor_bgp = nullptr, *cursor_fgp = nullptr;
-  GdkRGBA *highlight_bgp = nullptr, *highlight_fgp = nullptr;
-  gboolean use_theme_colors;
-
-  colors = terminal_g_settings_get_rgba_palette (priv->profile, TERMINAL_PROFILE_PALETTE_KEY, &n_colors);
-
-  use_theme_colors = g_settings_get_boolean (profile, TERMINAL_PROFILE_USE_THEME_COLORS_KEY);
-  if (!terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_FOREGROUND_COLOR_KEY, &fg) ||
-      !terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_BACKGROUND_COLOR_KEY, &bg)) {
-    use_theme_colors = true;
-  }
+  const TerminalProfileSnapshot *snapshot = priv->profile_snapshot;
+  const GdkRGBA *colors;
+  gsize n_colors;
+  GdkRGBA fg, bg;
+
+  if (snapshot == nullptr)
+    return;
+
+  colors = snapshot->palette;
+  n_colors = snapshot->n_palette;
+  fg = snapshot->fg;
+  bg = snapshot->bg;
 
-  if (use_theme_colors) {
+  if (snapshot->use_theme_colors) {
     auto const app = terminal_app_get();
     auto const style_manager = reinterpret_cast<AdwStyleManager*>(terminal_app_get_adw_style_manager(app));
 
@@ -1636,58 +1802,35 @@ update_color_scheme (TerminalScreen *screen)
     }
   }
 
-  if (!g_settings_get_boolean (profile, TERMINAL_PROFILE_BOLD_COLOR_SAME_AS_FG_KEY) &&
-      !use_theme_colors &&
-      terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_BOLD_COLOR_KEY, &bold))
-    boldp = &bold;
-  else
-    boldp = nullptr;
-
-  if (g_settings_get_boolean (profile, TERMINAL_PROFILE_CURSOR_COLORS_SET_KEY) &&
-      !use_theme_colors)
-    {
-      if (terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_CURSOR_BACKGROUND_COLOR_KEY, &cursor_bg))
-        cursor_bgp = &cursor_bg;
-      if (terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_CURSOR_FOREGROUND_COLOR_KEY, &cursor_fg))
-        cursor_fgp = &cursor_fg;
-    }
-
-  if (g_settings_get_boolean (profile, TERMINAL_PROFILE_HIGHLIGHT_COLORS_SET_KEY) &&
-      !use_theme_colors)
-    {
-      if (terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_HIGHLIGHT_BACKGROUND_COLOR_KEY, &highlight_bg))
-        highlight_bgp = &highlight_bg;
-      if (terminal_g_settings_get_rgba (profile, TERMINAL_PROFILE_HIGHLIGHT_FOREGROUND_COLOR_KEY, &highlight_fg))
-        highlight_fgp = &highlight_fg;
-    }
-
   vte_terminal_set_colors (VTE_TERMINAL (screen), &fg, &bg,
                            colors, n_colors);
-  vte_terminal_set_color_bold (VTE_TERMINAL (screen), boldp);
-  vte_terminal_set_color_cursor (VTE_TERMINAL (screen), cursor_bgp);
-  vte_terminal_set_color_cursor_foreground (VTE_TERMINAL (screen), cursor_fgp);
-  vte_terminal_set_color_highlight (VTE_TERMINAL (screen), highlight_bgp);
-  vte_terminal_set_color_highlight_foreground (VTE_TERMINAL (screen), highlight_fgp);
+  vte_terminal_set_color_bold (VTE_TERMINAL (screen),
+                               snapshot->bold_set ? &snapshot->bold : nullptr);
+  vte_terminal_set_color_cursor (VTE_TERMINAL (screen),
+                                 snapshot->cursor_bg_set ? &snapshot->cursor_bg : nullptr);
+  vte_terminal_set_color_cursor_foreground (VTE_TERMINAL (screen),
+                                            snapshot->cursor_fg_set ? &snapshot->cursor_fg : nullptr);
+  vte_terminal_set_color_highlight (VTE_TERMINAL (screen),
+                                    snapshot->highlight_bg_set ? &snapshot->highlight_bg : nullptr);
+  vte_terminal_set_color_highlight_foreground (VTE_TERMINAL (screen),
+                                               snapshot->highlight_fg_set ? &snapshot->highlight_fg : nullptr);
 }
 
 static void
 terminal_screen_set_font (TerminalScreen *screen)
 {
   TerminalScreenPrivate *priv = screen->priv;
-  GSettings *profile = priv->profile;
+  const TerminalProfileSnapshot *snapshot = priv->profile_snapshot;
   PangoFontDescription *desc;
   int size;
 
-  if (g_settings_get_boolean (profile, TERMINAL_PROFILE_USE_SYSTEM_FONT_KEY))
-    {
-      desc = terminal_app_get_system_font (terminal_app_get ());
-    }
+  if (snapshot == nullptr)
+    return;
+
+  if (snapshot->use_system_font)
+    desc = terminal_app_get_system_font (terminal_app_get ());
   else
-    {
-      gs_free char *font;
-      font = g_settings_get_string (profile, TERMINAL_PROFILE_FONT_KEY);
-      desc = pango_font_description_from_string (font);
-    }
+    desc = pango_font_description_copy (snapshot->font);
 
   size = pango_font_description_get_size (desc);
   /* Sanity check */
@@ -1702,10 +1845,8 @@ terminal_screen_set_font (TerminalScreen *screen)
 
   pango_font_description_free (desc);
 
-  vte_terminal_set_cell_width_scale (VTE_TERMINAL (screen),
-                                     g_settings_get_double (profile, TERMINAL_PROFILE_CELL_WIDTH_SCALE_KEY));
-  vte_terminal_set_cell_height_scale (VTE_TERMINAL (screen),
-                                      g_settings_get_double (profile, TERMINAL_PROFILE_CELL_HEIGHT_SCALE_KEY));
+  vte_terminal_set_cell_width_scale (VTE_TERMINAL (screen), snapshot->cell_width_scale);
+  vte_terminal_set_cell_height_scale (VTE_TERMINAL (screen), snapshot->cell_height_scale);
 }
 
 static void
@@ -1718,7 +1859,7 @@ terminal_screen_system_font_changed_cb (GSettings      *settings,
   if (!gtk_widget_get_realized (GTK_WIDGET (screen)))
     return;
 
-  if (!g_settings_get_boolean (priv->profile, TERMINAL_PROFILE_USE_SYSTEM_FONT_KEY))
+  if (priv->profile_snapshot == nullptr || !priv->profile_snapshot->use_system_font)
     return;
 
   terminal_screen_set_font (screen);
@@ -1742,6 +1883,8 @@ terminal_screen_set_profile (TerminalScreen *screen,
       priv->profile_changed_id = 0;
     }
 
+  g_clear_pointer (&priv->profile_snapshot, terminal_profile_snapshot_unref);
+
   priv->profile = profile;
   if (profile)
     {
@@ -1800,8 +1943,23 @@ should_preserve_cwd (TerminalPreserveWorkingDirectory preserve_cwd,
   }
 }
 
-static gboolean
-terminal_screen_get_child_command (TerminalScreen *screen,
+/*
+ * terminal_screen_get_child_command:
+ * @profile: the profile to run the command for
+ * @argv: (nullable): the command line to run, or %nullptr to use the profile's
+ *   custom command or shell
+ * @path_env: the PATH of the child's environment
+ * @shell_env: the SHELL of the child's environment
+ * @as_shell: whether to run the shell if there is neither @argv nor a custom command
+ * @preserve_cwd_p: (out): whether the child should run in the requested working directory
+ * @spawn_flags_p: (inout): the flags to spawn the child with
+ * @exec_argv_p: (out): the command to run
+ * @err:
+ *
+ * Returns: %TRUE with the command to run in @exec_argv_p, or %FALSE with @err set
+ */
+gboolean
+terminal_screen_get_child_command (GSettings      *profile,
                                    char          **argv,
                                    const char     *path_env,
                                    const char     *shell_env,
@@ -1811,8 +1969,6 @@ terminal_screen_get_child_command (TerminalScreen *screen,
                                    char         ***exec_argv_p,
                                    GError        **err)
 {
-  TerminalScreenPrivate *priv = screen->priv;
-  GSettings *profile = priv->profile;
   TerminalPreserveWorkingDirectory preserve_cwd;
   char **exec_argv;
 
@@ -1899,38 +2055,25 @@ remove_prefixed_cb(void* key,
   return g_str_has_prefix(env, prefix);
 }
 
-static char**
-terminal_screen_get_child_environment (TerminalScreen *screen,
-                                       char **initial_envv,
-                                       char **path,
-                                       char **shell)
+/* Returns the filtered environment variables of @envv, with the proxy
+ * settings and our own variables applied, except the per-screen ones.
+ */
+static GHashTable *
+child_environment_table_new (char **envv)
 {
-  TerminalApp *app = terminal_app_get ();
-  char **env;
-  gs_strfreev char** current_environ = nullptr;
-  char *e, *v;
   GHashTable *env_table;
-  GHashTableIter iter;
-  GPtrArray *retval;
+  char *v;
   guint i;
 
   env_table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 
-  if (initial_envv)
-    env = initial_envv;
-  else {
-    env = current_environ = g_get_environ ();
-    /* Remove this variable which we set in server.c:main() */
-    env = g_environ_unsetenv (env, "G_ENABLE_DIAGNOSTIC");
-  }
-
-  for (i = 0; env[i]; ++i)
+  for (i = 0; envv[i]; ++i)
     {
-      v = strchr (env[i], '=');
+      v = strchr (envv[i], '=');
       if (v)
-          g_hash_table_replace (env_table, g_strndup (env[i], v - env[i]), g_strdup (v + 1));
+          g_hash_table_replace (env_table, g_strndup (envv[i], v - envv[i]), g_strdup (v + 1));
         else
-          g_hash_table_replace (env_table, g_strdup (env[i]), nullptr);
+          g_hash_table_replace (env_table, g_strdup (envv[i]), nullptr);
     }
 
   /* Remove unwanted env variables */
@@ -1950,26 +2093,97 @@ terminal_screen_get_child_environment (TerminalScreen *screen,
   // Force ncurses to not use the dec graphics charset
   g_hash_table_replace (env_table, g_strdup("NCURSES_NO_UTF8_ACS"), g_strdup("1"));
 
-  /* Add gnome-terminal private env vars used to communicate back to g-t-server */
-  GDBusConnection *connection = g_application_get_dbus_connection (G_APPLICATION (app));
-  g_hash_table_replace (env_table, g_strdup (TERMINAL_ENV_SERVICE_NAME),
-                        g_strdup (g_dbus_connection_get_unique_name (connection)));
+  return env_table;
+}
 
-  g_hash_table_replace (env_table, g_strdup (TERMINAL_ENV_SCREEN),
-                        terminal_app_dup_screen_object_path (app, screen));
+/* Converts @env_table to a strv with room for @n_extra more entries */
+static char **
+child_environment_table_to_strv (GHashTable *env_table,
+                                 guint n_extra)
+{
+  GHashTableIter iter;
+  char *e, *v;
 
-  /* Convert to strv */
-  retval = g_ptr_array_sized_new (g_hash_table_size (env_table));
+  auto const envv = g_new (char*, g_hash_table_size (env_table) + n_extra + 1);
+  auto n = 0u;
   g_hash_table_iter_init (&iter, env_table);
   while (g_hash_table_iter_next (&iter, (gpointer *) &e, (gpointer *) &v))
-    g_ptr_array_add (retval, g_strdup_printf ("%s=%s", e, v ? v : ""));
-  g_ptr_array_add (retval, nullptr);
+    envv[n++] = g_strconcat (e, "=", v ? v : "", nullptr);
+  envv[n] = nullptr;
+
+  return envv;
+}
 
-  *path = g_strdup ((char const*)g_hash_table_lookup (env_table, "PATH"));
-  *shell = g_strdup ((char const*)g_hash_table_lookup (env_table, "SHELL"));
+/*
+ * terminal_screen_get_base_child_environment:
+ *
+ * Returns the environment of children that are not given an environment
+ * of their own, except for the variables that differ per screen. This
+ * depends only on the server's environment and the proxy settings; use
+ * terminal_app_get_base_child_environment() for the cached value.
+ *
+ * Returns: (transfer full): the base environment for child processes
+ */
+char**
+terminal_screen_get_base_child_environment (void)
+{
+  gs_strfreev char **current_environ = g_get_environ ();
+  /* Remove this variable which we set in server.c:main() */
+  current_environ = g_environ_unsetenv (current_environ, "G_ENABLE_DIAGNOSTIC");
 
+  GHashTable *env_table = child_environment_table_new (current_environ);
+  char **envv = child_environment_table_to_strv (env_table, 0);
   g_hash_table_destroy (env_table);
-  return (char **) g_ptr_array_free (retval, FALSE);
+
+  return envv;
+}
+
+/*
+ * terminal_screen_get_child_environment:
+ * @screen_object_path: the D-Bus object path of the screen the child will run in
+ * @initial_envv: (nullable): the environment to start from, or %nullptr to use
+ *   the server's own
+ * @path: (out): the PATH of the returned environment
+ * @shell: (out): the SHELL of the returned environment
+ *
+ * Returns: (transfer full): the environment for a child process
+ */
+char**
+terminal_screen_get_child_environment (const char *screen_object_path,
+                                       char **initial_envv,
+                                       char **path,
+                                       char **shell)
+{
+  TerminalApp *app = terminal_app_get ();
+  char **envv;
+  guint n;
+
+  if (initial_envv) {
+    GHashTable *env_table = child_environment_table_new (initial_envv);
+    envv = child_environment_table_to_strv (env_table, 2);
+    g_hash_table_destroy (env_table);
+
+    n = g_strv_length (envv);
+  } else {
+    /* Just copy the cached filtered environment */
+    auto const base = terminal_app_get_base_child_environment (app);
+    n = g_strv_length ((char**)base);
+    envv = g_new (char*, n + 2 + 1);
+    for (guint i = 0; i < n; ++i)
+      envv[i] = g_strdup (base[i]);
+  }
+
+  /* Add gnome-terminal private env vars used to communicate back to g-t-server */
+  GDBusConnection *connection = g_application_get_dbus_connection (G_APPLICATION (app));
+  envv[n++] = g_strconcat (TERMINAL_ENV_SERVICE_NAME, "=",
+                           g_dbus_connection_get_unique_name (connection), nullptr);
+  envv[n++] = g_strconcat (TERMINAL_ENV_SCREEN, "=", screen_object_path, nullptr);
+  envv[n] = nullptr;
+
+  *path = g_strdup (g_environ_getenv (envv, "PATH"));
+  *shell = g_strdup (g_environ_getenv (envv, "SHELL"));
+
+  return envv;
 }
 
 enum {
@@ -2067,6 +2281,9 @@ spawn_result_cb (VteTerminal *terminal,
   ExecData *new_exec_data = exec_data_clone (exec_data);
   terminal_screen_clear_exec_data (screen, FALSE);
   priv->exec_data = new_exec_data;
+
+  if (error)
+    priv->first_output_pending = FALSE;
   }
 
 out:
@@ -2077,12 +2294,50 @@ out:
   exec_data_unref (exec_data);
 }
 
+/* Runs @child in @screen instead of spawning a new child process. Since the
+ * child's environment refers to the screen by the child's uuid, the screen
+ * takes over that uuid and re-registers under it.
+ */
+static void
+terminal_screen_adopt_warm_child (TerminalScreen *screen,
+                                  TerminalWarmChild *child,
+                                  ExecData *data)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+  TerminalApp *app = terminal_app_get ();
+  VteTerminal *terminal = VTE_TERMINAL (screen);
+
+  if (priv->registered)
+    terminal_app_unregister_screen (app, screen);
+  g_free (priv->uuid);
+  priv->uuid = g_strdup (terminal_warm_child_get_uuid (child));
+  if (priv->registered)
+    terminal_app_register_screen (app, screen);
+
+  vte_terminal_set_pty (terminal, terminal_warm_child_get_pty (child));
+  GPid pid = terminal_warm_child_steal_pid (child);
+  vte_terminal_watch_child (terminal, pid);
+
+  _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                         "[screen %p] adopted warm child %d spawned %" G_GINT64_FORMAT "ms ago\n",
+                         screen, pid,
+                         (g_get_monotonic_time () - terminal_warm_child_get_spawn_time (child)) / 1000);
+
+  terminal_warm_child_free (child);
+
+  priv->warm_child = TRUE;
+  spawn_result_cb (terminal, pid, nullptr, exec_data_ref (data));
+}
+
 static gboolean
 idle_exec_cb (TerminalScreen *screen)
 {
   TerminalScreenPrivate *priv = screen->priv;
 
   priv->idle_exec_source = 0;
+  priv->spawn_time = g_get_monotonic_time ();
+  priv->first_output_pending = TRUE;
+  priv->warm_child = FALSE;
 
   ExecData *data = priv->exec_data;
   _TERMINAL_DEBUG_IF (TERMINAL_DEBUG_PROCESSES) {
@@ -2092,6 +2347,18 @@ idle_exec_cb (TerminalScreen *screen)
                            screen, str);
   }
 
+  if (data->may_use_warm_child) {
+    TerminalWarmChild *child = terminal_app_take_warm_child (terminal_app_get (),
+                                                             priv->profile,
+                                                             data->exec_argv,
+                                                             data->cwd,
+                                                             data->spawn_flags);
+    if (child != nullptr) {
+      terminal_screen_adopt_warm_child (screen, child, data);
+      return FALSE; /* don't run again */
+    }
+  }
+
   int n_fds;
   int *fds;
   if (data->fd_list) {
@@ -2229,6 +2496,7 @@ terminal_screen_bubble_click_pressed_cb (TerminalScreen  *screen,
     int url_flavor = 0;
     gs_free char *number_info = nullptr;
     gs_free char *timestamp_info = nullptr;
+    gs_free char *text = nullptr;
 
     auto event = gtk_event_controller_get_current_event (GTK_EVENT_CONTROLLER (click));
     auto state = gdk_event_get_modifier_state (event) & gtk_accelerator_get_default_mod_mask ();
@@ -2236,8 +2504,9 @@ terminal_screen_bubble_click_pressed_cb (TerminalScreen  *screen,
     auto time = gdk_event_get_time (event);
 
     hyperlink = vte_terminal_check_hyperlink_at (VTE_TERMINAL (screen), x, y);
-    url = terminal_screen_check_match (screen, x, y, &url_flavor);
-    terminal_screen_check_extra (screen, x, y, &number_info, &timestamp_info);
+    text = terminal_screen_dup_text_at (screen, y);
+    url = terminal_screen_check_match (screen, text, x, y, &url_flavor);
+    terminal_screen_check_extra (screen, text, x, y, &number_info, &timestamp_info);
 
     if (button == 3)
       {
@@ -2271,6 +2540,7 @@ terminal_screen_capture_click_pressed_cb (TerminalScreen  *screen,
   int url_flavor = 0;
   gs_free char *number_info = nullptr;
   gs_free char *timestamp_info = nullptr;
+  gs_free char *text = nullptr;
   gboolean handled = FALSE;
 
   auto event = gtk_event_controller_get_current_event (GTK_EVENT_CONTROLLER (click));
@@ -2278,8 +2548,9 @@ terminal_screen_capture_click_pressed_cb (TerminalScreen  *screen,
   auto button = gtk_gesture_single_get_current_button (GTK_GESTURE_SINGLE (click));
 
   hyperlink = vte_terminal_check_hyperlink_at (VTE_TERMINAL (screen), x, y);
-  url = terminal_screen_check_match (screen, x, y, &url_flavor);
-  terminal_screen_check_extra (screen, x, y, &number_info, &timestamp_info);
+  text = terminal_screen_dup_text_at (screen, y);
+  url = terminal_screen_check_match (screen, text, x, y, &url_flavor);
+  terminal_screen_check_extra (screen, text, x, y, &number_info, &timestamp_info);
 
   if (n_press == 1 &&
       !handled &&
@@ -2343,7 +2614,7 @@ static void
 terminal_screen_window_title_changed (VteTerminal *vte_terminal,
                                       TerminalScreen *screen)
 {
-  g_object_notify_by_pspec (G_OBJECT (screen), pspecs[PROP_TITLE]);
+  terminal_screen_notify_throttled (screen, PROP_TITLE);
 }
 
 static void
@@ -2365,6 +2636,7 @@ terminal_screen_child_exited (VteTerminal *terminal,
                          screen);
 
   priv->child_pid = -1;
+  terminal_screen_update_foreground_process (screen);
 
   action = TerminalExitAction(g_settings_get_enum (priv->profile, TERMINAL_PROFILE_EXIT_ACTION_KEY));
   auto const tab = terminal_tab_get_from_screen(screen);
@@ -2804,12 +3076,11 @@ _terminal_screen_update_scrollbar (TerminalScreen *screen)
   TerminalScreenPrivate *priv = screen->priv;
 
   auto const tab = terminal_tab_get_from_screen (screen);
-  if (tab == nullptr)
+  if (tab == nullptr || priv->profile_snapshot == nullptr)
     return;
 
-  auto const vpolicy = TerminalScrollbarPolicy(g_settings_get_enum (priv->profile, TERMINAL_PROFILE_SCROLLBAR_POLICY_KEY));
-
-  terminal_tab_set_policy (tab, TERMINAL_SCROLLBAR_POLICY_NEVER, vpolicy);
+  terminal_tab_set_policy (tab, TERMINAL_SCROLLBAR_POLICY_NEVER,
+                           priv->profile_snapshot->scrollbar_policy);
 }
 
 void
@@ -2820,8 +3091,10 @@ _terminal_screen_update_kinetic_scrolling(TerminalScreen* screen)
     return;
 
   auto const priv = screen->priv;
-  auto const value = g_settings_get_boolean(priv->profile, TERMINAL_PROFILE_KINETIC_SCROLLING_KEY);
-  terminal_tab_set_kinetic_scrolling(tab, value);
+  if (priv->profile_snapshot == nullptr)
+    return;
+
+  terminal_tab_set_kinetic_scrolling(tab, priv->profile_snapshot->kinetic_scrolling);
 }
 
 void
@@ -2846,35 +3119,100 @@ terminal_screen_get_cell_size (TerminalScreen *screen,
   *cell_height_pixels = vte_terminal_get_char_height (terminal);
 }
 
+/*
+ * terminal_screen_dup_text_at:
+ * @screen:
+ * @y: the pointer position
+ *
+ * Gets the text of the rows around the pointer, for running the prefilter
+ * on instead of the regexes. This is a single fetch of a few rows, so it
+ * can only be used when none of them soft wraps; a line that continues
+ * past them could contain a match that the prefilter can't see.
+ *
+ * Returns: (transfer full) (nullable): the text of the rows around @y, or
+ *   %nullptr if the line at @y may continue past them
+ */
+static char*
+terminal_screen_dup_text_at (TerminalScreen *screen,
+                             double          y)
+{
+  VteTerminal *terminal = VTE_TERMINAL (screen);
+  GtkAdjustment *vadjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (screen));
+  const long char_height = vte_terminal_get_char_height (terminal);
+
+  if (vadjustment == nullptr || char_height <= 0)
+    return nullptr;
+
+  /* The row under the pointer may be off by one because of the padding, so
+   * the rows next to it are fetched too, and the one before those to know
+   * that the line doesn't start further up. */
+  const long lower = long(gtk_adjustment_get_lower (vadjustment));
+  const long upper = long(gtk_adjustment_get_upper (vadjustment));
+  const long row = long(gtk_adjustment_get_value (vadjustment)) + long(y / char_height);
+  const long first_row = MAX (lower, row - 2);
+  const long last_row = MIN (upper - 1, row + 1);
+
+  if (row < lower || row >= upper)
+    return nullptr;
+
+  char *text = vte_terminal_get_text_range (terminal,
+                                            first_row, 0,
+                                            last_row, vte_terminal_get_column_count (terminal) - 1,
+                                            nullptr, nullptr, nullptr);
+  if (text == nullptr)
+    return nullptr;
+
+  /* Each row that doesn't soft wrap ends in a newline, except maybe the
+   * last one of the buffer. */
+  long n_newlines = 0;
+  for (const char *p = text; (p = strchr (p, '\n')) != nullptr; ++p)
+    ++n_newlines;
+
+  if (n_newlines < last_row - first_row + (last_row < upper - 1 ? 1 : 0)) {
+    g_free (text);
+    return nullptr;
+  }
+
+  return text;
+}
+
 static char*
 terminal_screen_check_match (TerminalScreen *screen,
+                             const char     *text,
                              double          x,
                              double          y,
                              int            *flavor)
 {
   TerminalScreenPrivate *priv = screen->priv;
-  GSList *tags;
   int tag;
   char *match;
 
+  if (text != nullptr &&
+      !terminal_url_prefilter_may_match (terminal_url_prefilter_get_default (), text, strlen (text)))
+    return nullptr;
+
   match = vte_terminal_check_match_at (VTE_TERMINAL (screen), x, y, &tag);
-  for (tags = priv->match_tags; tags != nullptr; tags = tags->next)
+  if (match == nullptr || tag != priv->url_match_tag)
     {
-      TagData *tag_data = (TagData*) tags->data;
-      if (tag_data->tag == tag)
-	{
-	  if (flavor)
-	    *flavor = tag_data->flavor;
-	  return match;
-	}
+      g_free (match);
+      return nullptr;
     }
 
-  g_free (match);
-  return nullptr;
+  TerminalUrlKind kind = terminal_url_classify (match);
+  if (kind == TERMINAL_URL_KIND_NONE)
+    {
+      g_free (match);
+      return nullptr;
+    }
+
+  if (flavor)
+    *flavor = url_kind_flavors[kind];
+  return match;
 }
 
 static void
 terminal_screen_check_extra (TerminalScreen  *screen,
+                             const char      *text,
                              double           x,
                              double           y,
                              char           **number_info,
@@ -2884,6 +3222,10 @@ terminal_screen_check_extra (TerminalScreen  *screen,
   char **matches;
   gboolean flavor_number_found = FALSE;
 
+  if (text != nullptr &&
+      !terminal_url_prefilter_may_match (extra_regex_prefilter, text, strlen (text)))
+    return;
+
   matches = g_newa (char *, n_extra_regexes);
   memset(matches, 0, sizeof(char*) * n_extra_regexes);
 
@@ -2919,53 +3261,65 @@ terminal_screen_check_extra (TerminalScreen  *screen,
     }
 }
 
-/**
- * terminal_screen_has_foreground_process:
+/*
+ * terminal_screen_get_foreground_pgrp:
  * @screen:
- * @process_name: (out) (allow-none): the basename of the program, or %nullptr
- * @cmdline: (out) (allow-none): the full command line, or %nullptr
  *
- * Checks whether there's a foreground process running in
- * this terminal.
- * 
- * Returns: %TRUE iff there's a foreground process running in @screen
+ * Returns: the process group in the foreground of @screen's PTY, or -1
+ *   if that is the shell itself or there is none
  */
-gboolean
-terminal_screen_has_foreground_process (TerminalScreen *screen,
-                                        char           **process_name,
-                                        char           **cmdline)
+static int
+terminal_screen_get_foreground_pgrp (TerminalScreen *screen)
 {
   TerminalScreenPrivate *priv = screen->priv;
-  gs_free char *command = nullptr;
-  gs_free char *data_buf = nullptr;
-  gs_free char *basename = nullptr;
-  gs_free char *name = nullptr;
   VtePty *pty;
   int fd;
-#if defined(__FreeBSD__) || defined(__DragonFly__) || defined(__OpenBSD__)
-  int mib[4];
-#else
-  char filename[64];
-#endif
-  char *data;
-  gsize i;
-  gsize len;
   int fgpid;
 
   if (priv->child_pid == -1)
-    return FALSE;
+    return -1;
 
   pty = vte_terminal_get_pty (VTE_TERMINAL (screen));
   if (pty == nullptr)
-    return FALSE;
+    return -1;
 
   fd = vte_pty_get_fd (pty);
   if (fd == -1)
-    return FALSE;
+    return -1;
 
   fgpid = tcgetpgrp (fd);
   if (fgpid == -1 || fgpid == priv->child_pid)
-    return FALSE;
+    return -1;
+
+  return fgpid;
+}
+
+/*
+ * read_foreground_process:
+ * @fgpid: a process ID
+ *
+ * Reads the name and command line of @fgpid. This may block for a long
+ * time, and is safe to call from any thread.
+ *
+ * Returns: (transfer full): the name and command line of @fgpid, which
+ *   are %nullptr if they cannot be read
+ */
+static ForegroundProcess *
+read_foreground_process (int fgpid)
+{
+  ForegroundProcess *process = g_new0 (ForegroundProcess, 1);
+  gs_free char *command = nullptr;
+  gs_free char *data_buf = nullptr;
+  gs_free char *basename = nullptr;
+  gs_free char *name = nullptr;
+#if defined(__FreeBSD__) || defined(__DragonFly__) || defined(__OpenBSD__)
+  int mib[4];
+#else
+  char filename[64];
+#endif
+  char *data;
+  gsize i;
+  gsize len;
 
 #if defined(__FreeBSD__) || defined(__DragonFly__)
   mib[0] = CTL_KERN;
@@ -2973,11 +3327,11 @@ terminal_screen_has_foreground_process (TerminalScreen *screen,
   mib[2] = KERN_PROC_ARGS;
   mib[3] = fgpid;
   if (sysctl (mib, G_N_ELEMENTS (mib), nullptr, &len, nullptr, 0) == -1)
-      return TRUE;
+      return process;
 
   data_buf = (char*)g_malloc0 (len);
   if (sysctl (mib, G_N_ELEMENTS (mib), data_buf, &len, nullptr, 0) == -1)
-      return TRUE;
+      return process;
   data = data_buf;
 #elif defined(__OpenBSD__)
   mib[0] = CTL_KERN;
@@ -2985,31 +3339,28 @@ terminal_screen_has_foreground_process (TerminalScreen *screen,
   mib[2] = fgpid;
   mib[3] = KERN_PROC_ARGV;
   if (sysctl (mib, G_N_ELEMENTS (mib), nullptr, &len, nullptr, 0) == -1)
-      return TRUE;
+      return process;
 
   data_buf = (char*)g_malloc0 (len);
   if (sysctl (mib, G_N_ELEMENTS (mib), data_buf, &len, nullptr, 0) == -1)
-      return TRUE;
+      return process;
   data = ((char**)data_buf)[0];
 #else
   g_snprintf (filename, sizeof (filename), "/proc/%d/cmdline", fgpid);
   if (!g_file_get_contents (filename, &data_buf, &len, nullptr))
-    return TRUE;
+    return process;
   data = data_buf;
 #endif
 
   basename = g_path_get_basename (data);
   if (!basename)
-    return TRUE;
+    return process;
 
   name = g_filename_to_utf8 (basename, -1, nullptr, nullptr, nullptr);
   if (!name)
-    return TRUE;
-
-  if (!process_name && !cmdline)
-    return TRUE;
+    return process;
 
-  gs_transfer_out_value (process_name, &name);
+  gs_transfer_out_value (&process->process_name, &name);
 
   if (len > 0 && data[len - 1] == '\0')
     len--;
@@ -3021,13 +3372,439 @@ terminal_screen_has_foreground_process (TerminalScreen *screen,
 
   command = g_filename_to_utf8 (data, -1, nullptr, nullptr, nullptr);
   if (!command)
+    return process;
+
+  gs_transfer_out_value (&process->cmdline, &command);
+
+  return process;
+}
+
+static void
+terminal_screen_set_foreground_process_cache (TerminalScreen *screen,
+                                              int fgpid,
+                                              ForegroundProcess *process /* adopted */)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+
+  foreground_process_free (priv->fg_process);
+  priv->fg_process = process;
+  priv->fg_process_pgrp = fgpid;
+}
+
+/**
+ * terminal_screen_has_foreground_process:
+ * @screen:
+ * @process_name: (out) (allow-none): the basename of the program, or %nullptr
+ * @cmdline: (out) (allow-none): the full command line, or %nullptr
+ *
+ * Checks whether there's a foreground process running in
+ * this terminal. This only blocks on reading the process' command line
+ * if @process_name or @cmdline are requested and it isn't cached yet; use
+ * terminal_screen_query_foreground_process_async() to avoid that.
+ * 
+ * Returns: %TRUE iff there's a foreground process running in @screen
+ */
+gboolean
+terminal_screen_has_foreground_process (TerminalScreen *screen,
+                                        char           **process_name,
+                                        char           **cmdline)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+  int fgpid;
+
+  fgpid = terminal_screen_get_foreground_pgrp (screen);
+  if (fgpid == -1)
+    return FALSE;
+
+  if (!process_name && !cmdline)
     return TRUE;
 
-  gs_transfer_out_value (cmdline, &command);
+  if (fgpid != priv->fg_process_pgrp)
+    terminal_screen_set_foreground_process_cache (screen, fgpid,
+                                                  read_foreground_process (fgpid));
+
+  if (process_name)
+    *process_name = g_strdup (priv->fg_process->process_name);
+  if (cmdline)
+    *cmdline = g_strdup (priv->fg_process->cmdline);
+
+  return TRUE;
+}
+
+static void
+read_foreground_process_thread (GTask *task,
+                                gpointer source_object,
+                                gpointer task_data,
+                                GCancellable *cancellable)
+{
+  g_task_return_pointer (task,
+                         read_foreground_process (GPOINTER_TO_INT (task_data)),
+                         (GDestroyNotify) foreground_process_free);
+}
+
+static void read_foreground_process_done_cb (GObject *source_object,
+                                             GAsyncResult *result,
+                                             gpointer user_data);
+
+static void
+terminal_screen_start_foreground_process_read (TerminalScreen *screen,
+                                               int fgpid)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+
+  g_assert (priv->fg_process_pending_pgrp == -1);
+  priv->fg_process_pending_pgrp = fgpid;
+
+  gs_unref_object GTask *read_task = g_task_new (screen, nullptr,
+                                                 read_foreground_process_done_cb,
+                                                 nullptr);
+  g_task_set_task_data (read_task, GINT_TO_POINTER (fgpid), nullptr);
+  g_task_run_in_thread (read_task, read_foreground_process_thread);
+}
+
+static void
+read_foreground_process_done_cb (GObject *source_object,
+                                 GAsyncResult *result,
+                                 gpointer user_data)
+{
+  TerminalScreen *screen = TERMINAL_SCREEN (source_object);
+  TerminalScreenPrivate *priv = screen->priv;
+  const int fgpid = GPOINTER_TO_INT (g_task_get_task_data (G_TASK (result)));
+  ForegroundProcess *process;
+  GSList *waiters, *stale = nullptr, *l;
+  int current;
+
+  process = (ForegroundProcess *) g_task_propagate_pointer (G_TASK (result), nullptr);
+  if (process == nullptr)
+    process = g_new0 (ForegroundProcess, 1);
+
+  _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                         "[screen %p] read foreground process %d: %s\n",
+                         screen, fgpid,
+                         process->process_name ? process->process_name : "(unknown)");
+
+  g_assert (fgpid == priv->fg_process_pending_pgrp);
+  waiters = g_slist_reverse (priv->fg_process_waiters);
+  priv->fg_process_waiters = nullptr;
+  priv->fg_process_pending_pgrp = -1;
+
+  /* Update the cache first, the waiters may look at it */
+  terminal_screen_set_foreground_process_cache (screen, fgpid, process);
+
+  for (l = waiters; l != nullptr; l = l->next)
+    {
+      GTask *task = G_TASK (l->data);
+
+      /* Waiters that asked about another process group queued up behind
+       * this read; they must not get its result.
+       */
+      if (GPOINTER_TO_INT (g_task_get_task_data (task)) != fgpid)
+        {
+          stale = g_slist_prepend (stale, task);
+          continue;
+        }
+
+      g_task_return_pointer (task,
+                             foreground_process_copy (process),
+                             (GDestroyNotify) foreground_process_free);
+      g_object_unref (task);
+    }
+  g_slist_free (waiters);
+
+  if (stale == nullptr)
+    return;
+
+  /* Answer them about the process group in the foreground now, with a
+   * new read if that isn't the one just read.
+   */
+  current = terminal_screen_get_foreground_pgrp (screen);
+  for (l = g_slist_reverse (stale); l != nullptr; l = l->next)
+    {
+      GTask *task = G_TASK (l->data);
+
+      if (current == -1)
+        g_task_return_pointer (task, nullptr, nullptr);
+      else if (current == fgpid)
+        g_task_return_pointer (task,
+                               foreground_process_copy (process),
+                               (GDestroyNotify) foreground_process_free);
+      else
+        {
+          g_task_set_task_data (task, GINT_TO_POINTER (current), nullptr);
+          priv->fg_process_waiters = g_slist_prepend (priv->fg_process_waiters, task);
+          continue;
+        }
+
+      g_object_unref (task);
+    }
+  g_slist_free (stale);
+
+  if (priv->fg_process_waiters != nullptr)
+    terminal_screen_start_foreground_process_read (screen, current);
+}
+
+/**
+ * terminal_screen_query_foreground_process_async:
+ * @screen:
+ * @cancellable: (allow-none): a #GCancellable, or %nullptr
+ * @callback: called when the query is done
+ * @user_data: data for @callback
+ *
+ * Like terminal_screen_has_foreground_process(), but reads the foreground
+ * process' command line on a worker thread, so that a slow or hung read
+ * cannot block the main loop. The result is cached until the foreground
+ * process group changes, and concurrent queries share one read.
+ */
+void
+terminal_screen_query_foreground_process_async (TerminalScreen *screen,
+                                                GCancellable *cancellable,
+                                                GAsyncReadyCallback callback,
+                                                gpointer user_data)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+  int fgpid;
+
+  g_return_if_fail (TERMINAL_IS_SCREEN (screen));
+
+  gs_unref_object GTask *task = g_task_new (screen, cancellable, callback, user_data);
+  g_task_set_source_tag (task, (gpointer) terminal_screen_query_foreground_process_async);
 
+  fgpid = terminal_screen_get_foreground_pgrp (screen);
+  if (fgpid == -1)
+    {
+      g_task_return_pointer (task, nullptr, nullptr);
+      return;
+    }
+
+  if (fgpid == priv->fg_process_pgrp)
+    {
+      g_task_return_pointer (task,
+                             foreground_process_copy (priv->fg_process),
+                             (GDestroyNotify) foreground_process_free);
+      return;
+    }
+
+  g_task_set_task_data (task, GINT_TO_POINTER (fgpid), nullptr);
+  priv->fg_process_waiters = g_slist_prepend (priv->fg_process_waiters,
+                                              g_steal_pointer (&task));
+
+  /* A read is already in progress. If it is for a previous process group,
+   * don't pile up reads behind a hung one; this waiter gets a new read once
+   * that one is done.
+   */
+  if (priv->fg_process_pending_pgrp != -1)
+    return;
+
+  terminal_screen_start_foreground_process_read (screen, fgpid);
+}
+
+/**
+ * terminal_screen_query_foreground_process_finish:
+ * @screen:
+ * @result: the #GAsyncResult
+ * @process_name: (out) (allow-none): the basename of the program, or %nullptr
+ * @cmdline: (out) (allow-none): the full command line, or %nullptr
+ * @error: a #GError location
+ *
+ * Returns: %TRUE iff there's a foreground process running in @screen;
+ *   %FALSE if there is none, or on error with @error filled in
+ */
+gboolean
+terminal_screen_query_foreground_process_finish (TerminalScreen *screen,
+                                                 GAsyncResult *result,
+                                                 char **process_name,
+                                                 char **cmdline,
+                                                 GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, screen), FALSE);
+
+  ForegroundProcess *process =
+    (ForegroundProcess *) g_task_propagate_pointer (G_TASK (result), error);
+  if (process == nullptr)
+    return FALSE;
+
+  if (process_name)
+    *process_name = g_steal_pointer (&process->process_name);
+  if (cmdline)
+    *cmdline = g_steal_pointer (&process->cmdline);
+
+  foreground_process_free (process);
   return TRUE;
 }
 
+static void
+terminal_screen_set_foreground_process_value (TerminalScreen *screen,
+                                              int fgpid,
+                                              const ForegroundProcess *process)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+  GVariant *value = nullptr;
+
+  if (fgpid != -1)
+    value = g_variant_ref_sink (g_variant_new ("(iss)",
+                                               fgpid,
+                                               process->process_name ? process->process_name : "",
+                                               process->cmdline ? process->cmdline : ""));
+
+  if (value == priv->fg_process_value ||
+      (value != nullptr && priv->fg_process_value != nullptr &&
+       g_variant_equal (value, priv->fg_process_value)))
+    {
+      g_clear_pointer (&value, g_variant_unref);
+      return;
+    }
+
+  _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                         "[screen %p] foreground process now %d (%s)\n",
+                         screen, fgpid,
+                         process && process->process_name ? process->process_name : "none");
+
+  g_clear_pointer (&priv->fg_process_value, g_variant_unref);
+  priv->fg_process_value = value;
+  g_object_notify_by_pspec (G_OBJECT (screen), pspecs[PROP_FOREGROUND_PROCESS]);
+}
+
+static void
+update_foreground_process_cb (GObject *source_object,
+                              GAsyncResult *result,
+                              gpointer user_data)
+{
+  TerminalScreen *screen = TERMINAL_SCREEN (source_object);
+  g_autoptr(GError) error = nullptr;
+
+  terminal_screen_query_foreground_process_finish (screen, result, nullptr, nullptr, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  screen->priv->fg_process_querying = FALSE;
+
+  /* The read may have been for an earlier process group, so check again */
+  terminal_screen_update_foreground_process (screen);
+}
+
+/*
+ * terminal_screen_update_foreground_process:
+ * @screen:
+ *
+ * Brings the foreground-process property up to date. Reading a new
+ * foreground process' command line happens on a worker thread, and the
+ * property only changes once that is done.
+ */
+static void
+terminal_screen_update_foreground_process (TerminalScreen *screen)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+  int fgpid;
+
+  fgpid = terminal_screen_get_foreground_pgrp (screen);
+  if (fgpid == -1)
+    {
+      terminal_screen_set_foreground_process_value (screen, -1, nullptr);
+      return;
+    }
+
+  if (fgpid == priv->fg_process_pgrp)
+    {
+      terminal_screen_set_foreground_process_value (screen, fgpid, priv->fg_process);
+      return;
+    }
+
+  if (priv->fg_process_querying)
+    return;
+
+  priv->fg_process_querying = TRUE;
+  terminal_screen_query_foreground_process_async (screen,
+                                                  priv->fg_process_cancellable,
+                                                  update_foreground_process_cb,
+                                                  nullptr);
+}
+
+static gboolean
+terminal_screen_check_foreground_process_cb (gpointer user_data)
+{
+  TerminalScreen *screen = TERMINAL_SCREEN (user_data);
+
+  screen->priv->fg_process_check_source = 0;
+  terminal_screen_update_foreground_process (screen);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* The foreground process can only change while the terminal is busy,
+ * so check it once the output has been quiet for
+ * FOREGROUND_PROCESS_CHECK_MSEC. Each change puts the check off again,
+ * but continuous output doesn't put it off for more than
+ * FOREGROUND_PROCESS_CHECK_MAX_DELAYS of those.
+ */
+static void
+terminal_screen_contents_changed_cb (VteTerminal *terminal,
+                                     TerminalScreen *screen)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+
+  if (G_UNLIKELY (priv->first_output_pending)) {
+    priv->first_output_pending = FALSE;
+
+    auto const now = g_get_monotonic_time ();
+    _terminal_debug_print (TERMINAL_DEBUG_LATENCY,
+                           "[screen %p] first output %" G_GINT64_FORMAT "ms after creation, "
+                           "%" G_GINT64_FORMAT "ms after launching the %s child\n",
+                           screen,
+                           (now - priv->creation_time) / 1000,
+                           (now - priv->spawn_time) / 1000,
+                           priv->warm_child ? "warm" : "new");
+  }
+
+  auto const interval = priv->background ? FOREGROUND_PROCESS_CHECK_BACKGROUND_MSEC
+                                         : FOREGROUND_PROCESS_CHECK_MSEC;
+  auto const now = g_get_monotonic_time ();
+
+  if (priv->fg_process_check_source == 0)
+    priv->fg_process_check_deadline = now + gint64(interval) * FOREGROUND_PROCESS_CHECK_MAX_DELAYS * 1000;
+  else if (now + gint64(interval) * 1000 <= priv->fg_process_check_deadline)
+    g_clear_handle_id (&priv->fg_process_check_source, g_source_remove);
+  else
+    return;
+
+  priv->fg_process_check_source = g_timeout_add (interval,
+                                                 terminal_screen_check_foreground_process_cb,
+                                                 screen);
+}
+
+/**
+ * terminal_screen_get_foreground_process:
+ * @screen:
+ * @process_name: (out) (transfer none) (allow-none): the basename of the program
+ * @cmdline: (out) (transfer none) (allow-none): the full command line
+ *
+ * Returns the foreground process as of the last check, without looking at
+ * the PTY or reading anything. @process_name and @cmdline are set to
+ * %nullptr if they could not be read.
+ *
+ * Returns: the process ID of the foreground process, or -1 if there is none
+ */
+int
+terminal_screen_get_foreground_process (TerminalScreen *screen,
+                                        const char **process_name,
+                                        const char **cmdline)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+  const char *name = nullptr, *command = nullptr;
+  int fgpid = -1;
+
+  g_return_val_if_fail (TERMINAL_IS_SCREEN (screen), -1);
+
+  if (priv->fg_process_value != nullptr)
+    g_variant_get (priv->fg_process_value, "(i&s&s)", &fgpid, &name, &command);
+
+  if (process_name)
+    *process_name = name && name[0] ? name : nullptr;
+  if (cmdline)
+    *cmdline = command && command[0] ? command : nullptr;
+
+  return fgpid;
+}
+
 const char *
 terminal_screen_get_uuid (TerminalScreen *screen)
 {
@@ -3058,6 +3835,105 @@ terminal_screen_paste_text (TerminalScreen* screen,
   vte_terminal_paste_text (VTE_TERMINAL (screen), text);
 }
 
+/* Applies the profile's scrollback length, limited by the governor's cap */
+static void
+terminal_screen_update_scrollback_lines (TerminalScreen *screen)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+
+  if (priv->profile_snapshot == nullptr)
+    return;
+
+  glong lines = priv->profile_snapshot->scrollback_lines;
+  if (priv->scrollback_cap >= 0 && (lines < 0 || lines > priv->scrollback_cap))
+    lines = priv->scrollback_cap;
+
+  vte_terminal_set_scrollback_lines (VTE_TERMINAL (screen), lines);
+}
+
+static void
+terminal_screen_has_focus_notify_cb (GObject *object,
+                                     GParamSpec *pspec,
+                                     TerminalScreen *screen)
+{
+  TerminalScreenPrivate *priv = screen->priv;
+
+  if (!gtk_widget_has_focus (GTK_WIDGET (screen)))
+    return;
+
+  priv->last_focus_time = g_get_monotonic_time ();
+
+  /* Being in use again, let it grow back to the profile's length; the
+   * governor shrinks the other terminals first now.
+   */
+  if (priv->scrollback_cap >= 0)
+    terminal_screen_set_scrollback_cap (screen, -1);
+}
+
+/**
+ * terminal_screen_get_scrollback_rows:
+ * @screen:
+ *
+ * Returns: the number of rows currently in the scrollback of @screen,
+ *   not counting the visible ones
+ */
+glong
+terminal_screen_get_scrollback_rows (TerminalScreen *screen)
+{
+  g_return_val_if_fail (TERMINAL_IS_SCREEN (screen), 0);
+
+  VteTerminal *terminal = VTE_TERMINAL (screen);
+  GtkAdjustment *adjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (screen));
+  glong char_height = vte_terminal_get_char_height (terminal);
+  if (adjustment == nullptr || char_height <= 0)
+    return 0;
+
+  /* The adjustment is in pixels, see terminal_screen_init() */
+  glong rows = glong (gtk_adjustment_get_upper (adjustment) -
+                      gtk_adjustment_get_lower (adjustment)) / char_height;
+  return MAX (rows - vte_terminal_get_row_count (terminal), 0);
+}
+
+/**
+ * terminal_screen_set_scrollback_cap:
+ * @screen:
+ * @lines: the maximum number of scrollback lines, or -1 to use the profile's
+ *
+ * Limits the scrollback of @screen to at most @lines lines, discarding
+ * the oldest lines beyond that, until the limit is lifted again.
+ */
+void
+terminal_screen_set_scrollback_cap (TerminalScreen *screen,
+                                    glong lines)
+{
+  g_return_if_fail (TERMINAL_IS_SCREEN (screen));
+
+  TerminalScreenPrivate *priv = screen->priv;
+  if (priv->scrollback_cap == lines)
+    return;
+
+  _terminal_debug_print (TERMINAL_DEBUG_SERVER,
+                         "[screen %p] scrollback cap %ld -> %ld\n",
+                         screen, priv->scrollback_cap, lines);
+
+  priv->scrollback_cap = lines;
+  terminal_screen_update_scrollback_lines (screen);
+}
+
+/**
+ * terminal_screen_get_last_focus_time:
+ * @screen:
+ *
+ * Returns: the monotonic time @screen last got the focus, or was created
+ */
+gint64
+terminal_screen_get_last_focus_time (TerminalScreen *screen)
+{
+  g_return_val_if_fail (TERMINAL_IS_SCREEN (screen), 0);
+
+  return screen->priv->last_focus_time;
+}
+
 gboolean
 terminal_screen_is_active (TerminalScreen *screen)
 {
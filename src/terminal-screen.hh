@@ -97,6 +97,23 @@ gboolean terminal_screen_exec (TerminalScreen *screen,
                                GError **error);
 
 
+char **terminal_screen_get_base_child_environment (void);
+
+char **terminal_screen_get_child_environment (const char *screen_object_path,
+                                              char **initial_envv,
+                                              char **path,
+                                              char **shell);
+
+gboolean terminal_screen_get_child_command (GSettings      *profile,
+                                            char          **argv,
+                                            const char     *path_env,
+                                            const char     *shell_env,
+                                            gboolean        as_shell,
+                                            gboolean       *preserve_cwd_p,
+                                            GSpawnFlags    *spawn_flags_p,
+                                            char         ***exec_argv_p,
+                                            GError        **err);
+
 gboolean terminal_screen_reexec (TerminalScreen *screen,
                                  char **envv,
                                  const char *cwd,
@@ -132,8 +149,33 @@ gboolean terminal_screen_has_foreground_process (TerminalScreen *screen,
                                                  char           **process_name,
                                                  char           **cmdline);
 
+void terminal_screen_query_foreground_process_async (TerminalScreen *screen,
+                                                     GCancellable *cancellable,
+                                                     GAsyncReadyCallback callback,
+                                                     gpointer user_data);
+
+gboolean terminal_screen_query_foreground_process_finish (TerminalScreen *screen,
+                                                          GAsyncResult *result,
+                                                          char **process_name,
+                                                          char **cmdline,
+                                                          GError **error);
+
+int terminal_screen_get_foreground_process (TerminalScreen *screen,
+                                            const char **process_name,
+                                            const char **cmdline);
+
 gboolean terminal_screen_is_active (TerminalScreen *screen);
 
+void terminal_screen_set_background (TerminalScreen *screen,
+                                     gboolean background);
+
+glong terminal_screen_get_scrollback_rows (TerminalScreen *screen);
+
+void terminal_screen_set_scrollback_cap (TerminalScreen *screen,
+                                         glong lines);
+
+gint64 terminal_screen_get_last_focus_time (TerminalScreen *screen);
+
 GIcon* terminal_screen_get_icon(TerminalScreen* screen);
 
 GIcon* terminal_screen_get_icon_progress(TerminalScreen* screen);
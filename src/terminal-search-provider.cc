@@ -22,16 +22,36 @@
 #include "terminal-app.hh"
 #include "terminal-debug.hh"
 #include "terminal-libgsystem.hh"
-#include "terminal-tab.hh"
 #include "terminal-search-provider.hh"
 #include "terminal-search-provider-gdbus-generated.h"
 #include "terminal-window.hh"
 
+enum {
+  SEARCH_KEY_CWD,
+  SEARCH_KEY_TITLE,
+  SEARCH_KEY_PROCESS,
+  SEARCH_KEY_CMDLINE,
+  N_SEARCH_KEYS
+};
+
+/* The normalized search keys of one screen, and the trigrams in them */
+typedef struct {
+  TerminalSearchProvider *provider;
+  TerminalScreen *screen;
+  char *keys[N_SEARCH_KEYS];
+  GHashTable *trigrams;
+} SearchEntry;
+
 struct _TerminalSearchProvider
 {
   GObject parent;
 
   TerminalSearchProvider2 *skeleton;
+
+  /* TerminalScreen* -> SearchEntry* */
+  GHashTable *entries;
+  /* trigram -> set of SearchEntry* whose keys contain it */
+  GHashTable *trigram_index;
 };
 
 struct _TerminalSearchProviderClass
@@ -74,125 +94,273 @@ normalize_casefold_and_unaccent_terms (const char* const *terms)
   return casefolded_terms;
 }
 
-static gboolean
-match_terms (const char        *str,
-             const char* const *terms)
+static gpointer
+trigram_at (const char *str)
 {
-  gs_free char *casefolded_str = nullptr;
-  gboolean matches = TRUE;
-  guint i;
+  return GUINT_TO_POINTER ((guint8) str[0] << 16 | (guint8) str[1] << 8 | (guint8) str[2]);
+}
 
-  if (str == nullptr)
+static void
+search_entry_unindex (SearchEntry *entry)
+{
+  TerminalSearchProvider *provider = entry->provider;
+  GHashTableIter iter;
+  gpointer trigram;
+
+  g_hash_table_iter_init (&iter, entry->trigrams);
+  while (g_hash_table_iter_next (&iter, &trigram, nullptr))
     {
-      matches = FALSE;
-      goto out;
+      GHashTable *posting = (GHashTable *) g_hash_table_lookup (provider->trigram_index, trigram);
+      if (posting == nullptr)
+        continue;
+
+      g_hash_table_remove (posting, entry);
+      if (g_hash_table_size (posting) == 0)
+        g_hash_table_remove (provider->trigram_index, trigram);
     }
 
-  casefolded_str = normalize_casefold_and_unaccent (str);
-  for (i = 0; terms[i] != nullptr; i++)
+  g_hash_table_remove_all (entry->trigrams);
+}
+
+static void
+search_entry_index (SearchEntry *entry)
+{
+  TerminalSearchProvider *provider = entry->provider;
+  guint i;
+
+  for (i = 0; i < N_SEARCH_KEYS; i++)
     {
-      if (strstr (casefolded_str, terms[i]) == nullptr)
+      const char *key = entry->keys[i];
+      gsize j, len;
+
+      if (key == nullptr)
+        continue;
+
+      len = strlen (key);
+      for (j = 0; j + 3 <= len; j++)
         {
-          matches = FALSE;
-          break;
+          gpointer trigram = trigram_at (key + j);
+          GHashTable *posting;
+
+          if (!g_hash_table_add (entry->trigrams, trigram))
+            continue;
+
+          posting = (GHashTable *) g_hash_table_lookup (provider->trigram_index, trigram);
+          if (posting == nullptr)
+            {
+              posting = g_hash_table_new (nullptr, nullptr);
+              g_hash_table_insert (provider->trigram_index, trigram, posting);
+            }
+          g_hash_table_add (posting, entry);
         }
     }
+}
 
- out:
-  return matches;
+static void
+search_entry_set_keys (SearchEntry *entry,
+                       guint        first_key,
+                       const char  *values[],
+                       guint        n_values)
+{
+  gboolean changed = FALSE;
+  guint i;
+
+  for (i = 0; i < n_values; i++)
+    {
+      gs_free char *key = normalize_casefold_and_unaccent (values[i]);
+
+      if (g_strcmp0 (key, entry->keys[first_key + i]) == 0)
+        continue;
+
+      if (!changed)
+        search_entry_unindex (entry);
+      changed = TRUE;
+
+      g_free (entry->keys[first_key + i]);
+      entry->keys[first_key + i] = (char *) g_steal_pointer (&key);
+    }
+
+  if (changed)
+    search_entry_index (entry);
 }
 
-static gboolean
-handle_get_initial_result_set_cb (TerminalSearchProvider2  *skeleton,
-                                  GDBusMethodInvocation    *invocation,
-                                  const char *const        *terms,
-                                  gpointer                  user_data)
+static void
+search_entry_update_title (SearchEntry *entry)
 {
-  GList *l, *screens = nullptr, *windows;
-  gs_unref_ptrarray GPtrArray *results;
-  TerminalApp *app;
-  gs_strfreev char **casefolded_terms = nullptr;
+  const char *values[] = { terminal_screen_get_title (entry->screen) };
 
-  _terminal_debug_print (TERMINAL_DEBUG_SEARCH, "GetInitialResultSet started\n");
+  search_entry_set_keys (entry, SEARCH_KEY_TITLE, values, G_N_ELEMENTS (values));
+}
 
-  app = terminal_app_get ();
-  windows = gtk_application_get_windows (GTK_APPLICATION (app));
-  for (l = windows; l != nullptr; l = l->next)
+static void
+search_entry_update_cwd (SearchEntry *entry)
+{
+  const char *values[] = { vte_terminal_get_current_directory_uri (VTE_TERMINAL (entry->screen)) };
+
+  search_entry_set_keys (entry, SEARCH_KEY_CWD, values, G_N_ELEMENTS (values));
+}
+
+static void
+search_entry_update_process (SearchEntry *entry)
+{
+  const char *values[2] = { nullptr, nullptr };
+
+  terminal_screen_get_foreground_process (entry->screen, &values[0], &values[1]);
+  search_entry_set_keys (entry, SEARCH_KEY_PROCESS, values, G_N_ELEMENTS (values));
+}
+
+static gboolean
+search_entry_matches (SearchEntry       *entry,
+                      const char* const *terms)
+{
+  guint i, j;
+
+  for (i = 0; i < N_SEARCH_KEYS; i++)
     {
-      TerminalWindow *window = (TerminalWindow*)(l->data);
+      const char *key = entry->keys[i];
 
-      if (!TERMINAL_IS_WINDOW (l->data))
+      if (key == nullptr)
         continue;
 
-      auto tabs = terminal_window_list_tabs (window);
-      for (auto t = tabs; t != nullptr; t = t->next)
+      for (j = 0; terms[j] != nullptr; j++)
+        {
+          if (strstr (key, terms[j]) == nullptr)
+            break;
+        }
+
+      if (terms[j] == nullptr)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+screen_title_notify_cb (TerminalScreen *screen,
+                        GParamSpec     *pspec,
+                        SearchEntry    *entry)
+{
+  search_entry_update_title (entry);
+}
+
+static void
+screen_cwd_changed_cb (VteTerminal *terminal,
+                       const char  *prop,
+                       SearchEntry *entry)
+{
+  search_entry_update_cwd (entry);
+}
+
+static void
+screen_foreground_process_notify_cb (TerminalScreen *screen,
+                                     GParamSpec     *pspec,
+                                     SearchEntry    *entry)
+{
+  search_entry_update_process (entry);
+}
+
+static void
+search_entry_free (SearchEntry *entry)
+{
+  g_signal_handlers_disconnect_by_data (entry->screen, entry);
+
+  search_entry_unindex (entry);
+  g_hash_table_unref (entry->trigrams);
+
+  for (guint i = 0; i < N_SEARCH_KEYS; i++)
+    g_free (entry->keys[i]);
+
+  g_free (entry);
+}
+
+/*
+ * terminal_search_provider_find_candidates:
+ *
+ * Returns: (transfer container): the set of entries that may match @terms,
+ *   or %nullptr if all of them may
+ */
+static GHashTable *
+terminal_search_provider_find_candidates (TerminalSearchProvider *provider,
+                                          const char* const      *terms)
+{
+  GHashTable *candidates = nullptr;
+  guint i;
+
+  /* Any term of at least three characters must have all its trigrams in
+   * a matching key, so the smallest posting of any of them is a superset
+   * of the matches.
+   */
+  for (i = 0; terms[i] != nullptr; i++)
+    {
+      gsize j, len = strlen (terms[i]);
+
+      for (j = 0; j + 3 <= len; j++)
         {
-          TerminalTab *tab = TERMINAL_TAB (t->data);
-          TerminalScreen *screen;
+          GHashTable *posting;
 
-          screen = terminal_tab_get_screen (tab);
-          screens = g_list_prepend (screens, screen);
+          posting = (GHashTable *) g_hash_table_lookup (provider->trigram_index,
+                                                        trigram_at (terms[i] + j));
+          if (posting == nullptr)
+            return g_hash_table_new (nullptr, nullptr);
+
+          if (candidates == nullptr ||
+              g_hash_table_size (posting) < g_hash_table_size (candidates))
+            candidates = posting;
         }
     }
 
-  casefolded_terms = normalize_casefold_and_unaccent_terms (terms);
+  return candidates ? g_hash_table_ref (candidates) : nullptr;
+}
+
+static GPtrArray *
+terminal_search_provider_get_initial_result_set (TerminalSearchProvider *provider,
+                                                 const char* const      *terms)
+{
+  GPtrArray *results;
+  GHashTable *candidates;
+  GHashTableIter iter;
+  gpointer entry;
+
   results = g_ptr_array_new_with_free_func (g_free);
 
-  for (l = screens; l != nullptr; l = l->next)
+  /* The values of both tables are the entries */
+  candidates = terminal_search_provider_find_candidates (provider, terms);
+  g_hash_table_iter_init (&iter, candidates != nullptr ? candidates : provider->entries);
+  while (g_hash_table_iter_next (&iter, nullptr, &entry))
     {
-      TerminalScreen *screen = TERMINAL_SCREEN (l->data);
-      gs_free char *cmdline = nullptr, *process = nullptr;
-      const char *cwd, *title;
-
-      cwd = vte_terminal_get_current_directory_uri (VTE_TERMINAL (screen));
-      title = terminal_screen_get_title (screen);
-      terminal_screen_has_foreground_process (screen, &process, &cmdline);
-      if (match_terms (cwd, (const char *const *) casefolded_terms) ||
-          match_terms (title, (const char *const *) casefolded_terms) ||
-          match_terms (process, (const char *const *) casefolded_terms) ||
-          match_terms (cmdline, (const char *const *) casefolded_terms))
+      if (search_entry_matches ((SearchEntry *) entry, terms))
         {
           const char *uuid;
 
-          uuid = terminal_screen_get_uuid (screen);
+          uuid = terminal_screen_get_uuid (((SearchEntry *) entry)->screen);
           g_ptr_array_add (results, g_strdup (uuid));
 
           _terminal_debug_print (TERMINAL_DEBUG_SEARCH, "Search hit: %s\n", uuid);
         }
     }
 
-  g_ptr_array_add (results, nullptr);
-  terminal_search_provider2_complete_get_initial_result_set (skeleton,
-                                                             invocation,
-                                                             (const char *const *) results->pdata);
+  if (candidates != nullptr)
+    g_hash_table_unref (candidates);
 
-  _terminal_debug_print (TERMINAL_DEBUG_SEARCH, "GetInitialResultSet completed\n");
-  return TRUE;
+  return results;
 }
 
-static gboolean
-handle_get_subsearch_result_set_cb (TerminalSearchProvider2  *skeleton,
-                                    GDBusMethodInvocation    *invocation,
-                                    const char *const        *previous_results,
-                                    const char *const        *terms,
-                                    gpointer                  user_data)
+static GPtrArray *
+terminal_search_provider_get_subsearch_result_set (TerminalSearchProvider *provider,
+                                                   const char* const      *previous_results,
+                                                   const char* const      *terms)
 {
-  gs_unref_ptrarray GPtrArray *results;
+  GPtrArray *results;
   TerminalApp *app;
-  gs_strfreev char **casefolded_terms = nullptr;
   guint i;
 
-  _terminal_debug_print (TERMINAL_DEBUG_SEARCH, "GetSubsearchResultSet started\n");
-
   app = terminal_app_get ();
-  casefolded_terms = normalize_casefold_and_unaccent_terms (terms);
   results = g_ptr_array_new_with_free_func (g_free);
 
   for (i = 0; previous_results[i] != nullptr; i++)
     {
       TerminalScreen *screen;
-      gs_free char *cmdline = nullptr, *process = nullptr;
-      const char *cwd, *title;
+      SearchEntry *entry;
 
       screen = terminal_app_get_screen_by_uuid (app, previous_results[i]);
       if (screen == nullptr)
@@ -201,25 +369,67 @@ handle_get_subsearch_result_set_cb (TerminalSearchProvider2  *skeleton,
           continue;
         }
 
-      cwd = vte_terminal_get_current_directory_uri (VTE_TERMINAL (screen));
-      title = terminal_screen_get_title (screen);
-      terminal_screen_has_foreground_process (screen, &process, &cmdline);
-      if (match_terms (cwd, (const char *const *) casefolded_terms) ||
-          match_terms (title, (const char *const *) casefolded_terms) ||
-          match_terms (process, (const char *const *) casefolded_terms) ||
-          match_terms (cmdline, (const char *const *) casefolded_terms))
+      entry = (SearchEntry *) g_hash_table_lookup (provider->entries, screen);
+      if (entry == nullptr)
+        continue;
+
+      if (search_entry_matches (entry, terms))
         {
           g_ptr_array_add (results, g_strdup (previous_results[i]));
           _terminal_debug_print (TERMINAL_DEBUG_SEARCH, "Search hit: %s\n", previous_results[i]);
         }
     }
 
+  return results;
+}
+
+static gboolean
+handle_get_initial_result_set_cb (TerminalSearchProvider2  *skeleton,
+                                  GDBusMethodInvocation    *invocation,
+                                  const char *const        *terms,
+                                  gpointer                  user_data)
+{
+  TerminalSearchProvider *provider = TERMINAL_SEARCH_PROVIDER (user_data);
+  gs_strfreev char **normalized_terms = nullptr;
+  gs_unref_ptrarray GPtrArray *results = nullptr;
+
+  _terminal_debug_print (TERMINAL_DEBUG_SEARCH, "GetInitialResultSet started\n");
+
+  normalized_terms = normalize_casefold_and_unaccent_terms (terms);
+  results = terminal_search_provider_get_initial_result_set (provider,
+                                                             (const char *const *) normalized_terms);
   g_ptr_array_add (results, nullptr);
-  terminal_search_provider2_complete_get_subsearch_result_set (skeleton,
-                                                               invocation,
+  terminal_search_provider2_complete_get_initial_result_set (skeleton, invocation,
+                                                             (const char *const *) results->pdata);
+
+  _terminal_debug_print (TERMINAL_DEBUG_SEARCH, "GetInitialResultSet completed\n");
+
+  return TRUE;
+}
+
+static gboolean
+handle_get_subsearch_result_set_cb (TerminalSearchProvider2  *skeleton,
+                                    GDBusMethodInvocation    *invocation,
+                                    const char *const        *previous_results,
+                                    const char *const        *terms,
+                                    gpointer                  user_data)
+{
+  TerminalSearchProvider *provider = TERMINAL_SEARCH_PROVIDER (user_data);
+  gs_strfreev char **normalized_terms = nullptr;
+  gs_unref_ptrarray GPtrArray *results = nullptr;
+
+  _terminal_debug_print (TERMINAL_DEBUG_SEARCH, "GetSubsearchResultSet started\n");
+
+  normalized_terms = normalize_casefold_and_unaccent_terms (terms);
+  results = terminal_search_provider_get_subsearch_result_set (provider,
+                                                               previous_results,
+                                                               (const char *const *) normalized_terms);
+  g_ptr_array_add (results, nullptr);
+  terminal_search_provider2_complete_get_subsearch_result_set (skeleton, invocation,
                                                                (const char *const *) results->pdata);
 
   _terminal_debug_print (TERMINAL_DEBUG_SEARCH, "GetSubsearchResultSet completed\n");
+
   return TRUE;
 }
 
@@ -253,7 +463,7 @@ handle_get_result_metas_cb (TerminalSearchProvider2  *skeleton,
         }
 
       title = terminal_screen_get_title (screen);
-      if (terminal_screen_has_foreground_process (screen, nullptr, nullptr)) {
+      if (terminal_screen_get_foreground_process (screen, nullptr, nullptr) != -1) {
         VteTerminal *terminal = VTE_TERMINAL (screen);
         long cursor_row;
 
@@ -322,6 +532,11 @@ terminal_search_provider_init (TerminalSearchProvider *provider)
 {
   provider->skeleton = terminal_search_provider2_skeleton_new ();
 
+  provider->entries = g_hash_table_new_full (nullptr, nullptr,
+                                             nullptr, (GDestroyNotify) search_entry_free);
+  provider->trigram_index = g_hash_table_new_full (nullptr, nullptr,
+                                                   nullptr, (GDestroyNotify) g_hash_table_unref);
+
   g_signal_connect (provider->skeleton, "handle-get-initial-result-set",
                     G_CALLBACK (handle_get_initial_result_set_cb), provider);
   g_signal_connect (provider->skeleton, "handle-get-subsearch-result-set",
@@ -339,15 +554,30 @@ terminal_search_provider_dispose (GObject *object)
 
   g_clear_object (&provider->skeleton);
 
+  if (provider->entries != nullptr)
+    g_hash_table_remove_all (provider->entries);
+
   G_OBJECT_CLASS (terminal_search_provider_parent_class)->dispose (object);
 }
 
+static void
+terminal_search_provider_finalize (GObject *object)
+{
+  TerminalSearchProvider *provider = TERMINAL_SEARCH_PROVIDER (object);
+
+  g_hash_table_unref (provider->entries);
+  g_hash_table_unref (provider->trigram_index);
+
+  G_OBJECT_CLASS (terminal_search_provider_parent_class)->finalize (object);
+}
+
 static void
 terminal_search_provider_class_init (TerminalSearchProviderClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   gobject_class->dispose = terminal_search_provider_dispose;
+  gobject_class->finalize = terminal_search_provider_finalize;
 }
 
 TerminalSearchProvider *
@@ -357,6 +587,55 @@ terminal_search_provider_new (void)
     (g_object_new (TERMINAL_TYPE_SEARCH_PROVIDER, nullptr));
 }
 
+/**
+ * terminal_search_provider_add_screen:
+ * @provider:
+ * @screen:
+ *
+ * Starts indexing @screen's title, current directory and foreground process
+ * for searching.
+ */
+void
+terminal_search_provider_add_screen (TerminalSearchProvider *provider,
+                                     TerminalScreen         *screen)
+{
+  SearchEntry *entry;
+
+  if (g_hash_table_contains (provider->entries, screen))
+    return;
+
+  entry = g_new0 (SearchEntry, 1);
+  entry->provider = provider;
+  entry->screen = screen;
+  entry->trigrams = g_hash_table_new (nullptr, nullptr);
+  g_hash_table_insert (provider->entries, screen, entry);
+
+  g_signal_connect (screen, "notify::title",
+                    G_CALLBACK (screen_title_notify_cb), entry);
+  g_signal_connect (screen, "termprop-changed::" VTE_TERMPROP_CURRENT_DIRECTORY_URI,
+                    G_CALLBACK (screen_cwd_changed_cb), entry);
+  g_signal_connect (screen, "notify::foreground-process",
+                    G_CALLBACK (screen_foreground_process_notify_cb), entry);
+
+  search_entry_update_title (entry);
+  search_entry_update_cwd (entry);
+  search_entry_update_process (entry);
+}
+
+/**
+ * terminal_search_provider_remove_screen:
+ * @provider:
+ * @screen:
+ *
+ * Stops indexing @screen.
+ */
+void
+terminal_search_provider_remove_screen (TerminalSearchProvider *provider,
+                                        TerminalScreen         *screen)
+{
+  g_hash_table_remove (provider->entries, screen);
+}
+
 gboolean
 terminal_search_provider_dbus_register (TerminalSearchProvider  *provider,
                                         GDBusConnection         *connection,
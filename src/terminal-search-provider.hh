@@ -21,6 +21,8 @@
 #include <glib-object.h>
 #include <gio/gio.h>
 
+#include "terminal-screen.hh"
+
 G_BEGIN_DECLS
 
 #define TERMINAL_TYPE_SEARCH_PROVIDER              (terminal_search_provider_get_type ())
@@ -37,6 +39,12 @@ GType terminal_search_provider_get_type (void);
 
 TerminalSearchProvider *terminal_search_provider_new (void);
 
+void terminal_search_provider_add_screen (TerminalSearchProvider *provider,
+                                          TerminalScreen         *screen);
+
+void terminal_search_provider_remove_screen (TerminalSearchProvider *provider,
+                                             TerminalScreen         *screen);
+
 gboolean terminal_search_provider_dbus_register (TerminalSearchProvider  *provider,
                                                  GDBusConnection         *connection,
                                                  const char              *object_path,
@@ -19,8 +19,10 @@
 #define G_SETTINGS_ENABLE_BACKEND
 
 #include <cassert>
+#include <cstring>
 
 #include "terminal-debug.hh"
+#include "terminal-defines.hh"
 #include "terminal-libgsystem.hh"
 #include "terminal-settings-bridge-backend.hh"
 #include "terminal-settings-utils.hh"
@@ -36,6 +38,10 @@ struct _TerminalSettingsBridgeBackend {
   GCancellable* cancellable;
 
   GHashTable* cache;
+  // Set of path prefixes that read_tree was called for
+  GHashTable* prefetched;
+  // path -> number of subscriptions
+  GHashTable* subscribed;
 };
 
 struct _TerminalSettingsBridgeBackendClass {
@@ -89,6 +95,9 @@ typedef struct {
   bool value_set;
   bool writable;
   bool writable_set;
+  // Number of writes and resets of this key whose "changed" echo
+  // hasn't come back from the server yet
+  unsigned pending_writes;
 } CacheEntry;
 
 static auto
@@ -116,8 +125,12 @@ static auto
 cache_ensure_entry(TerminalSettingsBridgeBackend* impl,
                    char const* key) noexcept
 {
-  g_hash_table_insert(impl->cache, g_strdup(key), cache_entry_new());
-  return cache_lookup_entry(impl, key);
+  auto ce = cache_lookup_entry(impl, key);
+  if (!ce) {
+    ce = cache_entry_new();
+    g_hash_table_insert(impl->cache, g_strdup(key), ce);
+  }
+  return ce;
 }
 
 static void
@@ -176,6 +189,170 @@ cache_remove_writable(TerminalSettingsBridgeBackend* impl,
   ce->writable_set = false;
 }
 
+/*
+ * cache_prefetch_path:
+ * @impl:
+ * @key: a key that is not cached
+ *
+ * Reads the values and writability of all keys in @key's directory in one
+ * call, the first time a key in it is not found in the cache. Keys that
+ * are already cached are not overwritten, since the cache may hold writes
+ * that haven't reached the remote backend yet.
+ *
+ * Only subscribed directories are prefetched, since the bridge only sends
+ * changes for those; the prefetched values would go stale otherwise.
+ */
+static void
+cache_prefetch_path(TerminalSettingsBridgeBackend* impl,
+                    char const* key) noexcept
+{
+  auto const slash = strrchr(key, '/');
+  if (!slash)
+    return;
+
+  gs_free auto path_prefix = g_strndup(key, slash - key + 1);
+  if (g_hash_table_contains(impl->prefetched, path_prefix) ||
+      !g_hash_table_contains(impl->subscribed, path_prefix))
+    return;
+
+  g_hash_table_add(impl->prefetched, g_strdup(path_prefix));
+
+  gs_unref_variant GVariant* rv = nullptr;
+  auto const r =
+    terminal_settings_bridge_call_read_tree_sync(impl->bridge,
+                                                 path_prefix,
+                                                 &rv,
+                                                 impl->cancellable,
+                                                 nullptr);
+
+  gs_unref_variant auto tree_value = r ? terminal_g_variant_unwrap(rv) : nullptr;
+  if (!tree_value ||
+      !g_variant_is_of_type(tree_value, G_VARIANT_TYPE("a(smvb)"))) {
+    _terminal_debug_print(TERMINAL_DEBUG_BRIDGE,
+                          "Bridge backend read_tree path-prefix %s success %d type %s\n",
+                          path_prefix, r,
+                          tree_value ? g_variant_get_type_string(tree_value) : "(null)");
+    return;
+  }
+
+  auto iter = GVariantIter{};
+  g_variant_iter_init(&iter, tree_value);
+
+  char const* name = nullptr;
+  GVariant* value = nullptr;
+  gboolean writable = false;
+  while (g_variant_iter_loop(&iter, "(&smvb)", &name, &value, &writable)) {
+    gs_free auto wkey = g_strconcat(path_prefix, name, nullptr);
+    auto const ce = cache_ensure_entry(impl, wkey);
+
+    if (!ce->value_set) {
+      ce->value = value ? g_variant_get_variant(value) : nullptr;
+      ce->value_set = true;
+    }
+    if (!ce->writable_set) {
+      ce->writable = writable;
+      ce->writable_set = true;
+    }
+  }
+
+  _terminal_debug_print(TERMINAL_DEBUG_BRIDGE,
+                        "Bridge backend read_tree path-prefix %s n-keys %" G_GSIZE_FORMAT "\n",
+                        path_prefix, g_variant_n_children(tree_value));
+}
+
+/*
+ * pending_write_begin:
+ * @impl:
+ * @key: a key that is about to be written or reset
+ *
+ * The server sends a "changed" signal for each write to a subscribed
+ * directory, including the ones made from here. Count the write so that
+ * bridge_changed_cb() can drop its echo, which may arrive after later
+ * writes of the same key and then carry an older value.
+ *
+ * Returns: whether an echo is expected for the write
+ */
+static bool
+pending_write_begin(TerminalSettingsBridgeBackend* impl,
+                    char const* key) noexcept
+{
+  auto const slash = strrchr(key, '/');
+  if (!slash)
+    return false;
+
+  gs_free auto path_prefix = g_strndup(key, slash - key + 1);
+  if (!g_hash_table_contains(impl->subscribed, path_prefix))
+    return false;
+
+  ++cache_ensure_entry(impl, key)->pending_writes;
+  return true;
+}
+
+/*
+ * pending_write_cancel:
+ * @impl:
+ * @key: the key passed to pending_write_begin()
+ *
+ * Forgets a counted write that failed, since the server won't send
+ * an echo for it.
+ */
+static void
+pending_write_cancel(TerminalSettingsBridgeBackend* impl,
+                     char const* key) noexcept
+{
+  auto const ce = cache_lookup_entry(impl, key);
+  if (ce && ce->pending_writes > 0)
+    --ce->pending_writes;
+}
+
+static void
+bridge_changed_cb(TerminalSettingsBridge* bridge,
+                  char const* const* keys,
+                  GVariant* values,
+                  TerminalSettingsBridgeBackend* impl) noexcept
+{
+  gs_unref_variant auto values_value = terminal_g_variant_unwrap(values);
+  if (!values_value ||
+      !g_variant_is_of_type(values_value, G_VARIANT_TYPE("amv")) ||
+      g_variant_n_children(values_value) != g_strv_length((char**)keys)) {
+    _terminal_debug_print(TERMINAL_DEBUG_BRIDGE,
+                          "Bridge backend changed got type %s expected type amv\n",
+                          values_value ? g_variant_get_type_string(values_value) : "(null)");
+    return;
+  }
+
+  for (auto i = 0; keys[i]; ++i) {
+    gs_unref_variant auto maybe = g_variant_get_child_value(values_value, i);
+    gs_unref_variant auto boxed = g_variant_get_maybe(maybe);
+    gs_unref_variant auto value = boxed ? g_variant_get_variant(boxed) : nullptr;
+
+    // Changes that were written from here come back too; skip those.
+    // Each echo acknowledges one pending write, in order, so this also
+    // skips late echoes of older values.
+    auto const ce = cache_lookup_entry(impl, keys[i]);
+    if (ce && ce->pending_writes > 0) {
+      --ce->pending_writes;
+
+      _terminal_debug_print(TERMINAL_DEBUG_BRIDGE,
+                            "Bridge backend changed key %s skipping echo, %u pending\n",
+                            keys[i], ce->pending_writes);
+      continue;
+    }
+
+    if (ce && ce->value_set &&
+        (ce->value == value ||
+         (ce->value && value && g_variant_equal(ce->value, value))))
+      continue;
+
+    cache_insert_value(impl, keys[i], value);
+    g_settings_backend_changed(G_SETTINGS_BACKEND(impl), keys[i], nullptr);
+
+    _terminal_debug_print(TERMINAL_DEBUG_BRIDGE,
+                          "Bridge backend changed key %s value %s\n",
+                          keys[i], value ? g_variant_print(value, true) : "(null)");
+  }
+}
+
 /* GSettingsBackend class implementation */
 
 static GPermission*
@@ -194,7 +371,12 @@ terminal_settings_bridge_backend_get_writable(GSettingsBackend* backend,
 {
   auto const impl = IMPL(backend);
 
-  auto const ce = cache_lookup_entry(impl, key);
+  auto ce = cache_lookup_entry(impl, key);
+  if (ce && ce->writable_set)
+    return ce->writable;
+
+  cache_prefetch_path(impl, key);
+  ce = cache_lookup_entry(impl, key);
   if (ce && ce->writable_set)
     return ce->writable;
 
@@ -228,7 +410,12 @@ terminal_settings_bridge_backend_read(GSettingsBackend* backend,
     return nullptr;
 
   auto const impl = IMPL(backend);
-  auto const ce = cache_lookup_entry(impl, key);
+  auto ce = cache_lookup_entry(impl, key);
+  if (ce && ce->value_set)
+    return ce->value ? g_variant_ref(ce->value) : nullptr;
+
+  cache_prefetch_path(impl, key);
+  ce = cache_lookup_entry(impl, key);
   if (ce && ce->value_set)
     return ce->value ? g_variant_ref(ce->value) : nullptr;
 
@@ -274,7 +461,12 @@ terminal_settings_bridge_backend_read_user_value(GSettingsBackend* backend,
 {
   auto const impl = IMPL(backend);
 
-  auto const ce = cache_lookup_entry(impl, key);
+  auto ce = cache_lookup_entry(impl, key);
+  if (ce && ce->value_set)
+    return ce->value ? g_variant_ref(ce->value) : nullptr;
+
+  cache_prefetch_path(impl, key);
+  ce = cache_lookup_entry(impl, key);
   if (ce && ce->value_set)
     return ce->value ? g_variant_ref(ce->value) : nullptr;
 
@@ -318,11 +510,14 @@ terminal_settings_bridge_backend_reset(GSettingsBackend* backend,
                                        void* tag) noexcept
 {
   auto const impl = IMPL(backend);
+  auto const pending = pending_write_begin(impl, key);
   auto const r =
     terminal_settings_bridge_call_reset_sync(impl->bridge,
                                              key,
                                              impl->cancellable,
                                              nullptr);
+  if (pending && !r)
+    pending_write_cancel(impl, key);
 
   cache_remove_value(impl, key);
 
@@ -355,6 +550,9 @@ terminal_settings_bridge_backend_subscribe(GSettingsBackend* backend,
                                                impl->cancellable,
                                                nullptr);
 
+  auto const n = GPOINTER_TO_UINT(g_hash_table_lookup(impl->subscribed, name));
+  g_hash_table_replace(impl->subscribed, g_strdup(name), GUINT_TO_POINTER(n + 1));
+
   _terminal_debug_print(TERMINAL_DEBUG_BRIDGE,
                         "Bridge backend ::subscribe name %s\n", name);
 }
@@ -369,6 +567,17 @@ terminal_settings_bridge_backend_unsubscribe(GSettingsBackend* backend,
                                                  impl->cancellable,
                                                  nullptr);
 
+  // Without changes coming in for it, the path's cached values may go
+  // stale, so forget them and prefetch again on the next subscription
+  auto const n = GPOINTER_TO_UINT(g_hash_table_lookup(impl->subscribed, name));
+  if (n > 1) {
+    g_hash_table_replace(impl->subscribed, g_strdup(name), GUINT_TO_POINTER(n - 1));
+  } else {
+    g_hash_table_remove(impl->subscribed, name);
+    if (g_hash_table_remove(impl->prefetched, name))
+      cache_remove_path(impl, name);
+  }
+
   _terminal_debug_print(TERMINAL_DEBUG_BRIDGE,
                         "Bridge backend ::unsubscribe name %s\n", name);
 }
@@ -383,6 +592,7 @@ terminal_settings_bridge_backend_write(GSettingsBackend* backend,
 
   gs_unref_variant auto holder = g_variant_ref_sink(value);
 
+  auto const pending = pending_write_begin(impl, key);
   auto success = gboolean{false};
   auto const r =
     terminal_settings_bridge_call_write_sync(impl->bridge,
@@ -391,6 +601,8 @@ terminal_settings_bridge_backend_write(GSettingsBackend* backend,
                                              &success,
                                              impl->cancellable,
                                              nullptr);
+  if (pending && !(r && success))
+    pending_write_cancel(impl, key);
 
   cache_insert_value(impl, key, value);
 
@@ -418,6 +630,7 @@ terminal_settings_bridge_backend_write_tree(GSettingsBackend* backend,
                                   &keys,
                                   &values);
 
+  gs_unref_ptrarray auto pending = g_ptr_array_new_with_free_func(g_free);
   auto builder = GVariantBuilder{};
   g_variant_builder_init(&builder, G_VARIANT_TYPE("a(smv)"));
   for (auto i = 0; keys[i]; ++i) {
@@ -435,6 +648,8 @@ terminal_settings_bridge_backend_write_tree(GSettingsBackend* backend,
       cache_remove_path(impl, wkey);
     } else {
       cache_insert_value(impl, wkey, value);
+      if (pending_write_begin(impl, wkey))
+        g_ptr_array_add(pending, g_steal_pointer(&wkey));
     }
   }
 
@@ -448,6 +663,10 @@ terminal_settings_bridge_backend_write_tree(GSettingsBackend* backend,
                                                   &success,
                                                   impl->cancellable,
                                                   nullptr);
+  if (!(r && success)) {
+    for (auto i = 0u; i < pending->len; ++i)
+      pending_write_cancel(impl, reinterpret_cast<char const*>(g_ptr_array_index(pending, i)));
+  }
 
   g_settings_backend_changed_tree(backend, tree, tag);
 
@@ -466,15 +685,23 @@ terminal_settings_bridge_backend_init(TerminalSettingsBridgeBackend* backend) /*
   auto const impl = IMPL(backend);
 
   // Note that unfortunately it appears to be impossible to receive all
-  // change notifications from a GSettingsBackend directly, so we cannot
-  // get forwarded change notifications from the bridge. Instead, we have
-  // to cache written values (since the actual write happens delayed in
-  // the remote backend and the next read may still return the old value
-  // otherwise).
+  // change notifications from a GSettingsBackend directly, so the bridge
+  // only forwards changes for the subscribed paths with a known schema,
+  // via its "changed" signal. We also have to cache written values
+  // (since the actual write happens delayed in the remote backend and
+  // the next read may still return the old value otherwise).
   impl->cache = g_hash_table_new_full(g_str_hash,
                                       g_str_equal,
                                       g_free,
                                       GDestroyNotify(cache_entry_free));
+  impl->prefetched = g_hash_table_new_full(g_str_hash,
+                                           g_str_equal,
+                                           g_free,
+                                           nullptr);
+  impl->subscribed = g_hash_table_new_full(g_str_hash,
+                                           g_str_equal,
+                                           g_free,
+                                           nullptr);
 }
 
 static void
@@ -484,13 +711,22 @@ terminal_settings_bridge_backend_constructed(GObject* object) noexcept
 
   auto const impl = IMPL(object);
   assert(impl->bridge);
+
+  g_signal_connect(impl->bridge, "changed",
+                   G_CALLBACK(bridge_changed_cb), impl);
 }
 
 static void
 terminal_settings_bridge_backend_finalize(GObject* object) noexcept
 {
   auto const impl = IMPL(object);
+  if (impl->bridge)
+    g_signal_handlers_disconnect_by_func(impl->bridge,
+                                         (void*)bridge_changed_cb,
+                                         impl);
   g_clear_pointer(&impl->cache, g_hash_table_unref);
+  g_clear_pointer(&impl->prefetched, g_hash_table_unref);
+  g_clear_pointer(&impl->subscribed, g_hash_table_unref);
   g_clear_object(&impl->cancellable);
   g_clear_object(&impl->bridge);
 
@@ -561,3 +797,291 @@ terminal_settings_bridge_backend_new(TerminalSettingsBridge* bridge)
 		   "settings-bridge", bridge,
 		   nullptr));
 }
+
+/**
+ *  terminal_settings_bridge_backend_new_proxy:
+ *  @connection: the peer-to-peer #GDBusConnection to the server
+ *  @error: a #GError location
+ *
+ *  Returns: (transfer full): a new #TerminalSettingsBridge proxy for the
+ *    server's settings bridge on @connection, or %nullptr with @error filled in
+ */
+TerminalSettingsBridge*
+terminal_settings_bridge_backend_new_proxy(GDBusConnection* connection,
+                                           GError** error)
+{
+  // The backend keeps its cache up to date from the "changed" signal,
+  // so the proxy must connect signals.
+  return terminal_settings_bridge_proxy_new_sync
+    (connection,
+     GDBusProxyFlags(G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START |
+                     G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START_AT_CONSTRUCTION |
+                     G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES),
+     nullptr, // no name
+     TERMINAL_SETTINGS_BRIDGE_OBJECT_PATH,
+     nullptr, // cancellable
+     error);
+}
+
+#ifdef TERMINAL_SETTINGS_BRIDGE_BACKEND_MAIN
+
+#include <sys/socket.h>
+
+#define TEST_PATH "/org/gnome/terminal/legacy/"
+#define TEST_KEY TEST_PATH "theme-variant"
+
+static void
+connection_new_cb(GObject* source,
+                  GAsyncResult* result,
+                  void* user_data)
+{
+  gs_free_error GError* error = nullptr;
+  *reinterpret_cast<GDBusConnection**>(user_data) = g_dbus_connection_new_finish(result, &error);
+  g_assert_no_error(error);
+}
+
+static GIOStream*
+socket_stream_new(int fd)
+{
+  gs_free_error GError* error = nullptr;
+  gs_unref_object auto socket = g_socket_new_from_fd(fd, &error);
+  g_assert_no_error(error);
+
+  return G_IO_STREAM(g_socket_connection_factory_create_connection(socket));
+}
+
+static gboolean
+authorize_method_cb(GDBusInterfaceSkeleton* skeleton,
+                    GDBusMethodInvocation* invocation,
+                    unsigned* n_calls) noexcept
+{
+  // Let writes and subscriptions through, they don't read anything
+  auto const method = g_dbus_method_invocation_get_method_name(invocation);
+  if (g_str_equal(method, "write") ||
+      g_str_equal(method, "subscribe"))
+    return true;
+
+  ++*n_calls;
+  return false;
+}
+
+static gboolean
+handle_write_cb(TerminalSettingsBridge* skeleton,
+                GDBusMethodInvocation* invocation,
+                char const* key,
+                GVariant* value,
+                void* user_data) noexcept
+{
+  terminal_settings_bridge_complete_write(skeleton, invocation, true);
+  return true;
+}
+
+static gboolean
+handle_subscribe_cb(TerminalSettingsBridge* skeleton,
+                    GDBusMethodInvocation* invocation,
+                    char const* name,
+                    void* user_data) noexcept
+{
+  terminal_settings_bridge_complete_subscribe(skeleton, invocation);
+  return true;
+}
+
+static void
+changed_cb(TerminalSettingsBridge* bridge,
+           char const* const* keys,
+           GVariant* values,
+           unsigned* n_changed) noexcept
+{
+  ++*n_changed;
+}
+
+static gboolean
+timeout_cb(void* user_data)
+{
+  *reinterpret_cast<bool*>(user_data) = true;
+  return G_SOURCE_REMOVE;
+}
+
+typedef struct {
+  GDBusConnection* server_connection;
+  GDBusConnection* client_connection;
+  TerminalSettingsBridge* skeleton;
+  TerminalSettingsBridge* bridge;
+  GSettingsBackend* backend;
+  unsigned n_calls;
+  unsigned n_changed;
+} Fixture;
+
+/* Sets up the server and preferences ends of the bridge over a socket
+ * pair, the way terminal-prefs-process.cc and prefs-main.cc do. The
+ * server end refuses all method calls except writes and subscriptions,
+ * so that a read that misses the cache fails.
+ */
+static void
+fixture_setup(Fixture* fixture,
+              void const* user_data)
+{
+  int fds[2];
+  g_assert_cmpint(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), ==, 0);
+
+  gs_unref_object auto server_stream = socket_stream_new(fds[0]);
+  gs_unref_object auto client_stream = socket_stream_new(fds[1]);
+  gs_free auto guid = g_dbus_generate_guid();
+
+  g_dbus_connection_new(server_stream,
+                        guid,
+                        GDBusConnectionFlags(G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_SERVER |
+                                             G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_ALLOW_ANONYMOUS),
+                        nullptr, // auth observer
+                        nullptr, // cancellable
+                        connection_new_cb,
+                        &fixture->server_connection);
+  g_dbus_connection_new(client_stream,
+                        nullptr, // guid=nullptr for the client
+                        G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                        nullptr, // auth observer
+                        nullptr, // cancellable
+                        connection_new_cb,
+                        &fixture->client_connection);
+  while (!fixture->server_connection || !fixture->client_connection)
+    g_main_context_iteration(nullptr, true);
+
+  fixture->skeleton = terminal_settings_bridge_skeleton_new();
+  // The backend calls the server synchronously from this thread, so
+  // the server end must handle those calls elsewhere
+  g_dbus_interface_skeleton_set_flags(G_DBUS_INTERFACE_SKELETON(fixture->skeleton),
+                                      G_DBUS_INTERFACE_SKELETON_FLAGS_HANDLE_METHOD_INVOCATIONS_IN_THREAD);
+  g_signal_connect(fixture->skeleton, "g-authorize-method",
+                   G_CALLBACK(authorize_method_cb), &fixture->n_calls);
+  g_signal_connect(fixture->skeleton, "handle-write",
+                   G_CALLBACK(handle_write_cb), nullptr);
+  g_signal_connect(fixture->skeleton, "handle-subscribe",
+                   G_CALLBACK(handle_subscribe_cb), nullptr);
+
+  gs_free_error GError* error = nullptr;
+  g_assert_true(g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(fixture->skeleton),
+                                                 fixture->server_connection,
+                                                 TERMINAL_SETTINGS_BRIDGE_OBJECT_PATH,
+                                                 &error));
+  g_assert_no_error(error);
+
+  fixture->bridge = terminal_settings_bridge_backend_new_proxy(fixture->client_connection, &error);
+  g_assert_no_error(error);
+  g_dbus_proxy_set_default_timeout(G_DBUS_PROXY(fixture->bridge), 1000);
+
+  fixture->backend = terminal_settings_bridge_backend_new(fixture->bridge);
+
+  // Connected after the backend's handler, so this runs after it
+  g_signal_connect(fixture->bridge, "changed", G_CALLBACK(changed_cb), &fixture->n_changed);
+}
+
+static void
+fixture_teardown(Fixture* fixture,
+                 void const* user_data)
+{
+  g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON(fixture->skeleton));
+  g_dbus_connection_close_sync(fixture->client_connection, nullptr, nullptr);
+  g_dbus_connection_close_sync(fixture->server_connection, nullptr, nullptr);
+
+  g_clear_object(&fixture->backend);
+  g_clear_object(&fixture->bridge);
+  g_clear_object(&fixture->skeleton);
+  g_clear_object(&fixture->client_connection);
+  g_clear_object(&fixture->server_connection);
+}
+
+/* Sends a "changed" signal for TEST_KEY with @value from the server end,
+ * and waits until the preferences end has received it.
+ */
+static void
+fixture_emit_changed(Fixture* fixture,
+                     char const* value)
+{
+  auto builder = GVariantBuilder{};
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("amv"));
+  g_variant_builder_add(&builder, "mv", g_variant_new_variant(g_variant_new_string(value)));
+
+  char const* keys[] = { TEST_KEY, nullptr };
+  terminal_settings_bridge_emit_changed(fixture->skeleton,
+                                        keys,
+                                        terminal_g_variant_wrap(g_variant_builder_end(&builder)));
+
+  auto const n_changed = fixture->n_changed;
+  auto timed_out = false;
+  auto const timeout_id = g_timeout_add_seconds(5, timeout_cb, &timed_out);
+  while (fixture->n_changed == n_changed && !timed_out)
+    g_main_context_iteration(nullptr, true);
+  if (!timed_out)
+    g_source_remove(timeout_id);
+
+  g_assert_cmpuint(fixture->n_changed, ==, n_changed + 1);
+}
+
+static void
+fixture_assert_value(Fixture* fixture,
+                     char const* expected)
+{
+  gs_unref_variant auto value = terminal_g_settings_backend_read(fixture->backend,
+                                                                 TEST_KEY,
+                                                                 G_VARIANT_TYPE_STRING,
+                                                                 false);
+  g_assert_nonnull(value);
+  g_assert_cmpstr(g_variant_get_string(value, nullptr), ==, expected);
+  g_assert_cmpuint(fixture->n_calls, ==, 0);
+}
+
+/* Checks that a change sent by the server is read from the cache
+ * afterwards, without a call back to the server.
+ */
+static void
+test_changed(Fixture* fixture,
+             void const* user_data)
+{
+  fixture_emit_changed(fixture, "dark");
+  fixture_assert_value(fixture, "dark");
+}
+
+/* Writes the key several times before the server's echoes of those
+ * writes arrive, and checks that the late echoes of the older values
+ * don't replace the last written value, while a later change from
+ * elsewhere still does.
+ */
+static void
+test_write_echoes(Fixture* fixture,
+                  void const* user_data)
+{
+  terminal_g_settings_backend_subscribe(fixture->backend, TEST_PATH);
+
+  char const* values[] = { "light", "dark", "system" };
+  for (auto const v : values)
+    g_assert_true(terminal_g_settings_backend_write(fixture->backend,
+                                                    TEST_KEY,
+                                                    g_variant_new_string(v),
+                                                    nullptr));
+
+  for (auto const v : values) {
+    fixture_emit_changed(fixture, v);
+    fixture_assert_value(fixture, "system");
+  }
+
+  fixture_emit_changed(fixture, "light");
+  fixture_assert_value(fixture, "light");
+}
+
+int
+main(int argc,
+     char* argv[])
+{
+  g_test_init(&argc, &argv, nullptr);
+
+  g_test_add("/terminal/settings-bridge-backend/changed",
+             Fixture, nullptr,
+             fixture_setup, test_changed, fixture_teardown);
+  g_test_add("/terminal/settings-bridge-backend/write-echoes",
+             Fixture, nullptr,
+             fixture_setup, test_write_echoes, fixture_teardown);
+
+  return g_test_run();
+}
+
+#endif /* TERMINAL_SETTINGS_BRIDGE_BACKEND_MAIN */
@@ -35,4 +35,7 @@ GType terminal_settings_bridge_backend_get_type(void);
 
 GSettingsBackend* terminal_settings_bridge_backend_new(TerminalSettingsBridge* bridge);
 
+TerminalSettingsBridge* terminal_settings_bridge_backend_new_proxy(GDBusConnection* connection,
+                                                                   GError** error);
+
 G_END_DECLS
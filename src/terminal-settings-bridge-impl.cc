@@ -19,12 +19,14 @@
 #define G_SETTINGS_ENABLE_BACKEND
 
 #include <cassert>
+#include <cstring>
 
 #include "terminal-settings-bridge-impl.hh"
 
 #include "terminal-app.hh"
 #include "terminal-debug.hh"
 #include "terminal-libgsystem.hh"
+#include "terminal-schemas.hh"
 #include "terminal-settings-utils.hh"
 #include "terminal-settings-bridge-generated.h"
 
@@ -40,6 +42,9 @@ struct _TerminalSettingsBridgeImpl {
 
   GSettingsBackend* backend;
   void* tag;
+
+  // path -> Watch*, for the subscribed paths
+  GHashTable* watches;
 };
 
 struct _TerminalSettingsBridgeImplClass {
@@ -107,6 +112,99 @@ success(GDBusMethodInvocation* invocation,
   return value(invocation, "(b)", v);
 }
 
+/*
+ * schema_id_for_path:
+ * @path_prefix: a settings path ending in '/'
+ *
+ * Returns: the ID of the schema used at @path_prefix, or %nullptr if
+ *   it is not known
+ */
+static char const*
+schema_id_for_path(char const* path_prefix) noexcept
+{
+  if (g_str_equal(path_prefix, TERMINAL_SETTING_SCHEMA_PATH))
+    return TERMINAL_SETTING_SCHEMA;
+  if (g_str_equal(path_prefix, TERMINAL_KEYBINDINGS_SCHEMA_PATH))
+    return TERMINAL_KEYBINDINGS_SCHEMA;
+
+  // A profile path is TERMINAL_PROFILES_PATH_PREFIX ":" uuid "/"
+  if (g_str_has_prefix(path_prefix, TERMINAL_PROFILES_PATH_PREFIX ":")) {
+    auto const uuid = path_prefix + strlen(TERMINAL_PROFILES_PATH_PREFIX ":");
+    auto const slash = strchr(uuid, '/');
+    if (slash && slash != uuid && slash[1] == '\0')
+      return TERMINAL_PROFILE_SCHEMA;
+  }
+
+  return nullptr;
+}
+
+// A GSettings on a subscribed path, to forward its changes to the
+// preferences process
+typedef struct {
+  GSettings* settings;
+  unsigned refcount;
+} Watch;
+
+static gboolean
+watch_change_event_cb(GSettings* settings,
+                      GQuark const* quarks,
+                      int n_quarks,
+                      TerminalSettingsBridgeImpl* impl) noexcept
+{
+  gs_free char* path = nullptr;
+  gs_unref_settings_schema GSettingsSchema* schema = nullptr;
+  g_object_get(settings,
+               "path", &path,
+               "settings-schema", &schema,
+               nullptr);
+
+  // nullptr means that any key may have changed
+  gs_strfreev auto all_keys = quarks ? nullptr : g_settings_schema_list_keys(schema);
+  auto const n_keys = quarks ? n_quarks : int(g_strv_length(all_keys));
+
+  gs_unref_ptrarray auto keys = g_ptr_array_new_full(n_keys + 1, g_free);
+  auto builder = GVariantBuilder{};
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("amv"));
+
+  for (auto i = 0; i < n_keys; ++i) {
+    auto const name = quarks ? g_quark_to_string(quarks[i]) : all_keys[i];
+    if (!g_settings_schema_has_key(schema, name))
+      continue;
+
+    gs_unref_settings_schema_key auto schema_key = g_settings_schema_get_key(schema, name);
+    auto const key = g_strconcat(path, name, nullptr);
+    g_ptr_array_add(keys, key);
+
+    gs_unref_variant auto v =
+      terminal_g_settings_backend_read(impl->backend,
+                                       key,
+                                       g_settings_schema_key_get_value_type(schema_key),
+                                       false);
+    g_variant_builder_add(&builder, "mv", v ? g_variant_new_variant(v) : nullptr);
+  }
+  g_ptr_array_add(keys, nullptr);
+
+  _terminal_debug_print(TERMINAL_DEBUG_BRIDGE,
+                        "Bridge impl changed path %s n-keys %u\n",
+                        path, keys->len - 1);
+
+  terminal_settings_bridge_emit_changed(TERMINAL_SETTINGS_BRIDGE(impl),
+                                        (char const* const*)keys->pdata,
+                                        terminal_g_variant_wrap(g_variant_builder_end(&builder)));
+
+  return false; // let GSettings emit ::changed
+}
+
+static void
+watch_free(Watch* watch) noexcept
+{
+  g_signal_handlers_disconnect_matched(watch->settings, G_SIGNAL_MATCH_FUNC,
+                                       0, 0, nullptr,
+                                       (void*)watch_change_event_cb, nullptr);
+  g_object_unref(watch->settings);
+  g_free(watch);
+}
+
 /* TerminalSettingsBridge interface implementation */
 
 static gboolean
@@ -179,6 +277,55 @@ terminal_settings_bridge_impl_read_user_value(TerminalSettingsBridge* object,
   return value(invocation, "(@ay)", terminal_g_variant_wrap(v));
 }
 
+static gboolean
+terminal_settings_bridge_impl_read_tree(TerminalSettingsBridge* object,
+                                        GDBusMethodInvocation* invocation,
+                                        char const* path_prefix) noexcept
+{
+  _terminal_debug_print(TERMINAL_DEBUG_BRIDGE,
+                        "Bridge impl ::read_tree path-prefix %s\n",
+                        path_prefix);
+
+  auto const schema_id = schema_id_for_path(path_prefix);
+  gs_unref_settings_schema auto schema = schema_id ?
+    g_settings_schema_source_lookup(terminal_app_get_schema_source(terminal_app_get()),
+                                    schema_id,
+                                    true) : nullptr;
+  if (!schema) {
+    g_dbus_method_invocation_return_error(invocation,
+                                          G_DBUS_ERROR,
+                                          G_DBUS_ERROR_INVALID_ARGS,
+                                          "No schema for path: %s",
+                                          path_prefix);
+    return true;
+  }
+
+  auto const impl = IMPL(object);
+  auto builder = GVariantBuilder{};
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("a(smvb)"));
+
+  gs_strfreev auto keys = g_settings_schema_list_keys(schema);
+  for (auto i = 0; keys[i]; ++i) {
+    gs_unref_settings_schema_key auto schema_key = g_settings_schema_get_key(schema, keys[i]);
+    gs_free auto key = g_strconcat(path_prefix, keys[i], nullptr);
+
+    gs_unref_variant auto v =
+      terminal_g_settings_backend_read(impl->backend,
+                                       key,
+                                       g_settings_schema_key_get_value_type(schema_key),
+                                       false);
+    auto const writable = terminal_g_settings_backend_get_writable(impl->backend, key);
+
+    g_variant_builder_add(&builder,
+                          "(smvb)",
+                          keys[i],
+                          v ? g_variant_new_variant(v) : nullptr,
+                          writable);
+  }
+
+  return value(invocation, "(@ay)", terminal_g_variant_wrap(g_variant_builder_end(&builder)));
+}
+
 static gboolean
 terminal_settings_bridge_impl_reset(TerminalSettingsBridge* object,
                                     GDBusMethodInvocation* invocation,
@@ -204,6 +351,29 @@ terminal_settings_bridge_impl_subscribe(TerminalSettingsBridge* object,
 
   auto const impl = IMPL(object);
   terminal_g_settings_backend_subscribe(impl->backend, name);
+
+  auto watch = reinterpret_cast<Watch*>(g_hash_table_lookup(impl->watches, name));
+  if (watch) {
+    ++watch->refcount;
+    return nothing(invocation);
+  }
+
+  // Only paths with a known schema can be watched
+  auto const schema_id = schema_id_for_path(name);
+  gs_unref_settings_schema auto schema = schema_id ?
+    g_settings_schema_source_lookup(terminal_app_get_schema_source(terminal_app_get()),
+                                    schema_id,
+                                    true) : nullptr;
+  if (!schema)
+    return nothing(invocation);
+
+  watch = g_new0(Watch, 1);
+  watch->settings = g_settings_new_full(schema, impl->backend, name);
+  watch->refcount = 1;
+  g_signal_connect(watch->settings, "change-event",
+                   G_CALLBACK(watch_change_event_cb), impl);
+  g_hash_table_insert(impl->watches, g_strdup(name), watch);
+
   return nothing(invocation);
 }
 
@@ -230,6 +400,11 @@ terminal_settings_bridge_impl_unsubscribe(TerminalSettingsBridge* object,
 
   auto const impl = IMPL(object);
   terminal_g_settings_backend_unsubscribe(impl->backend, name);
+
+  auto const watch = reinterpret_cast<Watch*>(g_hash_table_lookup(impl->watches, name));
+  if (watch && --watch->refcount == 0)
+    g_hash_table_remove(impl->watches, name);
+
   return nothing(invocation);
 }
 
@@ -308,6 +483,7 @@ terminal_settings_bridge_impl_iface_init(TerminalSettingsBridgeIface* iface) noe
   iface->handle_get_writable = terminal_settings_bridge_impl_get_writable;
   iface->handle_read = terminal_settings_bridge_impl_read;
   iface->handle_read_user_value = terminal_settings_bridge_impl_read_user_value;
+  iface->handle_read_tree = terminal_settings_bridge_impl_read_tree;
   iface->handle_reset = terminal_settings_bridge_impl_reset;
   iface->handle_subscribe = terminal_settings_bridge_impl_subscribe;
   iface->handle_sync= terminal_settings_bridge_impl_sync;
@@ -328,6 +504,10 @@ static void
 terminal_settings_bridge_impl_init(TerminalSettingsBridgeImpl* impl) /* noexcept */
 {
   impl->tag = &impl->tag;
+  impl->watches = g_hash_table_new_full(g_str_hash,
+                                        g_str_equal,
+                                        g_free,
+                                        GDestroyNotify(watch_free));
 }
 
 static void
@@ -343,6 +523,7 @@ static void
 terminal_settings_bridge_impl_finalize(GObject* object) noexcept
 {
   auto const impl = IMPL(object);
+  g_clear_pointer(&impl->watches, g_hash_table_unref);
   g_clear_object(&impl->backend);
 
   G_OBJECT_CLASS(terminal_settings_bridge_impl_parent_class)->finalize(object);
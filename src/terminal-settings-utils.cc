@@ -19,6 +19,7 @@
 #define G_SETTINGS_ENABLE_BACKEND
 
 #include <gio/gsettingsbackend.h>
+#include <glib/gstdio.h>
 
 #include "terminal-settings-utils.hh"
 #include "terminal-client-utils.hh"
@@ -577,6 +578,95 @@ schemas_source_verify(GSettingsSchemaSource* source,
   return TRUE;
 }
 
+/* Verification verdict cache */
+
+static void
+schemas_identity_append(GString* str,
+                        char const* dir)
+{
+  gs_free auto path = g_build_filename(dir, "gschemas.compiled", nullptr);
+
+  GStatBuf st;
+  if (g_stat(path, &st) == 0)
+    g_string_append_printf(str, "%s %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+                           " %" G_GINT64_FORMAT " %" G_GINT64_FORMAT " %" G_GINT64_FORMAT "\n",
+                           path,
+                           guint64(st.st_dev), guint64(st.st_ino),
+                           gint64(st.st_mtime), gint64(st.st_ctime),
+                           gint64(st.st_size));
+  else
+    g_string_append_printf(str, "%s -\n", path);
+}
+
+/* Returns a checksum identifying the reference schemas, and all the
+ * compiled schemas that g_settings_schema_source_get_default() may load.
+ */
+static char*
+schemas_identity(char const* reference_dir)
+{
+  gs_free_gstring GString* str = g_string_new(nullptr);
+  g_string_append_printf(str, "%s %u.%u.%u\n",
+                         VERSION,
+                         glib_major_version, glib_minor_version, glib_micro_version);
+
+  schemas_identity_append(str, reference_dir);
+
+  auto const data_dirs = g_get_system_data_dirs();
+  for (auto i = 0; data_dirs[i]; ++i) {
+    gs_free auto dir = g_build_filename(data_dirs[i], "glib-2.0", "schemas", nullptr);
+    schemas_identity_append(str, dir);
+  }
+
+  gs_free auto user_dir = g_build_filename(g_get_user_data_dir(), "glib-2.0", "schemas", nullptr);
+  schemas_identity_append(str, user_dir);
+
+  if (auto const env = g_getenv("GSETTINGS_SCHEMA_DIR")) {
+    gs_strfreev auto env_dirs = g_strsplit(env, G_SEARCHPATH_SEPARATOR_S, 0);
+    for (auto i = 0; env_dirs[i]; ++i)
+      schemas_identity_append(str, env_dirs[i]);
+  }
+
+  return g_compute_checksum_for_string(G_CHECKSUM_SHA256, str->str, str->len);
+}
+
+static char*
+schemas_verdict_cache_path(char const* reference_dir)
+{
+  /* Uninstalled and installed builds use different reference schemas */
+  gs_free auto dir_hash = g_compute_checksum_for_string(G_CHECKSUM_SHA256, reference_dir, -1);
+  dir_hash[16] = '\0';
+
+  gs_free auto basename = g_strdup_printf("schemas-verified-%s", dir_hash);
+  return g_build_filename(g_get_user_cache_dir(), "gnome-terminal", basename, nullptr);
+}
+
+static gboolean
+schemas_verdict_cache_lookup(char const* cache_path,
+                             char const* identity)
+{
+  gs_free char* contents = nullptr;
+  if (!g_file_get_contents(cache_path, &contents, nullptr, nullptr))
+    return FALSE;
+
+  return g_str_equal(g_strstrip(contents), identity);
+}
+
+static void
+schemas_verdict_cache_store(char const* cache_path,
+                            char const* identity)
+{
+  gs_free auto dir = g_path_get_dirname(cache_path);
+  if (g_mkdir_with_parents(dir, 0700) != 0)
+    return;
+
+  gs_free auto contents = g_strdup_printf("%s\n", identity);
+  gs_free_error GError* error = nullptr;
+  if (!g_file_set_contents(cache_path, contents, -1, &error))
+    _terminal_debug_print(TERMINAL_DEBUG_STARTUP,
+                          "Failed to store schema verification result: %s\n",
+                          error->message);
+}
+
 GSettingsSchemaSource*
 terminal_g_settings_schema_source_get_default(void)
 {
@@ -597,6 +687,17 @@ terminal_g_settings_schema_source_get_default(void)
                                               "gschemas.compiled",
                                               GFileTest(0));
 
+  /* Verifying is slow, so only do it when any of the schemas changed
+   * since they last verified.
+   */
+  gs_free auto identity = schemas_identity(schema_dir);
+  gs_free auto cache_path = schemas_verdict_cache_path(schema_dir);
+  if (schemas_verdict_cache_lookup(cache_path, identity)) {
+    _terminal_debug_print(TERMINAL_DEBUG_STARTUP,
+                          "Installed schemas verified before, using them\n");
+    return g_settings_schema_source_ref(default_source);
+  }
+
   gs_free_error GError* error = nullptr;
   GSettingsSchemaSource* reference_source =
     g_settings_schema_source_new_from_directory(schema_dir,
@@ -621,6 +722,7 @@ terminal_g_settings_schema_source_get_default(void)
   }
 
   /* Installed schemas verified; use them. */
+  schemas_verdict_cache_store(cache_path, identity);
   g_settings_schema_source_unref(reference_source);
   return g_settings_schema_source_ref(default_source);
 }
@@ -36,6 +36,9 @@ struct _TerminalTab
 
   bool pinned;
   bool kinetic_scrolling;
+
+  bool active;
+  bool window_minimized;
 };
 
 enum
@@ -61,6 +64,9 @@ terminal_tab_init (TerminalTab *tab)
   tab->vscrollbar_policy = TERMINAL_SCROLLBAR_POLICY_NEVER;
   tab->pinned = false;
   tab->kinetic_scrolling = false;
+  /* Set when the tab is added to a notebook */
+  tab->active = false;
+  tab->window_minimized = false;
 }
 
 static void
@@ -367,6 +373,13 @@ terminal_tab_get_kinetic_scrolling(TerminalTab* tab)
   return tab->kinetic_scrolling;
 }
 
+static void
+terminal_tab_update_background(TerminalTab* tab)
+{
+  terminal_screen_set_background(tab->screen,
+                                 !tab->active || tab->window_minimized);
+}
+
 void
 terminal_tab_set_active(TerminalTab* tab,
                         bool active)
@@ -374,4 +387,23 @@ terminal_tab_set_active(TerminalTab* tab,
   g_return_if_fail(TERMINAL_IS_TAB(tab));
 
   gtk_widget_set_visible(tab->scrolled_window, active);
+
+  tab->active = active;
+  terminal_tab_update_background(tab);
+}
+
+/**
+ * terminal_tab_set_window_minimized:
+ * @tab: a #TerminalTab
+ * @minimized: whether the window containing @tab is minimized or otherwise
+ *   not visible
+ */
+void
+terminal_tab_set_window_minimized(TerminalTab* tab,
+                                  bool minimized)
+{
+  g_return_if_fail(TERMINAL_IS_TAB(tab));
+
+  tab->window_minimized = minimized;
+  terminal_tab_update_background(tab);
 }
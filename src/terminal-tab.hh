@@ -59,4 +59,7 @@ bool terminal_tab_get_kinetic_scrolling(TerminalTab* tab);
 void terminal_tab_set_active(TerminalTab* tab,
                              bool active);
 
+void terminal_tab_set_window_minimized(TerminalTab* tab,
+                                       bool minimized);
+
 G_END_DECLS
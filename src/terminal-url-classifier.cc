@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "terminal-pcre2.hh"
+#include "terminal-regex.hh"
+#include "terminal-url-classifier.hh"
+
+/* The named groups of REGEX_URL_COMBINED, indexed by TerminalUrlKind */
+static const char *const group_names[] = {
+  REGEX_URL_GROUP_AS_IS,
+  REGEX_URL_GROUP_HTTP,
+  REGEX_URL_GROUP_FILE,
+  REGEX_URL_GROUP_VOIP,
+  REGEX_URL_GROUP_EMAIL,
+  REGEX_URL_GROUP_NEWS_MAN,
+};
+
+typedef struct {
+  pcre2_code_8 *code;
+  guint32 group_numbers[G_N_ELEMENTS (group_names)];
+} Classifier;
+
+static Classifier *
+classifier_new (void)
+{
+  Classifier *classifier = g_new0 (Classifier, 1);
+
+  /* REGEX_URL_COMBINED, anchored at both ends of the match */
+  int errcode;
+  PCRE2_SIZE erroffset;
+  classifier->code = pcre2_compile_8 ((PCRE2_SPTR8) "(?:" REGEX_URL_COMBINED ")\\z",
+                                      PCRE2_ZERO_TERMINATED,
+                                      PCRE2_UTF | PCRE2_NO_UTF_CHECK | PCRE2_UCP | PCRE2_ANCHORED,
+                                      &errcode, &erroffset,
+                                      nullptr);
+  g_assert (classifier->code != nullptr);
+
+  pcre2_jit_compile_8 (classifier->code, PCRE2_JIT_COMPLETE); /* ignore errors */
+
+  for (guint i = 0; i < G_N_ELEMENTS (group_names); ++i) {
+    int number = pcre2_substring_number_from_name_8 (classifier->code,
+                                                     (PCRE2_SPTR8) group_names[i]);
+    g_assert (number > 0);
+    classifier->group_numbers[i] = guint32 (number);
+  }
+
+  return classifier;
+}
+
+/*
+ * terminal_url_classify:
+ * @match: the text of a match of REGEX_URL_COMBINED
+ *
+ * Tells which alternative of REGEX_URL_COMBINED @match came from, by
+ * matching it once more and checking which named group captured. The
+ * alternatives only look behind or ahead of the match to exclude some
+ * of them, so @match matches the same alternative on its own as it did
+ * in its context.
+ *
+ * Returns: the #TerminalUrlKind of @match, or %TERMINAL_URL_KIND_NONE if
+ *   @match is not a match of REGEX_URL_COMBINED
+ */
+TerminalUrlKind
+terminal_url_classify (const char *match)
+{
+  static Classifier *classifier = classifier_new ();
+
+  pcre2_match_data_8 *match_data = pcre2_match_data_create_from_pattern_8 (classifier->code, nullptr);
+  int r = pcre2_match_8 (classifier->code,
+                         (PCRE2_SPTR8) match, strlen (match),
+                         0 /* start offset */,
+                         PCRE2_NO_UTF_CHECK,
+                         match_data,
+                         nullptr /* match context */);
+
+  TerminalUrlKind kind = TERMINAL_URL_KIND_NONE;
+  if (r >= 0) {
+    PCRE2_SIZE *ovector = pcre2_get_ovector_pointer_8 (match_data);
+    for (guint i = 0; i < G_N_ELEMENTS (group_names); ++i) {
+      if (ovector[2 * classifier->group_numbers[i]] != PCRE2_UNSET) {
+        kind = TerminalUrlKind (i);
+        break;
+      }
+    }
+  }
+
+  pcre2_match_data_free_8 (match_data);
+  return kind;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* The alternatives of REGEX_URL_COMBINED in terminal-regex.hh, in order */
+typedef enum {
+  TERMINAL_URL_KIND_NONE = -1,
+  TERMINAL_URL_KIND_AS_IS,
+  TERMINAL_URL_KIND_HTTP,
+  TERMINAL_URL_KIND_FILE,
+  TERMINAL_URL_KIND_VOIP,
+  TERMINAL_URL_KIND_EMAIL,
+  TERMINAL_URL_KIND_NEWS_MAN,
+} TerminalUrlKind;
+
+TerminalUrlKind terminal_url_classify (const char *match);
+
+G_END_DECLS
@@ -0,0 +1,214 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "terminal-url-prefilter.hh"
+
+#define MAX_LITERALS (31)
+
+/* Set in the anchor table for bytes that are hits by themselves */
+#define ANY_BYTE_HIT (1u << MAX_LITERALS)
+
+struct _TerminalUrlPrefilter {
+  guint n_literals;
+  char *literals[MAX_LITERALS]; /* lower case */
+  gsize lengths[MAX_LITERALS];
+  gsize anchors[MAX_LITERALS];
+  /* For each byte, the set of literals anchored on it */
+  guint32 anchor_table[256];
+};
+
+/* Every match of one of the REGEX_URL_* patterns in terminal-regex.hh
+ * contains one of these. "mailto:" is covered by "@". */
+static const char *const default_literals[] = {
+  "://",    /* REGEX_URL_AS_IS */
+  "www",    /* REGEX_URL_HTTP */
+  "ftp",    /* REGEX_URL_HTTP */
+  "file:/", /* REGEX_URL_FILE */
+  "h323:",  /* REGEX_URL_VOIP */
+  "sip:",   /* REGEX_URL_VOIP */
+  "sips:",  /* REGEX_URL_VOIP */
+  "@",      /* REGEX_EMAIL */
+  "news:",  /* REGEX_NEWS_MAN */
+  "man:",   /* REGEX_NEWS_MAN */
+  "info:",  /* REGEX_NEWS_MAN */
+  nullptr
+};
+
+/* Picks the byte of @literal to look for first. Punctuation is much rarer
+ * than letters in terminal output, so prefer that. */
+static gsize
+choose_anchor (const char *literal)
+{
+  for (gsize i = 0; literal[i] != '\0'; ++i) {
+    if (!g_ascii_isalnum (literal[i]))
+      return i;
+  }
+
+  return 0;
+}
+
+/*
+ * terminal_url_prefilter_new:
+ * @literals: a %nullptr-terminated array of at most 31 non-empty ASCII literals
+ * @non_ascii: whether any non-ASCII byte counts as a literal too, for regexes
+ *   whose matches may consist only of non-ASCII characters
+ *
+ * Returns: (transfer full): a new #TerminalUrlPrefilter looking for @literals
+ */
+TerminalUrlPrefilter *
+terminal_url_prefilter_new (const char *const *literals,
+                            gboolean non_ascii)
+{
+  TerminalUrlPrefilter *prefilter = g_new0 (TerminalUrlPrefilter, 1);
+
+  if (non_ascii) {
+    for (guint c = 0x80; c < 0x100; ++c)
+      prefilter->anchor_table[c] |= ANY_BYTE_HIT;
+  }
+
+  for (guint i = 0; literals[i] != nullptr; ++i) {
+    g_return_val_if_fail (i < MAX_LITERALS, prefilter);
+    g_return_val_if_fail (literals[i][0] != '\0', prefilter);
+
+    prefilter->literals[i] = g_ascii_strdown (literals[i], -1);
+    prefilter->lengths[i] = strlen (literals[i]);
+    prefilter->anchors[i] = choose_anchor (literals[i]);
+    prefilter->n_literals = i + 1;
+
+    const char c = prefilter->literals[i][prefilter->anchors[i]];
+    prefilter->anchor_table[guint8(c)] |= 1u << i;
+    prefilter->anchor_table[guint8(g_ascii_toupper (c))] |= 1u << i;
+  }
+
+  return prefilter;
+}
+
+void
+terminal_url_prefilter_free (TerminalUrlPrefilter *prefilter)
+{
+  if (prefilter == nullptr)
+    return;
+
+  for (guint i = 0; i < prefilter->n_literals; ++i)
+    g_free (prefilter->literals[i]);
+  g_free (prefilter);
+}
+
+/*
+ * terminal_url_prefilter_get_default:
+ *
+ * Returns: (transfer none): the prefilter for the URL regexes in terminal-regex.hh
+ */
+const TerminalUrlPrefilter *
+terminal_url_prefilter_get_default (void)
+{
+  static TerminalUrlPrefilter *prefilter = terminal_url_prefilter_new (default_literals, FALSE);
+
+  return prefilter;
+}
+
+/*
+ * terminal_url_prefilter_find:
+ * @prefilter:
+ * @text: the text to scan
+ * @len: the length of @text in bytes
+ * @offset: where to start scanning
+ *
+ * Returns: the start of the first literal in @text whose first byte
+ *   to look for is at or after @offset, or -1 if there is none
+ */
+gssize
+terminal_url_prefilter_find (const TerminalUrlPrefilter *prefilter,
+                             const char *text,
+                             gsize len,
+                             gsize offset)
+{
+  const guint8 *p = (const guint8 *) text;
+
+  for (gsize i = offset; i < len; ++i) {
+    guint32 candidates = prefilter->anchor_table[p[i]];
+    if (G_LIKELY (candidates == 0))
+      continue;
+    if (candidates & ANY_BYTE_HIT)
+      return i;
+
+    for (guint j = 0; candidates != 0; ++j, candidates >>= 1) {
+      if (!(candidates & 1u))
+        continue;
+
+      const gsize anchor = prefilter->anchors[j];
+      if (i < anchor || i - anchor + prefilter->lengths[j] > len)
+        continue;
+
+      const gsize start = i - anchor;
+      if (g_ascii_strncasecmp (text + start, prefilter->literals[j], prefilter->lengths[j]) == 0)
+        return start;
+    }
+  }
+
+  return -1;
+}
+
+/*
+ * terminal_url_prefilter_next_candidate:
+ * @prefilter:
+ * @text: the text to scan
+ * @len: the length of @text in bytes
+ * @offset: where to start scanning
+ *
+ * Since matches cannot contain whitespace, no match can start after @offset
+ * and before the whitespace-delimited word containing the next literal.
+ *
+ * Returns: where to start running the regexes from, or -1 if no match can
+ *   start at or after @offset
+ */
+gssize
+terminal_url_prefilter_next_candidate (const TerminalUrlPrefilter *prefilter,
+                                       const char *text,
+                                       gsize len,
+                                       gsize offset)
+{
+  gssize hit = terminal_url_prefilter_find (prefilter, text, len, offset);
+  if (hit < 0)
+    return -1;
+
+  gsize start = MAX (gsize(hit), offset);
+  while (start > offset && !g_ascii_isspace (text[start - 1]))
+    --start;
+
+  return start;
+}
+
+/*
+ * terminal_url_prefilter_may_match:
+ * @prefilter:
+ * @text: the text to scan
+ * @len: the length of @text in bytes
+ *
+ * Returns: %FALSE if @text certainly contains no match
+ */
+gboolean
+terminal_url_prefilter_may_match (const TerminalUrlPrefilter *prefilter,
+                                  const char *text,
+                                  gsize len)
+{
+  return terminal_url_prefilter_find (prefilter, text, len, 0) >= 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * TerminalUrlPrefilter:
+ *
+ * A cheap literal scan that tells whether some text can possibly contain a
+ * match of a set of regexes, so that running the regexes can be skipped when
+ * it cannot. Every match of the regexes must contain one of the literals
+ * (compared ASCII case-insensitively), and must not contain whitespace.
+ */
+typedef struct _TerminalUrlPrefilter TerminalUrlPrefilter;
+
+TerminalUrlPrefilter *terminal_url_prefilter_new (const char *const *literals,
+                                                  gboolean non_ascii);
+
+void terminal_url_prefilter_free (TerminalUrlPrefilter *prefilter);
+
+const TerminalUrlPrefilter *terminal_url_prefilter_get_default (void);
+
+gssize terminal_url_prefilter_find (const TerminalUrlPrefilter *prefilter,
+                                    const char *text,
+                                    gsize len,
+                                    gsize offset);
+
+gssize terminal_url_prefilter_next_candidate (const TerminalUrlPrefilter *prefilter,
+                                              const char *text,
+                                              gsize len,
+                                              gsize offset);
+
+gboolean terminal_url_prefilter_may_match (const TerminalUrlPrefilter *prefilter,
+                                           const char *text,
+                                           gsize len);
+
+G_END_DECLS
@@ -0,0 +1,479 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <signal.h>
+#include <sys/types.h>
+#include <uuid.h>
+
+#include "terminal-warm-pool.hh"
+#include "terminal-app.hh"
+#include "terminal-debug.hh"
+#include "terminal-libgsystem.hh"
+#include "terminal-schemas.hh"
+#include "terminal-screen.hh"
+
+/* A child exiting sooner than this after being spawned counts as a failure;
+ * after too many of those in a row the pool stops refilling, so that a broken
+ * shell does not get respawned in a loop.
+ */
+#define QUICK_EXIT_USEC (10 * G_USEC_PER_SEC)
+#define MAX_QUICK_EXITS (3)
+
+struct _TerminalWarmChild {
+  TerminalWarmPool *pool; /* nullptr unless in the pool */
+  char *uuid;
+  VtePty *pty;
+  GPid pid;
+  guint child_watch_id;
+  gint64 spawn_time;
+  char **exec_argv;
+  GSpawnFlags spawn_flags;
+};
+
+struct _TerminalWarmPool {
+  GSettings *profile;
+  guint size;
+  char *cwd;
+
+  GQueue children; /* the ready TerminalWarmChild */
+  guint n_spawning;
+  GCancellable *cancellable;
+  guint refill_source;
+  guint n_quick_exits;
+
+  /* terminal_warm_pool_free() was called while spawns were in flight */
+  gboolean freed;
+};
+
+static void terminal_warm_pool_queue_refill (TerminalWarmPool *pool,
+                                             guint delay_msec);
+
+static void
+reap_child_cb (GPid pid,
+               int status,
+               gpointer user_data)
+{
+  g_spawn_close_pid (pid);
+}
+
+static void
+warm_child_kill (TerminalWarmChild *child)
+{
+  if (child->child_watch_id != 0) {
+    g_source_remove (child->child_watch_id);
+    child->child_watch_id = 0;
+  }
+
+  if (child->pid == -1)
+    return;
+
+  _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                         "[warm pool] killing unused child %d\n",
+                         child->pid);
+
+  kill (child->pid, SIGHUP);
+  g_child_watch_add (child->pid, reap_child_cb, nullptr);
+  child->pid = -1;
+}
+
+/*
+ * terminal_warm_child_free:
+ * @child:
+ *
+ * Frees @child, killing its process unless it was taken with
+ * terminal_warm_child_steal_pid().
+ */
+void
+terminal_warm_child_free (TerminalWarmChild *child)
+{
+  if (child == nullptr)
+    return;
+
+  g_warn_if_fail (child->pool == nullptr);
+
+  warm_child_kill (child);
+  g_clear_object (&child->pty);
+  g_strfreev (child->exec_argv);
+  g_free (child->uuid);
+  g_free (child);
+}
+
+const char *
+terminal_warm_child_get_uuid (TerminalWarmChild *child)
+{
+  return child->uuid;
+}
+
+VtePty *
+terminal_warm_child_get_pty (TerminalWarmChild *child)
+{
+  return child->pty;
+}
+
+gint64
+terminal_warm_child_get_spawn_time (TerminalWarmChild *child)
+{
+  return child->spawn_time;
+}
+
+/*
+ * terminal_warm_child_steal_pid:
+ * @child:
+ *
+ * Stops watching the process of @child, leaving it to the caller
+ * (usually vte_terminal_watch_child()). A child that exits before the
+ * caller watches it stays a zombie until then.
+ *
+ * Returns: the pid of the child process
+ */
+GPid
+terminal_warm_child_steal_pid (TerminalWarmChild *child)
+{
+  if (child->child_watch_id != 0) {
+    g_source_remove (child->child_watch_id);
+    child->child_watch_id = 0;
+  }
+
+  GPid pid = child->pid;
+  child->pid = -1;
+  return pid;
+}
+
+static void
+warm_child_exited_cb (GPid pid,
+                      int status,
+                      gpointer user_data)
+{
+  auto const child = reinterpret_cast<TerminalWarmChild*>(user_data);
+  auto const pool = child->pool;
+
+  child->child_watch_id = 0;
+  child->pid = -1;
+  g_spawn_close_pid (pid);
+
+  auto const lifetime = g_get_monotonic_time () - child->spawn_time;
+  _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                         "[warm pool] child %d exited with status %d after %" G_GINT64_FORMAT "ms\n",
+                         pid, status, lifetime / 1000);
+
+  g_queue_remove (&pool->children, child);
+  child->pool = nullptr;
+  terminal_warm_child_free (child);
+
+  if (lifetime < QUICK_EXIT_USEC) {
+    if (++pool->n_quick_exits >= MAX_QUICK_EXITS) {
+      _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                             "[warm pool] children keep exiting, not refilling\n");
+      return;
+    }
+  } else {
+    pool->n_quick_exits = 0;
+  }
+
+  terminal_warm_pool_queue_refill (pool, 0);
+}
+
+static void
+warm_child_spawn_cb (GObject *source,
+                     GAsyncResult *result,
+                     gpointer user_data)
+{
+  auto const child = reinterpret_cast<TerminalWarmChild*>(user_data);
+  auto const pool = child->pool;
+  child->pool = nullptr;
+
+  g_autoptr(GError) error = nullptr;
+  GPid pid = -1;
+  if (!vte_pty_spawn_finish (VTE_PTY (source), result, &pid, &error))
+    pid = -1;
+  child->pid = pid;
+
+  g_assert (pool->n_spawning > 0);
+  pool->n_spawning--;
+
+  if (pool->freed) {
+    terminal_warm_child_free (child);
+    if (pool->n_spawning == 0)
+      terminal_warm_pool_free (pool);
+    return;
+  }
+
+  if (error) {
+    _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                           "[warm pool] failed to spawn child: %s\n",
+                           error->message);
+    terminal_warm_child_free (child);
+    pool->n_quick_exits = MAX_QUICK_EXITS;
+    return;
+  }
+
+  _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                         "[warm pool] child %d ready after %" G_GINT64_FORMAT "ms\n",
+                         pid, (g_get_monotonic_time () - child->spawn_time) / 1000);
+
+  child->pool = pool;
+  child->child_watch_id = g_child_watch_add (pid, warm_child_exited_cb, child);
+  g_queue_push_tail (&pool->children, child);
+}
+
+static gboolean
+terminal_warm_pool_spawn_child (TerminalWarmPool *pool)
+{
+  auto const app = terminal_app_get ();
+  g_autoptr(GError) error = nullptr;
+
+  uuid_t u;
+  char uuidstr[37];
+  uuid_generate (u);
+  uuid_unparse (u, uuidstr);
+
+  /* Prepare the child exactly the way terminal_screen_exec() does for a
+   * new terminal without command line, environment or working directory.
+   */
+  gs_free char *object_path = terminal_app_dup_screen_object_path_for_uuid (app, uuidstr);
+  gs_free char *path = nullptr;
+  gs_free char *shell = nullptr;
+  gs_strfreev char **envv = terminal_screen_get_child_environment (object_path,
+                                                                  nullptr,
+                                                                  &path,
+                                                                  &shell);
+
+  gboolean preserve_cwd = FALSE;
+  GSpawnFlags spawn_flags = GSpawnFlags(G_SPAWN_SEARCH_PATH_FROM_ENVP |
+                                        VTE_SPAWN_NO_PARENT_ENVV);
+  gs_strfreev char **exec_argv = nullptr;
+  if (!terminal_screen_get_child_command (pool->profile,
+                                          nullptr,
+                                          path,
+                                          shell,
+                                          TRUE,
+                                          &preserve_cwd,
+                                          &spawn_flags,
+                                          &exec_argv,
+                                          &error)) {
+    _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                           "[warm pool] cannot get the child command: %s\n",
+                           error->message);
+    return FALSE;
+  }
+
+  if (!preserve_cwd)
+    envv = g_environ_unsetenv (envv, "PWD");
+
+  gs_unref_object VtePty *pty = vte_pty_new_sync (VTE_PTY_DEFAULT, nullptr, &error);
+  if (pty == nullptr) {
+    _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                           "[warm pool] cannot create a PTY: %s\n",
+                           error->message);
+    return FALSE;
+  }
+
+  /* Let the shell print its prompt for the size the terminal will most
+   * likely have; it gets resized when adopted anyway.
+   */
+  vte_pty_set_size (pty,
+                    g_settings_get_int (pool->profile, TERMINAL_PROFILE_DEFAULT_SIZE_ROWS_KEY),
+                    g_settings_get_int (pool->profile, TERMINAL_PROFILE_DEFAULT_SIZE_COLUMNS_KEY),
+                    nullptr);
+
+  auto const child = g_new0 (TerminalWarmChild, 1);
+  child->pool = pool;
+  child->uuid = g_strdup (uuidstr);
+  child->pty = (VtePty*)g_object_ref (pty);
+  child->pid = -1;
+  child->spawn_time = g_get_monotonic_time ();
+  child->exec_argv = (char**)g_steal_pointer (&exec_argv);
+  child->spawn_flags = spawn_flags;
+
+  pool->n_spawning++;
+  vte_pty_spawn_with_fds_async (pty,
+                                pool->cwd,
+                                (char const* const*)child->exec_argv,
+                                (char const* const*)envv,
+                                nullptr, 0, /* fds */
+                                nullptr, 0, /* fd map */
+                                spawn_flags,
+                                nullptr, nullptr, nullptr, /* child setup, data, destroy */
+                                -1,
+                                pool->cancellable,
+                                warm_child_spawn_cb,
+                                child);
+
+  return TRUE;
+}
+
+static gboolean
+terminal_warm_pool_refill_cb (void *user_data)
+{
+  auto const pool = reinterpret_cast<TerminalWarmPool*>(user_data);
+
+  pool->refill_source = 0;
+
+  while (g_queue_get_length (&pool->children) + pool->n_spawning < pool->size &&
+         pool->n_quick_exits < MAX_QUICK_EXITS) {
+    if (!terminal_warm_pool_spawn_child (pool))
+      break;
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+terminal_warm_pool_queue_refill (TerminalWarmPool *pool,
+                                 guint delay_msec)
+{
+  if (pool->refill_source != 0)
+    return;
+
+  /* Refill at low priority, so that spawning does not compete with
+   * drawing the terminal that just took a child.
+   */
+  if (delay_msec == 0)
+    pool->refill_source = g_idle_add_full (G_PRIORITY_LOW,
+                                           terminal_warm_pool_refill_cb,
+                                           pool, nullptr);
+  else
+    pool->refill_source = g_timeout_add_full (G_PRIORITY_LOW,
+                                              delay_msec,
+                                              terminal_warm_pool_refill_cb,
+                                              pool, nullptr);
+}
+
+/*
+ * terminal_warm_pool_new:
+ * @profile: the profile to spawn children for
+ * @size: the number of children to keep ready
+ * @delay_msec: how long to wait before spawning the first children
+ *
+ * Returns: (transfer full): a new #TerminalWarmPool
+ */
+TerminalWarmPool *
+terminal_warm_pool_new (GSettings *profile,
+                        guint size,
+                        guint delay_msec)
+{
+  auto const pool = g_new0 (TerminalWarmPool, 1);
+  pool->profile = (GSettings*)g_object_ref (profile);
+  pool->size = size;
+  pool->cwd = g_strdup (g_get_home_dir ());
+  g_queue_init (&pool->children);
+  pool->cancellable = g_cancellable_new ();
+
+  terminal_warm_pool_queue_refill (pool, delay_msec);
+
+  return pool;
+}
+
+/*
+ * terminal_warm_pool_free:
+ * @pool:
+ *
+ * Kills the children in @pool and frees it. Children still being spawned
+ * are killed as soon as their spawn completes.
+ */
+void
+terminal_warm_pool_free (TerminalWarmPool *pool)
+{
+  if (pool == nullptr)
+    return;
+
+  if (!pool->freed) {
+    pool->freed = TRUE;
+
+    g_clear_handle_id (&pool->refill_source, g_source_remove);
+    g_cancellable_cancel (pool->cancellable);
+
+    TerminalWarmChild *child;
+    while ((child = (TerminalWarmChild*)g_queue_pop_head (&pool->children))) {
+      child->pool = nullptr;
+      terminal_warm_child_free (child);
+    }
+  }
+
+  if (pool->n_spawning > 0)
+    return; /* warm_child_spawn_cb() finishes freeing */
+
+  g_clear_object (&pool->cancellable);
+  g_clear_object (&pool->profile);
+  g_free (pool->cwd);
+  g_free (pool);
+}
+
+GSettings *
+terminal_warm_pool_get_profile (TerminalWarmPool *pool)
+{
+  return pool->profile;
+}
+
+guint
+terminal_warm_pool_get_size (TerminalWarmPool *pool)
+{
+  return pool->size;
+}
+
+/*
+ * terminal_warm_pool_take:
+ * @pool:
+ * @exec_argv: the command the new terminal is going to run
+ * @cwd: the working directory the new terminal is going to use
+ * @spawn_flags: the flags the new terminal is going to spawn with
+ *
+ * Takes a child that was started exactly like the terminal would start
+ * its own, if there is one ready, and schedules the pool to be refilled.
+ *
+ * Returns: (transfer full) (nullable): a #TerminalWarmChild, or %nullptr
+ */
+TerminalWarmChild *
+terminal_warm_pool_take (TerminalWarmPool *pool,
+                         char **exec_argv,
+                         const char *cwd,
+                         GSpawnFlags spawn_flags)
+{
+  g_return_val_if_fail (pool != nullptr, nullptr);
+
+  if (exec_argv == nullptr || cwd == nullptr || !g_str_equal (cwd, pool->cwd)) {
+    _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                           "[warm pool] working directory %s does not match\n",
+                           cwd);
+    return nullptr;
+  }
+
+  for (auto l = pool->children.head; l != nullptr; l = l->next) {
+    auto const child = reinterpret_cast<TerminalWarmChild*>(l->data);
+
+    if (child->spawn_flags != spawn_flags ||
+        !g_strv_equal ((char const* const*)child->exec_argv,
+                       (char const* const*)exec_argv))
+      continue;
+
+    g_queue_delete_link (&pool->children, l);
+    child->pool = nullptr;
+
+    _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                           "[warm pool] taking child %d, %u left\n",
+                           child->pid, g_queue_get_length (&pool->children));
+
+    terminal_warm_pool_queue_refill (pool, 0);
+    return child;
+  }
+
+  _terminal_debug_print (TERMINAL_DEBUG_PROCESSES,
+                         "[warm pool] no matching child ready\n");
+  return nullptr;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2026 GNOME Terminal contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+#include <vte/vte.h>
+
+G_BEGIN_DECLS
+
+/*
+ * TerminalWarmChild:
+ *
+ * A child process already running on its own #VtePty, waiting for a
+ * #TerminalScreen to adopt it. Its environment refers to the screen
+ * by the uuid returned by terminal_warm_child_get_uuid(), so the adopting
+ * screen must take over that uuid.
+ */
+typedef struct _TerminalWarmChild TerminalWarmChild;
+
+/*
+ * TerminalWarmPool:
+ *
+ * Keeps a number of child processes spawned for a profile,
+ * and refills itself in the background when one is taken.
+ */
+typedef struct _TerminalWarmPool TerminalWarmPool;
+
+TerminalWarmPool *terminal_warm_pool_new (GSettings *profile,
+                                          guint size,
+                                          guint delay_msec);
+
+void terminal_warm_pool_free (TerminalWarmPool *pool);
+
+GSettings *terminal_warm_pool_get_profile (TerminalWarmPool *pool);
+
+guint terminal_warm_pool_get_size (TerminalWarmPool *pool);
+
+TerminalWarmChild *terminal_warm_pool_take (TerminalWarmPool *pool,
+                                            char **exec_argv,
+                                            const char *cwd,
+                                            GSpawnFlags spawn_flags);
+
+const char *terminal_warm_child_get_uuid (TerminalWarmChild *child);
+
+VtePty *terminal_warm_child_get_pty (TerminalWarmChild *child);
+
+gint64 terminal_warm_child_get_spawn_time (TerminalWarmChild *child);
+
+GPid terminal_warm_child_steal_pid (TerminalWarmChild *child);
+
+void terminal_warm_child_free (TerminalWarmChild *child);
+
+G_END_DECLS
@@ -40,7 +40,9 @@
 #include "terminal-find-bar.hh"
 #include "terminal-icon-button.hh"
 #include "terminal-intl.hh"
+#include "terminal-info-bar.hh"
 #include "terminal-notebook.hh"
+#include "terminal-save-contents.hh"
 #include "terminal-schemas.hh"
 #include "terminal-tab.hh"
 #include "terminal-util.hh"
@@ -100,6 +102,10 @@ struct _TerminalWindow
   TerminalFindBar* find_bar;
   GtkRevealer* find_bar_revealer;
 
+  /* Long running operations, see terminal_window_begin_operation() */
+  GtkWidget *operations_box;
+  GPtrArray *operations;
+
   GtkPopoverMenu *context_menu;
 
   /* A GSource delaying transition until animations complete */
@@ -107,6 +113,10 @@ struct _TerminalWindow
 
   guint focus_active_tab_source;
 
+  /* Tick callback updating the geometry once per frame */
+  guint update_geometry_tick;
+  guint n_update_geometry_requests;
+
   guint disposed : 1;
   guint present_on_insert : 1;
   guint tab_overview_animating : 1;
@@ -117,19 +127,11 @@ struct _TerminalWindow
 #define MIN_WIDTH_CHARS 4
 #define MIN_HEIGHT_CHARS 1
 
-#if 1
-/*
- * We don't want to enable content saving until vte supports it async.
- * So we disable this code for stable versions.
- */
-#include "terminal-version.hh"
-
-#if (TERMINAL_MINOR_VERSION & 1) != 0
+/* Content saving is asynchronous, see terminal-save-contents.cc */
 #define ENABLE_SAVE
-#else
-#undef ENABLE_SAVE
-#endif
-#endif
+
+/* How often to update the throughput shown for long running operations */
+#define OPERATION_RATE_UPDATE_USEC (500 * 1000)
 
 /* See bug #789356 and issue gnome-terminal#129*/
 static inline constexpr auto
@@ -410,6 +412,171 @@ terminal_window_tab_overview_create_tab_cb(AdwTabOverview* tab_overview,
                                 GTK_WIDGET(tab));
 }
 
+/* Long running operations */
+
+struct _TerminalWindowOperation {
+  TerminalWindow *window; /* unowned, cleared when the window goes away */
+  GtkWidget *info_bar;
+  GCancellable *cancellable;
+  gint64 start_time;
+  gint64 last_rate_update;
+};
+
+static void
+terminal_window_operation_response_cb (GtkWidget *info_bar,
+                                       int response_id,
+                                       TerminalWindowOperation *operation)
+{
+  /* Both the Cancel and the close button cancel */
+  g_cancellable_cancel (operation->cancellable);
+}
+
+static void
+terminal_window_operation_detach (TerminalWindowOperation *operation)
+{
+  auto const window = operation->window;
+  if (window == nullptr)
+    return;
+
+  g_signal_handlers_disconnect_by_data (operation->info_bar, operation);
+  gtk_box_remove (GTK_BOX (window->operations_box), operation->info_bar);
+  g_ptr_array_remove_fast (window->operations, operation);
+  operation->window = nullptr;
+}
+
+static void
+terminal_window_cancel_operations (TerminalWindow *window)
+{
+  while (window->operations->len > 0) {
+    auto const operation = reinterpret_cast<TerminalWindowOperation*>
+      (g_ptr_array_index (window->operations, window->operations->len - 1));
+
+    /* Cancelling may end the operation right away */
+    gs_unref_object auto cancellable = (GCancellable*)g_object_ref (operation->cancellable);
+    terminal_window_operation_detach (operation);
+    g_cancellable_cancel (cancellable);
+  }
+}
+
+/**
+ * terminal_window_begin_operation:
+ * @window: a #TerminalWindow
+ * @description: the text to show for the operation
+ *
+ * Shows an info bar for a new long running operation on @window. The
+ * operation should use the cancellable from
+ * terminal_window_operation_get_cancellable(), which is cancelled when
+ * the user cancels it or @window is destroyed, and must eventually be
+ * ended with terminal_window_operation_end().
+ *
+ * Returns: (transfer none): a new #TerminalWindowOperation
+ */
+TerminalWindowOperation *
+terminal_window_begin_operation (TerminalWindow *window,
+                                 const char *description)
+{
+  g_return_val_if_fail (TERMINAL_IS_WINDOW (window), nullptr);
+
+  auto const operation = g_new0 (TerminalWindowOperation, 1);
+  operation->window = window;
+  operation->cancellable = g_cancellable_new ();
+  operation->start_time = g_get_monotonic_time ();
+
+  operation->info_bar = terminal_info_bar_new (GTK_MESSAGE_INFO,
+                                               _("_Cancel"), GTK_RESPONSE_CANCEL,
+                                               nullptr);
+  g_object_ref_sink (operation->info_bar);
+  terminal_info_bar_format_text (TERMINAL_INFO_BAR (operation->info_bar),
+                                 "%s", description);
+  terminal_info_bar_set_progress (TERMINAL_INFO_BAR (operation->info_bar), 0.);
+  g_signal_connect (operation->info_bar, "response",
+                    G_CALLBACK (terminal_window_operation_response_cb), operation);
+
+  gtk_widget_set_halign (operation->info_bar, GTK_ALIGN_FILL);
+  gtk_box_append (GTK_BOX (window->operations_box), operation->info_bar);
+  g_ptr_array_add (window->operations, operation);
+
+  return operation;
+}
+
+/**
+ * terminal_window_operation_get_window:
+ * @operation: a #TerminalWindowOperation
+ *
+ * Returns: (transfer none) (nullable): the window of @operation, or %nullptr
+ *   if it has been destroyed meanwhile
+ */
+TerminalWindow *
+terminal_window_operation_get_window (TerminalWindowOperation *operation)
+{
+  return operation->window;
+}
+
+/**
+ * terminal_window_operation_get_cancellable:
+ * @operation: a #TerminalWindowOperation
+ *
+ * Returns: (transfer none): the #GCancellable of @operation
+ */
+GCancellable *
+terminal_window_operation_get_cancellable (TerminalWindowOperation *operation)
+{
+  return operation->cancellable;
+}
+
+/**
+ * terminal_window_operation_set_progress:
+ * @operation: a #TerminalWindowOperation
+ * @n_lines: the number of lines done
+ * @total_lines: the total number of lines, or -1 if unknown
+ *
+ * Updates the progress shown for @operation, together with the
+ * number of lines done per second.
+ */
+void
+terminal_window_operation_set_progress (TerminalWindowOperation *operation,
+                                        gint64 n_lines,
+                                        gint64 total_lines)
+{
+  if (operation->window == nullptr)
+    return;
+
+  auto const info_bar = TERMINAL_INFO_BAR (operation->info_bar);
+  terminal_info_bar_set_progress (info_bar,
+                                  total_lines > 0 ? double (n_lines) / double (total_lines) : -1.);
+
+  auto const now = g_get_monotonic_time ();
+  if (n_lines <= 0 || now - operation->last_rate_update < OPERATION_RATE_UPDATE_USEC)
+    return;
+
+  operation->last_rate_update = now;
+
+  auto const elapsed = now - operation->start_time;
+  if (elapsed <= 0)
+    return;
+
+  gs_free char *rate = g_strdup_printf ("%" G_GINT64_FORMAT,
+                                        gint64 (double (n_lines) * G_USEC_PER_SEC / double (elapsed)));
+  gs_free char *text = g_strdup_printf (_("%s lines/s"), rate);
+  terminal_info_bar_set_progress_text (info_bar, text);
+}
+
+/**
+ * terminal_window_operation_end:
+ * @operation: a #TerminalWindowOperation
+ *
+ * Removes the info bar of @operation, and frees it.
+ */
+void
+terminal_window_operation_end (TerminalWindowOperation *operation)
+{
+  terminal_window_operation_detach (operation);
+
+  g_object_unref (operation->info_bar);
+  g_object_unref (operation->cancellable);
+  g_free (operation);
+}
+
 /* GAction callbacks */
 
 static void
@@ -426,16 +593,44 @@ action_new_terminal_cb (GSimpleAction *action,
 
 #ifdef ENABLE_SAVE
 
+static void
+save_contents_progress_cb (goffset current_rows,
+                           goffset total_rows,
+                           gpointer user_data)
+{
+  auto const operation = reinterpret_cast<TerminalWindowOperation*>(user_data);
+
+  terminal_window_operation_set_progress (operation, current_rows, total_rows);
+}
+
+static void
+save_contents_done_cb (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
+{
+  auto const operation = reinterpret_cast<TerminalWindowOperation*>(user_data);
+  gs_free_error GError *error = nullptr;
+
+  if (!terminal_save_contents_finish (result, &error) &&
+      !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      terminal_util_show_error_dialog (GTK_WINDOW (terminal_window_operation_get_window (operation)),
+                                       nullptr, error,
+				       "%s", _("Could not save contents"));
+    }
+
+  terminal_window_operation_end (operation);
+}
+
 static void
 save_contents_dialog_on_response (GtkDialog *dialog,
 				  int response_id,
 				  gpointer user_data)
 {
   VteTerminal *terminal = (VteTerminal*)user_data;
-  GtkWindow *parent;
   gs_unref_object GFile *file = nullptr;
-  GOutputStream *stream;
-  gs_free_error GError *error = nullptr;
+  gs_free char *basename = nullptr;
+  gboolean compress;
 
   if (response_id != GTK_RESPONSE_ACCEPT)
     {
@@ -443,30 +638,27 @@ save_contents_dialog_on_response (GtkDialog *dialog,
       return;
     }
 
-  parent = (GtkWindow*) gtk_widget_get_ancestor (GTK_WIDGET (terminal), GTK_TYPE_WINDOW);
+  file = gtk_file_chooser_get_file (GTK_FILE_CHOOSER (dialog));
+  compress = g_strcmp0 (gtk_file_chooser_get_choice (GTK_FILE_CHOOSER (dialog), "compress"),
+                        "true") == 0;
 
   gtk_window_destroy (GTK_WINDOW (dialog));
 
-  stream = G_OUTPUT_STREAM (g_file_replace (file, nullptr, FALSE, G_FILE_CREATE_NONE, nullptr, &error));
+  if (file == nullptr)
+    return;
 
-  if (stream)
-    {
-      /* XXX
-       * FIXME
-       * This is a sync operation.
-       * Should be replaced with the async version when vte implements that.
-       */
-      vte_terminal_write_contents_sync (terminal, stream,
-					VTE_WRITE_DEFAULT,
-					nullptr, &error);
-      g_object_unref (stream);
-    }
+  auto const window = TERMINAL_WINDOW (gtk_widget_get_root (GTK_WIDGET (terminal)));
 
-  if (error)
-    {
-      terminal_util_show_error_dialog (parent, nullptr, error,
-				       "%s", _("Could not save contents"));
-    }
+  basename = g_file_get_basename (file);
+  gs_free char *description = g_strdup_printf (_("Saving contents to “%s”…"), basename);
+  auto const operation = terminal_window_begin_operation (window, description);
+
+  terminal_save_contents_async (terminal, file,
+                                compress ? TERMINAL_SAVE_CONTENTS_FLAG_COMPRESS
+                                         : TERMINAL_SAVE_CONTENTS_FLAG_NONE,
+                                terminal_window_operation_get_cancellable (operation),
+                                save_contents_progress_cb, operation,
+                                save_contents_done_cb, operation);
 }
 
 static void
@@ -494,6 +686,8 @@ action_save_contents_cb (GSimpleAction *action,
 
   file = g_file_new_for_path (g_get_user_special_dir (G_USER_DIRECTORY_DOCUMENTS));
   gtk_file_chooser_set_current_folder (GTK_FILE_CHOOSER (dialog), file, nullptr);
+  gtk_file_chooser_add_choice (GTK_FILE_CHOOSER (dialog), "compress",
+                               _("Compress with gzip"), nullptr, nullptr);
 
   gtk_window_set_transient_for (GTK_WINDOW (dialog), GTK_WINDOW (window));
   gtk_window_set_modal (GTK_WINDOW (dialog), TRUE);
@@ -1881,12 +2075,48 @@ window_hide_ask_default_terminal(TerminalWindow* window)
   terminal_window_update_size(window);
 }
 
+static void default_infobar_response_cb(GtkInfoBar* infobar,
+                                        int response,
+                                        TerminalWindow* window);
+
+static void
+window_show_ask_default_terminal(TerminalWindow* window)
+{
+  /* Not again after the user closed it */
+  if (window->ask_default_infobar)
+    return;
+
+  auto const infobar = window->ask_default_infobar = gtk_info_bar_new();
+  gtk_info_bar_set_show_close_button(GTK_INFO_BAR(infobar), true);
+  gtk_info_bar_set_message_type(GTK_INFO_BAR(infobar), GTK_MESSAGE_QUESTION);
+
+  auto const question = gtk_label_new (_("Set GNOME Terminal as your default terminal?"));
+  gtk_label_set_wrap(GTK_LABEL(question), true);
+  gtk_info_bar_add_child(GTK_INFO_BAR(infobar), question);
+  gtk_widget_show(question);
+
+  gtk_info_bar_add_button(GTK_INFO_BAR(infobar), _("_Yes"), GTK_RESPONSE_YES);
+  gtk_info_bar_add_button(GTK_INFO_BAR(infobar), _("_No"), GTK_RESPONSE_NO);
+
+  g_signal_connect (infobar, "response",
+                    G_CALLBACK(default_infobar_response_cb), window);
+
+  gtk_box_prepend(GTK_BOX(window->main_vbox), infobar);
+
+  gtk_widget_show(infobar);
+  if (window->realized)
+    terminal_window_update_size(window);
+}
+
 static void
 window_sync_ask_default_terminal_cb(TerminalApp* app,
                                     GParamSpec* pspect,
                                     TerminalWindow* window)
 {
-  window_hide_ask_default_terminal(window);
+  if (terminal_app_get_ask_default_terminal(app))
+    window_show_ask_default_terminal(window);
+  else
+    window_hide_ask_default_terminal(window);
 }
 
 static void
@@ -1993,6 +2223,17 @@ recurse_capture_middle_click(GtkWidget *widget,
 
 /*****************************************/
 
+static void
+terminal_window_after_paint_cb (GdkFrameClock *frame_clock,
+                                TerminalWindow *window)
+{
+  g_signal_handlers_disconnect_by_func (frame_clock,
+                                        (void*)terminal_window_after_paint_cb,
+                                        window);
+
+  terminal_app_first_frame (terminal_app_get ());
+}
+
 static void
 terminal_window_realize (GtkWidget *widget)
 {
@@ -2018,6 +2259,13 @@ terminal_window_realize (GtkWidget *widget)
                            window,
                            G_CONNECT_SWAPPED);
 
+  /* Deferred startup work waits for the first frame */
+  g_signal_connect_object (gdk_surface_get_frame_clock (surface),
+                           "after-paint",
+                           G_CALLBACK (terminal_window_after_paint_cb),
+                           window,
+                           GConnectFlags(0));
+
   /* Now that we've been realized, we should know precisely how large the
    * client-side decorations are going to be. Recalculate the geometry hints,
    * export them to the windowing system, and resize the window accordingly. */
@@ -2025,6 +2273,14 @@ terminal_window_realize (GtkWidget *widget)
   terminal_window_update_size (window);
 }
 
+/* Whether the window is minimized or otherwise not visible */
+static bool
+terminal_window_is_minimized (TerminalWindow *window)
+{
+  return (window->window_state & (GDK_TOPLEVEL_STATE_MINIMIZED |
+                                  GDK_TOPLEVEL_STATE_SUSPENDED)) != 0;
+}
+
 static void
 terminal_window_state_event (GtkWidget *widget,
                              GParamSpec *pspec,
@@ -2051,6 +2307,15 @@ terminal_window_state_event (GtkWidget *widget,
       g_simple_action_set_enabled (lookup_action (window, "size-to"),
                                    !is_fullscreen);
     }
+
+  if (changed_mask & (GDK_TOPLEVEL_STATE_MINIMIZED | GDK_TOPLEVEL_STATE_SUSPENDED))
+    {
+      auto const minimized = terminal_window_is_minimized (window);
+
+      gs_free_list GList *tabs = terminal_window_list_tabs (window);
+      for (auto l = tabs; l != nullptr; l = l->next)
+        terminal_tab_set_window_minimized (TERMINAL_TAB (l->data), minimized);
+    }
 }
 
 static void
@@ -2150,6 +2415,8 @@ terminal_window_init (TerminalWindow *window)
 
   gtk_widget_init_template (GTK_WIDGET (window));
 
+  window->operations = g_ptr_array_new ();
+
   /* GAction setup */
   g_action_map_add_action_entries (G_ACTION_MAP (window),
                                    action_entries, G_N_ELEMENTS (action_entries),
@@ -2173,29 +2440,13 @@ terminal_window_init (TerminalWindow *window)
                                  "notebook",
                                  G_ACTION_GROUP(action_group));
 
-  /* Add "Set as default terminal" infobar */
-  if (terminal_app_get_ask_default_terminal(app)) {
-    auto const infobar = window->ask_default_infobar = gtk_info_bar_new();
-    gtk_info_bar_set_show_close_button(GTK_INFO_BAR(infobar), true);
-    gtk_info_bar_set_message_type(GTK_INFO_BAR(infobar), GTK_MESSAGE_QUESTION);
-
-    auto const question = gtk_label_new (_("Set GNOME Terminal as your default terminal?"));
-    gtk_label_set_wrap(GTK_LABEL(question), true);
-    gtk_info_bar_add_child(GTK_INFO_BAR(infobar), question);
-    gtk_widget_show(question);
-
-    gtk_info_bar_add_button(GTK_INFO_BAR(infobar), _("_Yes"), GTK_RESPONSE_YES);
-    gtk_info_bar_add_button(GTK_INFO_BAR(infobar), _("_No"), GTK_RESPONSE_NO);
-
-    g_signal_connect (infobar, "response",
-                      G_CALLBACK(default_infobar_response_cb), window);
-
-    gtk_box_prepend(GTK_BOX(window->main_vbox), infobar);
-
-    gtk_widget_show(infobar);
-    g_signal_connect(app, "notify::ask-default-terminal",
-                     G_CALLBACK(window_sync_ask_default_terminal_cb), window);
-  }
+  /* Add "Set as default terminal" infobar. The check may only complete
+   * after the window is shown, see terminal_app_first_frame().
+   */
+  if (terminal_app_get_ask_default_terminal(app))
+    window_show_ask_default_terminal(window);
+  g_signal_connect(app, "notify::ask-default-terminal",
+                   G_CALLBACK(window_sync_ask_default_terminal_cb), window);
 
   /* Maybe make Inspector available */
   action = lookup_action (window, "inspector");
@@ -2356,6 +2607,7 @@ terminal_window_class_init (TerminalWindowClass *klass)
   gtk_widget_class_bind_template_child (widget_class, TerminalWindow, headerbar);
   gtk_widget_class_bind_template_child (widget_class, TerminalWindow, main_vbox);
   gtk_widget_class_bind_template_child (widget_class, TerminalWindow, notebook);
+  gtk_widget_class_bind_template_child (widget_class, TerminalWindow, operations_box);
   gtk_widget_class_bind_template_child (widget_class, TerminalWindow, tab_bar);
   gtk_widget_class_bind_template_child (widget_class, TerminalWindow, tab_overview);
   gtk_widget_class_bind_template_child (widget_class, TerminalWindow, toolbar_view);
@@ -2373,11 +2625,18 @@ terminal_window_dispose (GObject *object)
 
   window->disposed = TRUE;
 
+  if (window->operations != nullptr)
+    terminal_window_cancel_operations (window);
+
   gtk_widget_dispose_template (GTK_WIDGET (window), TERMINAL_TYPE_WINDOW);
 
   g_clear_pointer ((GtkWidget **)&window->context_menu, gtk_widget_unparent);
   g_clear_handle_id (&window->fullscreen_transition, g_source_remove);
   g_clear_handle_id(&window->focus_active_tab_source, g_source_remove);
+  if (window->update_geometry_tick != 0) {
+    gtk_widget_remove_tick_callback (GTK_WIDGET (window), window->update_geometry_tick);
+    window->update_geometry_tick = 0;
+  }
 
   if (window->clipboard != nullptr) {
     g_signal_handlers_disconnect_by_func (app,
@@ -2386,12 +2645,10 @@ terminal_window_dispose (GObject *object)
     window->clipboard = nullptr;
   }
 
-  if (window->ask_default_infobar) {
-    g_signal_handlers_disconnect_by_func(app,
-                                         (void*)window_sync_ask_default_terminal_cb,
-                                         window);
-    window->ask_default_infobar = nullptr;
-  }
+  g_signal_handlers_disconnect_by_func(app,
+                                       (void*)window_sync_ask_default_terminal_cb,
+                                       window);
+  window->ask_default_infobar = nullptr;
 
   remove_popup_info (window);
 
@@ -2415,6 +2672,7 @@ terminal_window_finalize (GObject *object)
                          GTK_RESPONSE_DELETE_EVENT);
 
   g_free (window->uuid);
+  g_clear_pointer (&window->operations, g_ptr_array_unref);
 
   G_OBJECT_CLASS (terminal_window_parent_class)->finalize (object);
 }
@@ -2731,6 +2989,10 @@ notebook_screen_added_cb (TerminalNotebook *notebook,
   g_signal_connect (screen, "close-screen",
                     G_CALLBACK (screen_close_cb), window);
 
+  /* The tab may have been moved here from another window */
+  terminal_tab_set_window_minimized (terminal_tab_get_from_screen (screen),
+                                     terminal_window_is_minimized (window));
+
   terminal_window_update_tabs_actions_sensitivity (window);
   terminal_window_update_search_sensitivity(window);
   terminal_window_update_paste_sensitivity (window);
@@ -2916,6 +3178,49 @@ notebook_setup_menu_cb(TerminalNotebook* notebook,
   g_simple_action_set_enabled(G_SIMPLE_ACTION(action), pinned);
 }
 
+static gboolean
+update_geometry_tick_cb (GtkWidget *widget,
+                         GdkFrameClock *frame_clock,
+                         gpointer user_data)
+{
+  TerminalWindow *window = TERMINAL_WINDOW (widget);
+
+  _terminal_debug_print (TERMINAL_DEBUG_GEOMETRY,
+                         "[window %p] updating geometry for %u requests\n",
+                         window, window->n_update_geometry_requests);
+
+  window->update_geometry_tick = 0;
+  window->n_update_geometry_requests = 0;
+  terminal_window_update_geometry (window);
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * terminal_window_queue_update_geometry:
+ * @window:
+ *
+ * Like terminal_window_update_geometry(), but once a window has been
+ * realized, updates the geometry only once at the start of the next frame
+ * no matter how often this is called before that.
+ */
+void
+terminal_window_queue_update_geometry (TerminalWindow *window)
+{
+  if (!window->realized) {
+    terminal_window_update_geometry (window);
+    return;
+  }
+
+  window->n_update_geometry_requests++;
+  if (window->update_geometry_tick != 0)
+    return;
+
+  window->update_geometry_tick = gtk_widget_add_tick_callback (GTK_WIDGET (window),
+                                                               update_geometry_tick_cb,
+                                                               nullptr, nullptr);
+}
+
 gboolean
 terminal_window_parse_geometry (TerminalWindow *window,
                                 const char     *geometry)
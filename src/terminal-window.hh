@@ -47,9 +47,29 @@ GList          *terminal_window_list_tabs   (TerminalWindow *window);
 gboolean        terminal_window_parse_geometry           (TerminalWindow *window,
                                                           const char     *geometry);
 void            terminal_window_update_geometry          (TerminalWindow *window);
+void            terminal_window_queue_update_geometry    (TerminalWindow *window);
 void            terminal_window_request_close            (TerminalWindow *window);
 const char     *terminal_window_get_uuid                 (TerminalWindow *window);
 gboolean        terminal_window_in_fullscreen_transition (TerminalWindow *window);
 bool terminal_window_is_animating (TerminalWindow* window);
 
+/*
+ * TerminalWindowOperation:
+ *
+ * A long running operation started from a window, like saving or printing
+ * the contents of a terminal. Each one is shown in an info bar with its
+ * progress and a button to cancel it, and any number of them may run at
+ * the same time.
+ */
+typedef struct _TerminalWindowOperation TerminalWindowOperation;
+
+TerminalWindowOperation *terminal_window_begin_operation (TerminalWindow *window,
+                                                          const char *description);
+TerminalWindow *terminal_window_operation_get_window (TerminalWindowOperation *operation);
+GCancellable   *terminal_window_operation_get_cancellable (TerminalWindowOperation *operation);
+void            terminal_window_operation_set_progress (TerminalWindowOperation *operation,
+                                                        gint64 n_lines,
+                                                        gint64 total_lines);
+void            terminal_window_operation_end (TerminalWindowOperation *operation);
+
 G_END_DECLS
@@ -48,8 +48,9 @@ GS_DEFINE_CLEANUP_FUNCTION0(TerminalOptions*, gs_local_options_free, terminal_op
 /* Wait-for-exit helper */
 
 typedef struct {
-  GMainLoop *loop;
+  GMainLoop *loop; /* only while in run_receiver() */
   int status;
+  gboolean exited;
 } RunData;
 
 static void
@@ -58,8 +59,10 @@ receiver_child_exited_cb (TerminalReceiver *receiver,
                           RunData *data)
 {
   data->status = status;
+  data->exited = TRUE;
 
-  if (g_main_loop_is_running (data->loop))
+  if (data->loop != nullptr &&
+      g_main_loop_is_running (data->loop))
     g_main_loop_quit (data->loop);
 }
 
@@ -82,27 +85,40 @@ factory_name_owner_notify_cb (TerminalFactory *factory,
     g_main_loop_quit (data->loop);
 }
 
+/*
+ * run_receiver:
+ * @factory: the #TerminalFactory
+ * @receiver: the #TerminalReceiver to wait for
+ * @data: the #RunData whose "child-exited" handler was connected to
+ *   @receiver as soon as its proxy was created
+ *
+ * Waits for @receiver's child to exit, unless it already has.
+ *
+ * Returns: the exit code to use
+ */
 static int
 run_receiver (TerminalFactory *factory,
-              TerminalReceiver *receiver)
+              TerminalReceiver *receiver,
+              RunData *data)
 {
-  RunData data = { g_main_loop_new (nullptr, FALSE), 0 };
-  gulong receiver_exited_id = g_signal_connect (receiver, "child-exited",
-                                                G_CALLBACK (receiver_child_exited_cb), &data);
-  gulong factory_notify_id = g_signal_connect (factory, "notify::g-name-owner",
-                                               G_CALLBACK (factory_name_owner_notify_cb), &data);
-  g_main_loop_run (data.loop);
-  g_signal_handler_disconnect (receiver, receiver_exited_id);
-  g_signal_handler_disconnect (factory, factory_notify_id);
-  g_main_loop_unref (data.loop);
+  if (!data->exited) {
+    data->loop = g_main_loop_new (nullptr, FALSE);
+    gulong factory_notify_id = g_signal_connect (factory, "notify::g-name-owner",
+                                                 G_CALLBACK (factory_name_owner_notify_cb), data);
+    g_main_loop_run (data->loop);
+    g_signal_handler_disconnect (factory, factory_notify_id);
+    g_clear_pointer (&data->loop, g_main_loop_unref);
+  }
+
+  g_signal_handlers_disconnect_by_func (receiver, (void*) receiver_child_exited_cb, data);
 
   /* Mangle the exit status */
   int exit_code;
-  if (WIFEXITED (data.status))
-    exit_code = WEXITSTATUS (data.status);
-  else if (WIFSIGNALED (data.status))
-    exit_code = 128 + (int) WTERMSIG (data.status);
-  else if (WCOREDUMP (data.status))
+  if (WIFEXITED (data->status))
+    exit_code = WEXITSTATUS (data->status);
+  else if (WIFSIGNALED (data->status))
+    exit_code = 128 + (int) WTERMSIG (data->status);
+  else if (WCOREDUMP (data->status))
     exit_code = 127;
   else
     exit_code = 127;
@@ -110,6 +126,27 @@ run_receiver (TerminalFactory *factory,
   return exit_code;
 }
 
+/* Launch benchmark helper */
+
+static void G_GNUC_PRINTF(4, 5)
+benchmark_print (TerminalOptions *options,
+                 gint64 start_time,
+                 gint64 end_time,
+                 const char *format,
+                 ...)
+{
+  if (!options->benchmark_launch)
+    return;
+
+  va_list args;
+  va_start (args, format);
+  gs_free char *phase = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  terminal_printerr_level (QUIET, "%s: %.3f ms\n",
+                           phase, (end_time - start_time) / 1000.);
+}
+
 /* Factory helpers */
 
 static gboolean
@@ -397,6 +434,463 @@ handle_show_preferences(TerminalOptions *options,
   }
 }
 
+static void
+append_create_instance_options (GVariantBuilder *builder,
+                                TerminalOptions *options,
+                                InitialWindow *iw,
+                                InitialTab *it,
+                                const char *encoding,
+                                const char *parent_screen_object_path)
+{
+  terminal_client_append_create_instance_options (builder,
+                                                  options->display_name,
+                                                  options->startup_id,
+                                                  options->activation_token,
+                                                  iw->geometry,
+                                                  iw->role,
+                                                  it->profile ? it->profile : options->default_profile,
+                                                  encoding,
+                                                  it->title ? it->title : options->default_title,
+                                                  it->active,
+                                                  iw->start_maximized,
+                                                  iw->start_fullscreen);
+
+  /* This will be used to apply missing defaults */
+  if (parent_screen_object_path != nullptr)
+    g_variant_builder_add (builder, "{sv}",
+                           "parent-screen", g_variant_new_object_path (parent_screen_object_path));
+
+  /* Restored windows shouldn't demand attention; see bug #586308. */
+  if (iw->source_tag == SOURCE_SESSION)
+    g_variant_builder_add (builder, "{sv}",
+                           "present-window", g_variant_new_boolean (FALSE));
+  if (options->zoom_set || it->zoom_set)
+    g_variant_builder_add (builder, "{sv}",
+                           "zoom", g_variant_new_double (it->zoom_set ? it->zoom : options->zoom));
+}
+
+static GVariant *
+append_exec_options (GVariantBuilder *builder,
+                     TerminalOptions *options,
+                     InitialTab *it)
+{
+  char **argv = it->exec_argv ? it->exec_argv : options->exec_argv;
+  int argc = argv ? g_strv_length (argv) : 0;
+
+  PassFdElement *fd_array = it->fd_array ? (PassFdElement*)it->fd_array->data : nullptr;
+  gsize fd_array_len = it->fd_array ? it->fd_array->len : 0;
+
+  terminal_client_append_exec_options (builder,
+                                       !options->no_environment,
+                                       it->working_dir ? it->working_dir
+                                                       : options->default_working_dir,
+                                       fd_array, fd_array_len,
+                                       argc == 0);
+
+  return g_variant_new_bytestring_array ((const char * const *) argv, argc);
+}
+
+/*
+ * handle_options_batched:
+ * @options: a #TerminalOptions
+ * @factory: the factory proxy
+ * @service_name: the service name
+ * @parent_screen_object_path: (allow-none): the parent screen object path
+ * @encoding: the locale encoding
+ * @success: location to store whether @options were successfully handled
+ *
+ * Creates all windows and tabs from @options using a single
+ * CreateInstances call.
+ *
+ * Returns: %FALSE if the server does not support the CreateInstances
+ *   method and the caller needs to fall back to creating the instances one
+ *   by one, or %TRUE if @options were handled
+ */
+static gboolean
+handle_options_batched (TerminalOptions *options,
+                        TerminalFactory *factory,
+                        const char *service_name,
+                        const char *parent_screen_object_path,
+                        const char *encoding,
+                        gboolean *success)
+{
+  GVariantBuilder instances_builder;
+  g_variant_builder_init (&instances_builder, G_VARIANT_TYPE ("a(a{sv}a{sv}aayi)"));
+
+  gs_unref_object GUnixFDList *fd_list = nullptr;
+  guint n_instances = 0;
+
+  for (GList *lw = options->initial_windows;  lw != nullptr; lw = lw->next)
+    {
+      InitialWindow *iw = (InitialWindow*)lw->data;
+      terminal_assert_nonnull (iw);
+
+      guint first_instance = n_instances;
+
+      for (GList *lt = iw->tabs; lt != nullptr; lt = lt->next)
+        {
+          InitialTab *it = (InitialTab*)lt->data;
+          terminal_assert_nonnull (it);
+
+          g_variant_builder_open (&instances_builder, G_VARIANT_TYPE ("(a{sv}a{sv}aayi)"));
+
+          GVariantBuilder builder;
+          g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+
+          append_create_instance_options (&builder, options, iw, it, encoding,
+                                          parent_screen_object_path);
+
+          /* This will be used to get the parent window */
+          if (n_instances != first_instance)
+            g_variant_builder_add (&builder, "{sv}",
+                                   "window-from-instance", g_variant_new_uint32 (first_instance));
+          else if (iw->implicit_first_window && parent_screen_object_path != nullptr)
+            g_variant_builder_add (&builder, "{sv}",
+                                   "window-from-screen", g_variant_new_object_path (parent_screen_object_path));
+
+          g_variant_builder_add_value (&instances_builder, g_variant_builder_end (&builder));
+
+          g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+          GVariant *arguments = append_exec_options (&builder, options, it);
+          g_variant_builder_add_value (&instances_builder, g_variant_builder_end (&builder));
+          g_variant_builder_add_value (&instances_builder, arguments);
+
+          /* The tab's FD handles are relative to its first FD in the combined list */
+          int fd_index = -1;
+          if (it->fd_list != nullptr) {
+            if (fd_list == nullptr)
+              fd_list = g_unix_fd_list_new ();
+
+            fd_index = g_unix_fd_list_get_length (fd_list);
+
+            int n_fds;
+            const int *fds = g_unix_fd_list_peek_fds (it->fd_list, &n_fds);
+            for (int i = 0; i < n_fds; i++) {
+              gs_free_error GError *err = nullptr;
+              if (g_unix_fd_list_append (fd_list, fds[i], &err) == -1) {
+                terminal_printerr ("Failed to pass FD: %s\n", err->message);
+                g_variant_builder_clear (&instances_builder);
+                *success = FALSE;
+                return TRUE;
+              }
+            }
+          }
+          g_variant_builder_add (&instances_builder, "i", fd_index);
+
+          g_variant_builder_close (&instances_builder);
+          n_instances++;
+        }
+    }
+
+  _terminal_debug_print (TERMINAL_DEBUG_SERVER,
+                         "Creating %u instances in one call\n", n_instances);
+
+  gs_free_error GError *err = nullptr;
+  gs_strfreev char **receivers = nullptr;
+  gs_strfreev char **errors = nullptr;
+  gint64 start_time = g_get_monotonic_time ();
+  if (!terminal_factory_call_create_instances_sync
+         (factory,
+          g_variant_builder_end (&instances_builder),
+          fd_list,
+          &receivers,
+          &errors,
+          nullptr /* outfdlist */,
+          nullptr /* cancellable */,
+          &err)) {
+    /* Older servers don't have this method */
+    if (g_error_matches (err, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD))
+      return FALSE;
+
+    *success = !handle_create_instance_error (service_name, err);
+    return TRUE;
+  }
+
+  benchmark_print (options, start_time, g_get_monotonic_time (),
+                   "CreateInstances for %u tabs", n_instances);
+
+  for (guint i = 0; receivers[i] != nullptr; i++) {
+    if (errors[i] != nullptr && errors[i][0] != '\0') {
+      terminal_printerr ("Error creating terminal: %s\n", errors[i]);
+      continue;
+    }
+
+    if (options->print_environment)
+      g_print ("%s=%s\n", TERMINAL_ENV_SCREEN, receivers[i]);
+  }
+
+  *success = TRUE;
+  return TRUE;
+}
+
+/* Asynchronous launch */
+
+typedef struct {
+  TerminalOptions *options;
+  TerminalFactory *factory;
+  const char *service_name;
+  const char *parent_screen_object_path;
+  const char *factory_unique_name;
+  const char *encoding;
+  GMainLoop *loop;
+  GCancellable *cancellable;
+  guint n_pending;
+  gboolean aborted;
+  TerminalReceiver *wait_for_receiver;
+  RunData *run; /* unowned */
+  gint64 start_time;
+} LaunchData;
+
+typedef struct {
+  LaunchData *launch; /* unowned */
+  InitialWindow *iw; /* unowned */
+  GList *lt; /* unowned, the tab's link in iw->tabs */
+  gboolean first_in_window;
+  guint index;
+  char *window_screen_object_path;
+  guint window_id;
+  char *object_path;
+  TerminalReceiver *receiver;
+  gint64 create_start_time;
+  gint64 proxy_start_time;
+  gint64 exec_start_time;
+} TabLaunchData;
+
+static void launch_tab (LaunchData *data,
+                        InitialWindow *iw,
+                        GList *lt,
+                        gboolean first_in_window,
+                        guint index,
+                        const char *window_screen_object_path,
+                        guint window_id);
+
+static void
+tab_launch_data_finish (TabLaunchData *tab)
+{
+  LaunchData *data = tab->launch;
+
+  g_free (tab->window_screen_object_path);
+  g_free (tab->object_path);
+  g_clear_object (&tab->receiver);
+  g_free (tab);
+
+  if (--data->n_pending == 0 &&
+      g_main_loop_is_running (data->loop))
+    g_main_loop_quit (data->loop);
+}
+
+/*
+ * tab_launch_handle_error:
+ * @tab:
+ * @error:
+ * @handle_func: one of the handle_*_error functions
+ *
+ * Reports @error, and aborts the whole launch if it was fatal.
+ */
+static void
+tab_launch_handle_error (TabLaunchData *tab,
+                         GError *error,
+                         gboolean (* handle_func) (const char *, GError *))
+{
+  LaunchData *data = tab->launch;
+
+  /* Cancelled because a previous error aborted the launch */
+  if (data->aborted &&
+      g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  if (handle_func (data->service_name, error)) {
+    data->aborted = TRUE;
+    g_cancellable_cancel (data->cancellable);
+  }
+}
+
+static void
+exec_done_cb (TerminalReceiver *receiver,
+              GAsyncResult *result,
+              TabLaunchData *tab)
+{
+  LaunchData *data = tab->launch;
+  InitialTab *it = (InitialTab*)tab->lt->data;
+
+  gs_free_error GError *err = nullptr;
+  if (!terminal_receiver_call_exec_finish (receiver, nullptr /* outfdlist */, result, &err)) {
+    tab_launch_handle_error (tab, err, handle_exec_error);
+    tab_launch_data_finish (tab);
+    return;
+  }
+
+  gint64 now = g_get_monotonic_time ();
+  benchmark_print (data->options, tab->create_start_time, now,
+                   "Tab %u: CreateInstance %.3f ms, receiver proxy %.3f ms, Exec %.3f ms; total",
+                   tab->index,
+                   (tab->proxy_start_time - tab->create_start_time) / 1000.,
+                   (tab->exec_start_time - tab->proxy_start_time) / 1000.,
+                   (now - tab->exec_start_time) / 1000.);
+
+  if (it->wait)
+    gs_transfer_out_value (&data->wait_for_receiver, &tab->receiver);
+
+  if (data->options->print_environment)
+    g_print ("%s=%s\n", TERMINAL_ENV_SCREEN, tab->object_path);
+
+  tab_launch_data_finish (tab);
+}
+
+static void
+receiver_proxy_new_done_cb (GObject *source,
+                            GAsyncResult *result,
+                            TabLaunchData *tab)
+{
+  LaunchData *data = tab->launch;
+  TerminalOptions *options = data->options;
+  InitialTab *it = (InitialTab*)tab->lt->data;
+
+  gs_free_error GError *err = nullptr;
+  tab->receiver = terminal_receiver_proxy_new_for_bus_finish (result, &err);
+  if (tab->receiver == nullptr) {
+    tab_launch_handle_error (tab, err, handle_create_receiver_proxy_error);
+    tab_launch_data_finish (tab);
+    return;
+  }
+
+  /* The child may exit while we're still launching other tabs, so
+   * catch its ChildExited right away.
+   */
+  if (it->wait)
+    g_signal_connect (tab->receiver, "child-exited",
+                      G_CALLBACK (receiver_child_exited_cb), data->run);
+
+  GVariantBuilder builder;
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+
+  GVariant *arguments = append_exec_options (&builder, options, it);
+
+  tab->exec_start_time = g_get_monotonic_time ();
+  terminal_receiver_call_exec (tab->receiver,
+                               g_variant_builder_end (&builder),
+                               arguments,
+                               it->fd_list,
+                               data->cancellable,
+                               (GAsyncReadyCallback) exec_done_cb,
+                               tab);
+}
+
+static void
+create_instance_done_cb (TerminalFactory *factory,
+                         GAsyncResult *result,
+                         TabLaunchData *tab)
+{
+  LaunchData *data = tab->launch;
+  InitialTab *it = (InitialTab*)tab->lt->data;
+
+  gs_free_error GError *err = nullptr;
+  if (!terminal_factory_call_create_instance_finish (factory, &tab->object_path, result, &err)) {
+    tab_launch_handle_error (tab, err, handle_create_instance_error);
+
+    /* Continue processing the remaining options! Without this tab, the
+     * next one becomes the first of its window.
+     */
+    if (tab->first_in_window && tab->lt->next != nullptr && !data->aborted)
+      launch_tab (data, tab->iw, tab->lt->next, TRUE, tab->index + 1,
+                  tab->window_screen_object_path, tab->window_id);
+
+    tab_launch_data_finish (tab);
+    return;
+  }
+
+  /* Now that the window exists, start all its other tabs */
+  if (tab->first_in_window) {
+    guint window_id = tab->window_id;
+
+    /* Deprecated and not working on new server anymore */
+    char *p = strstr (tab->object_path, "/window/");
+    if (p) {
+      char *end = nullptr;
+      guint64 value;
+
+      errno = 0;
+      p += strlen ("/window/");
+      value = g_ascii_strtoull (p, &end, 10);
+      if (errno == 0 && end != p && *end == '/')
+        window_id = (guint) value;
+    }
+
+    guint index = tab->index + 1;
+    for (GList *lt = tab->lt->next; lt != nullptr; lt = lt->next)
+      launch_tab (data, tab->iw, lt, FALSE, index++,
+                  tab->object_path, window_id);
+  }
+
+  tab->proxy_start_time = g_get_monotonic_time ();
+  terminal_receiver_proxy_new_for_bus (G_BUS_TYPE_SESSION,
+                                       GDBusProxyFlags(G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                                                       (it->wait ? 0 : G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS)),
+                                       data->factory_unique_name,
+                                       tab->object_path,
+                                       data->cancellable,
+                                       (GAsyncReadyCallback) receiver_proxy_new_done_cb,
+                                       tab);
+}
+
+/*
+ * launch_tab:
+ * @data: the #LaunchData
+ * @iw: the #InitialWindow
+ * @lt: the link of the #InitialTab to launch in @iw's tabs list
+ * @first_in_window: whether this tab creates @iw's window
+ * @index: the index of the tab, for diagnostics
+ * @window_screen_object_path: (allow-none): the object path of a screen whose
+ *   window the tab should be put in
+ * @window_id: the window ID for old servers, or 0
+ *
+ * Starts creating a tab and its child process. When @first_in_window is %TRUE,
+ * the remaining tabs of @iw are launched once the tab has been created.
+ */
+static void
+launch_tab (LaunchData *data,
+            InitialWindow *iw,
+            GList *lt,
+            gboolean first_in_window,
+            guint index,
+            const char *window_screen_object_path,
+            guint window_id)
+{
+  InitialTab *it = (InitialTab*)lt->data;
+  terminal_assert_nonnull (it);
+
+  TabLaunchData *tab = g_new0 (TabLaunchData, 1);
+  tab->launch = data;
+  tab->iw = iw;
+  tab->lt = lt;
+  tab->first_in_window = first_in_window;
+  tab->index = index;
+  tab->window_screen_object_path = g_strdup (window_screen_object_path);
+  tab->window_id = window_id;
+  data->n_pending++;
+
+  GVariantBuilder builder;
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+
+  append_create_instance_options (&builder, data->options, iw, it, data->encoding,
+                                  data->parent_screen_object_path);
+
+  /* This will be used to get the parent window */
+  if (window_screen_object_path)
+    g_variant_builder_add (&builder, "{sv}",
+                           "window-from-screen", g_variant_new_object_path (window_screen_object_path));
+  if (window_id)
+    g_variant_builder_add (&builder, "{sv}",
+                           "window-id", g_variant_new_uint32 (window_id));
+
+  tab->create_start_time = g_get_monotonic_time ();
+  terminal_factory_call_create_instance (data->factory,
+                                         g_variant_builder_end (&builder),
+                                         data->cancellable,
+                                         (GAsyncReadyCallback) create_instance_done_cb,
+                                         tab);
+}
+
 /**
  * handle_options:
  * @app:
@@ -404,6 +898,7 @@ handle_show_preferences(TerminalOptions *options,
  * @allow_resume: whether to merge the terminal configuration from the
  *   saved session on resume
  * @wait_for_receiver: location to store the #TerminalReceiver to wait for
+ * @run: the #RunData to use for waiting for @wait_for_receiver
  *
  * Processes @options. It loads or saves the terminal configuration, or
  * opens the specified windows and tabs.
@@ -416,7 +911,8 @@ handle_options (TerminalOptions *options,
                 TerminalFactory *factory,
                 const char *service_name,
                 const char *parent_screen_object_path,
-                TerminalReceiver **wait_for_receiver)
+                TerminalReceiver **wait_for_receiver,
+                RunData *run)
 {
   /* We need to forward the locale encoding to the server, see bug #732128 */
   const char *encoding;
@@ -429,142 +925,76 @@ handle_options (TerminalOptions *options,
     terminal_options_ensure_window (options);
   }
 
-  const char *factory_unique_name = g_dbus_proxy_get_name_owner (G_DBUS_PROXY (factory));
+  /* With more than one tab, create them all in one go. Waiting for a tab
+   * needs its receiver proxy to exist before the child is spawned, so that
+   * case keeps using the one-by-one path.
+   */
+  guint n_tabs = 0;
+  gboolean any_wait = FALSE;
+  for (GList *lw = options->initial_windows;  lw != nullptr; lw = lw->next) {
+    InitialWindow *iw = (InitialWindow*)lw->data;
+    for (GList *lt = iw->tabs; lt != nullptr; lt = lt->next) {
+      n_tabs++;
+      any_wait |= ((InitialTab*)lt->data)->wait;
+    }
+  }
 
+  gboolean success;
+  if (n_tabs > 1 && !any_wait &&
+      handle_options_batched (options, factory, service_name,
+                              parent_screen_object_path, encoding,
+                              &success))
+    return success;
+
+  LaunchData data;
+  data.options = options;
+  data.factory = factory;
+  data.service_name = service_name;
+  data.parent_screen_object_path = parent_screen_object_path;
+  data.factory_unique_name = g_dbus_proxy_get_name_owner (G_DBUS_PROXY (factory));
+  data.encoding = encoding;
+  data.loop = g_main_loop_new (nullptr, FALSE);
+  data.cancellable = g_cancellable_new ();
+  data.n_pending = 0;
+  data.aborted = FALSE;
+  data.wait_for_receiver = nullptr;
+  data.run = run;
+  data.start_time = g_get_monotonic_time ();
+
+  /* Start the first tab of each window; the remaining tabs of a window
+   * are started as soon as its first tab has been created, since they
+   * need its object path to be put into the same window.
+   */
+  guint index = 0;
   for (GList *lw = options->initial_windows;  lw != nullptr; lw = lw->next)
     {
       InitialWindow *iw = (InitialWindow*)lw->data;
-
       terminal_assert_nonnull (iw);
 
-      guint window_id = 0;
-
-      gs_free char *previous_screen_object_path = nullptr;
-      if (iw->implicit_first_window)
-        previous_screen_object_path = g_strdup (parent_screen_object_path);
-
-      /* Now add the tabs */
-      for (GList *lt = iw->tabs; lt != nullptr; lt = lt->next)
-        {
-          InitialTab *it = (InitialTab*)lt->data;
-          terminal_assert_nonnull (it);
-
-          GVariantBuilder builder;
-          g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
-
-          terminal_client_append_create_instance_options (&builder,
-                                                          options->display_name,
-                                                          options->startup_id,
-                                                          options->activation_token,
-                                                          iw->geometry,
-                                                          iw->role,
-                                                          it->profile ? it->profile : options->default_profile,
-                                                          encoding,
-                                                          it->title ? it->title : options->default_title,
-                                                          it->active,
-                                                          iw->start_maximized,
-                                                          iw->start_fullscreen);
-
-          /* This will be used to apply missing defaults */
-          if (parent_screen_object_path != nullptr)
-            g_variant_builder_add (&builder, "{sv}",
-                                   "parent-screen", g_variant_new_object_path (parent_screen_object_path));
-
-          /* This will be used to get the parent window */
-          if (previous_screen_object_path)
-            g_variant_builder_add (&builder, "{sv}",
-                                   "window-from-screen", g_variant_new_object_path (previous_screen_object_path));
-          if (window_id)
-            g_variant_builder_add (&builder, "{sv}",
-                                   "window-id", g_variant_new_uint32 (window_id));
-          /* Restored windows shouldn't demand attention; see bug #586308. */
-          if (iw->source_tag == SOURCE_SESSION)
-            g_variant_builder_add (&builder, "{sv}",
-                                   "present-window", g_variant_new_boolean (FALSE));
-          if (options->zoom_set || it->zoom_set)
-            g_variant_builder_add (&builder, "{sv}",
-                                   "zoom", g_variant_new_double (it->zoom_set ? it->zoom : options->zoom));
-
-          gs_free_error GError *err = nullptr;
-          gs_free char *object_path = nullptr;
-          if (!terminal_factory_call_create_instance_sync
-                 (factory,
-                  g_variant_builder_end (&builder),
-                  &object_path,
-                  nullptr /* cancellable */,
-                  &err)) {
-            if (handle_create_instance_error (service_name, err))
-              return FALSE;
-            else
-              continue; /* Continue processing the remaining options! */
-          }
-
-          /* Deprecated and not working on new server anymore */
-          char *p = strstr (object_path, "/window/");
-          if (p) {
-            char *end = nullptr;
-            guint64 value;
-
-            errno = 0;
-            p += strlen ("/window/");
-            value = g_ascii_strtoull (p, &end, 10);
-            if (errno == 0 && end != p && *end == '/')
-              window_id = (guint) value;
-          }
+      if (iw->tabs == nullptr)
+        continue;
 
-          g_free (previous_screen_object_path);
-          previous_screen_object_path = g_strdup (object_path);
-
-          gs_unref_object TerminalReceiver *receiver =
-            terminal_receiver_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
-                                                      GDBusProxyFlags(G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
-								      (it->wait ? 0 : G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS)),
-                                                      factory_unique_name,
-                                                      object_path,
-                                                      nullptr /* cancellable */,
-                                                      &err);
-          if (receiver == nullptr) {
-            if (handle_create_receiver_proxy_error (service_name, err))
-              return FALSE;
-            else
-              continue; /* Continue processing the remaining options! */
-          }
+      launch_tab (&data, iw, iw->tabs, TRUE, index,
+                  iw->implicit_first_window ? parent_screen_object_path : nullptr,
+                  0);
+      index += g_list_length (iw->tabs);
+    }
 
-          g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  if (data.n_pending > 0)
+    g_main_loop_run (data.loop);
 
-          char **argv = it->exec_argv ? it->exec_argv : options->exec_argv;
-          int argc = argv ? g_strv_length (argv) : 0;
-
-          PassFdElement *fd_array = it->fd_array ? (PassFdElement*)it->fd_array->data : nullptr;
-          gsize fd_array_len = it->fd_array ? it->fd_array->len : 0;
-
-          terminal_client_append_exec_options (&builder,
-                                               !options->no_environment,
-                                               it->working_dir ? it->working_dir
-                                                               : options->default_working_dir,
-                                               fd_array, fd_array_len,
-                                               argc == 0);
-
-          if (!terminal_receiver_call_exec_sync (receiver,
-                                                 g_variant_builder_end (&builder),
-                                                 g_variant_new_bytestring_array ((const char * const *) argv, argc),
-                                                 it->fd_list, nullptr /* outfdlist */,
-                                                 nullptr /* cancellable */,
-                                                 &err)) {
-            if (handle_exec_error (service_name, err))
-              return FALSE;
-            else
-              continue; /* Continue processing the remaining options! */
-          }
+  benchmark_print (options, data.start_time, g_get_monotonic_time (),
+                   "All %u tabs launched", index);
 
-          if (it->wait)
-            gs_transfer_out_value (wait_for_receiver, &receiver);
+  g_main_loop_unref (data.loop);
+  g_object_unref (data.cancellable);
 
-          if (options->print_environment)
-            g_print ("%s=%s\n", TERMINAL_ENV_SCREEN, object_path);
-        }
-    }
+  if (data.aborted) {
+    g_clear_object (&data.wait_for_receiver);
+    return FALSE;
+  }
 
+  gs_transfer_out_value (wait_for_receiver, &data.wait_for_receiver);
   return TRUE;
 }
 
@@ -592,9 +1022,20 @@ main (int argc, char **argv)
 
   g_set_application_name (_("Terminal"));
 
+  /* Only save the layout; this doesn't need the server */
+  if (options->save_layout != nullptr) {
+    if (!terminal_options_save_layout (options, options->save_layout, &error)) {
+      terminal_printerr (_("Failed to save layout: %s\n"), error->message);
+      return exit_code;
+    }
+
+    return EXIT_SUCCESS;
+  }
+
   gs_unref_object TerminalFactory *factory = nullptr;
   gs_free char *service_name = nullptr;
   gs_free char *parent_screen_object_path = nullptr;
+  gint64 start_time = g_get_monotonic_time ();
   if (!factory_proxy_new (options,
                           &factory,
                           &service_name,
@@ -602,6 +1043,9 @@ main (int argc, char **argv)
                           &error))
     return exit_code;
 
+  benchmark_print (options, start_time, g_get_monotonic_time (),
+                   "Factory proxy");
+
   if (options->print_environment) {
     const char *name_owner = g_dbus_proxy_get_name_owner (G_DBUS_PROXY (factory));
     if (name_owner != nullptr)
@@ -611,11 +1055,16 @@ main (int argc, char **argv)
   }
 
   TerminalReceiver *receiver = nullptr;
-  if (!handle_options (options, factory, service_name, parent_screen_object_path, &receiver))
+  RunData run = { nullptr, 0, FALSE };
+  if (!handle_options (options, factory, service_name, parent_screen_object_path,
+                       &receiver, &run))
     return exit_code;
 
   if (receiver != nullptr) {
-    exit_code = run_receiver (factory, receiver);
+    gint64 wait_start_time = g_get_monotonic_time ();
+    exit_code = run_receiver (factory, receiver, &run);
+    benchmark_print (options, wait_start_time, g_get_monotonic_time (),
+                     "First ChildExited");
     g_object_unref (receiver);
   } else
     exit_code = EXIT_SUCCESS;